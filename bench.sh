@@ -0,0 +1,60 @@
+#!/bin/sh
+# bench.sh
+# Self-benchmark for testuqwordladder. Generates synthetic job specification
+# files and reports the harness's parse time, golden build time and per-test
+# overhead, using benchstandin as both good-uqwordladder and the program under
+# test so that the harness dominates the measurements. Fails if running a test
+# allocates heap memory after the first test.
+#
+# Usage: bench.sh "sizes" goldenmax runtests shared%
+
+SIZES=${1:-"10 1000 10000 100000"}
+GOLDEN_MAX=${2:-10000}
+RUN_TESTS=${3:-10}
+SHARED=${4:-50}
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d "${TMPDIR:-/tmp}/uqbench.XXXXXX")
+trap 'rm -rf "$WORK"' EXIT
+
+# Stand in for good-uqwordladder on the PATH.
+mkdir "$WORK/bin"
+ln -s "$HERE/benchstandin" "$WORK/bin/good-uqwordladder"
+PATH="$WORK/bin:$PATH"
+export PATH
+
+# phase_time phase dir [args...]: runs the harness up to the given phase and
+# prints the seconds it reported for that phase.
+phase_time() {
+    phase=$1
+    dir=$2
+    shift 2
+    TESTUQWORDLADDER_BENCH_STOP=$phase "$HERE/testuqwordladder-bench" \
+	    --testdir "$dir/tmp" "$@" "$dir/jobspec" "$HERE/benchstandin" \
+	    2>&1 >/dev/null | awk -v p="$phase" '$2 == p { print $3 }'
+}
+
+printf "%10s %12s %12s\n" tests parse-s golden-s
+for n in $SIZES; do
+    dir="$WORK/$n"
+    "$HERE/benchjobspecgen" -n "$n" -s "$SHARED" -d "$dir" || exit 1
+    parse=$(phase_time parse "$dir")
+    golden=-
+    if [ "$n" -le "$GOLDEN_MAX" ]; then
+	golden=$(phase_time golden "$dir" --recreate)
+    fi
+    printf "%10s %12s %12s\n" "$n" "$parse" "$golden"
+    rm -rf "$dir"
+done
+
+dir="$WORK/run"
+"$HERE/benchjobspecgen" -n "$RUN_TESTS" -s "$SHARED" -d "$dir" || exit 1
+report=$("$HERE/testuqwordladder-bench" --testdir "$dir/tmp" \
+	"$dir/jobspec" "$HERE/benchstandin" 2>&1 >/dev/null)
+overhead=$(echo "$report" | awk '$2 == "overhead" { print $3 }')
+allocations=$(echo "$report" | awk '$2 == "allocations" { print $3 }')
+printf "run overhead over %s tests: %s s per test\n" "$RUN_TESTS" "$overhead"
+
+# Running a test should not allocate once the first test is done.
+printf "allocations after the first test: %s\n" "$allocations"
+[ "$allocations" = 0 ]
@@ -0,0 +1,245 @@
+/*
+ * benchJobspecGen
+ * Generates synthetic job specification files and input files for
+ * 	benchmarking testuqwordladder.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <errno.h>
+
+// Limits on the number of tests to generate
+#define MIN_TESTS 10
+#define MAX_TESTS 1000000
+
+// Default values of the optional arguments
+#define DEFAULT_SHARED_PERCENT 50
+#define DEFAULT_POOL_SIZE 8
+#define DEFAULT_SEED 2310
+#define DEFAULT_OUTPUT_DIR "./bench"
+
+// Valid command line arguments, each of which takes a value
+#define NUM_TESTS_ARG "-n"
+#define SHARED_ARG "-s"
+#define POOL_ARG "-p"
+#define SEED_ARG "-r"
+#define OUTPUT_DIR_ARG "-d"
+
+// Names of the generated files within the output directory
+#define JOBSPEC_NAME "jobspec"
+#define INPUT_DIR_NAME "inputs"
+#define SHARED_INPUT_FMT "%s/" INPUT_DIR_NAME "/shared%d"
+#define UNIQUE_INPUT_FMT "%s/" INPUT_DIR_NAME "/unique%d"
+#define JOBSPEC_LINE_FMT "bench%d\t%s\t--from\t%s\t--to\t%s\n"
+
+// Number of words written to each input file, and the word length
+#define WORDS_PER_INPUT 16
+#define WORD_LENGTH 4
+
+// Error messages
+#define USAGE_ERR_MSG "Usage: benchjobspecgen [-n tests] [-s shared%%] " \
+    "[-p poolsize] [-r seed] [-d dir]\n"
+#define FILE_ERR_MSG "benchjobspecgen: Unable to write \"%s\"\n"
+
+// Program exit statuses
+enum ExitStatus {
+    OK = 0,
+    USAGE_ERR = 1,
+    FILE_ERR = 2
+};
+
+// Values of command line arguments
+typedef struct {
+    int numOfTests;
+    int sharedPercent;
+    int poolSize;
+    unsigned int seed;
+    char* outputDir;
+} GenParameters;
+
+/* Function prototypes */
+GenParameters parse_args(int argc, char** argv);
+int parse_int_arg(char* value, int min, int max);
+void make_dir(char* path);
+void random_word(char* word);
+void write_input_file(char* path);
+void write_jobspec(GenParameters parameters);
+
+int main(int argc, char** argv) {
+    GenParameters parameters = parse_args(argc, argv);
+    srand(parameters.seed);
+
+    // Make the output directories and the pool of shared input files.
+    char path[PATH_MAX];
+    make_dir(parameters.outputDir);
+    snprintf(path, PATH_MAX, "%s/" INPUT_DIR_NAME, parameters.outputDir);
+    make_dir(path);
+    for (int i = 0; i < parameters.poolSize; i++) {
+	snprintf(path, PATH_MAX, SHARED_INPUT_FMT, parameters.outputDir, i);
+	write_input_file(path);
+    }
+
+    write_jobspec(parameters);
+    return OK;
+}
+
+/* parse_args()
+ * ------------
+ * Reads the optional command line arguments, each of which is a flag
+ * 	followed by its value.
+ *
+ * argc: the number of command line arguments
+ * argv: an array of arrays of the command line arguments
+ *
+ * Returns: the generator parameters, with defaults for missing arguments.
+ * Errors: Exits with status 1 and the usage message if an argument is
+ * 	unknown, is missing its value, or has a value out of range.
+ */
+GenParameters parse_args(int argc, char** argv) {
+    GenParameters parameters = {MIN_TESTS, DEFAULT_SHARED_PERCENT,
+	    DEFAULT_POOL_SIZE, DEFAULT_SEED, DEFAULT_OUTPUT_DIR};
+
+    for (int i = 1; i < argc; i += 2) {
+	if (i + 1 >= argc) {
+	    fprintf(stderr, USAGE_ERR_MSG);
+	    exit(USAGE_ERR);
+	}
+	if (strcmp(argv[i], NUM_TESTS_ARG) == 0) {
+	    parameters.numOfTests = parse_int_arg(argv[i + 1], MIN_TESTS,
+		    MAX_TESTS);
+	} else if (strcmp(argv[i], SHARED_ARG) == 0) {
+	    parameters.sharedPercent = parse_int_arg(argv[i + 1], 0, 100);
+	} else if (strcmp(argv[i], POOL_ARG) == 0) {
+	    parameters.poolSize = parse_int_arg(argv[i + 1], 1, MAX_TESTS);
+	} else if (strcmp(argv[i], SEED_ARG) == 0) {
+	    parameters.seed = parse_int_arg(argv[i + 1], 0, __INT_MAX__);
+	} else if (strcmp(argv[i], OUTPUT_DIR_ARG) == 0) {
+	    parameters.outputDir = argv[i + 1];
+	} else {
+	    fprintf(stderr, USAGE_ERR_MSG);
+	    exit(USAGE_ERR);
+	}
+    }
+    return parameters;
+}
+
+/* parse_int_arg()
+ * ---------------
+ * Converts the value of a command line argument to an integer.
+ *
+ * value: the argument's value.
+ * min: the smallest valid value.
+ * max: the largest valid value.
+ *
+ * Returns: the integer value.
+ * Errors: Exits with status 1 and the usage message if the value is not an
+ * 	integer within [min, max].
+ */
+int parse_int_arg(char* value, int min, int max) {
+    char* end;
+    long number = strtol(value, &end, 10);
+    if (*value == '\0' || *end != '\0' || number < min || number > max) {
+	fprintf(stderr, USAGE_ERR_MSG);
+	exit(USAGE_ERR);
+    }
+    return (int) number;
+}
+
+/* make_dir()
+ * ----------
+ * Creates a directory if it does not already exist.
+ *
+ * path: the path of the directory.
+ *
+ * Errors: Exits with status 2 if the directory cannot be created.
+ */
+void make_dir(char* path) {
+    if (mkdir(path, S_IRWXU) && errno != EEXIST) {
+	fprintf(stderr, FILE_ERR_MSG, path);
+	exit(FILE_ERR);
+    }
+}
+
+/* random_word()
+ * -------------
+ * Fills the given buffer with a random lowercase word.
+ *
+ * word: a buffer of at least WORD_LENGTH + 1 characters.
+ *
+ * Returns: void
+ */
+void random_word(char* word) {
+    for (int i = 0; i < WORD_LENGTH; i++) {
+	word[i] = 'a' + rand() % 26;
+    }
+    word[WORD_LENGTH] = '\0';
+}
+
+/* write_input_file()
+ * ------------------
+ * Writes an input file of random words, one per line.
+ *
+ * path: the path of the input file.
+ *
+ * Errors: Exits with status 2 if the file cannot be written.
+ */
+void write_input_file(char* path) {
+    FILE* inputFile = fopen(path, "w");
+    if (inputFile == NULL) {
+	fprintf(stderr, FILE_ERR_MSG, path);
+	exit(FILE_ERR);
+    }
+    char word[WORD_LENGTH + 1];
+    for (int i = 0; i < WORDS_PER_INPUT; i++) {
+	random_word(word);
+	fprintf(inputFile, "%s\n", word);
+    }
+    fclose(inputFile);
+}
+
+/* write_jobspec()
+ * ---------------
+ * Writes the job specification file. Each test uses one of the shared input
+ * 	files with the configured probability, and otherwise gets an input
+ * 	file of its own.
+ *
+ * parameters: the generator parameters.
+ *
+ * Errors: Exits with status 2 if a file cannot be written.
+ */
+void write_jobspec(GenParameters parameters) {
+    char path[PATH_MAX];
+    snprintf(path, PATH_MAX, "%s/" JOBSPEC_NAME, parameters.outputDir);
+    FILE* jobSpecFile = fopen(path, "w");
+    if (jobSpecFile == NULL) {
+	fprintf(stderr, FILE_ERR_MSG, path);
+	exit(FILE_ERR);
+    }
+    fprintf(jobSpecFile, "# %d synthetic tests, %d%% shared inputs\n",
+	    parameters.numOfTests, parameters.sharedPercent);
+
+    char from[WORD_LENGTH + 1];
+    char to[WORD_LENGTH + 1];
+    int numUnique = 0;
+    for (int test = 0; test < parameters.numOfTests; test++) {
+	if (rand() % 100 < parameters.sharedPercent) {
+	    snprintf(path, PATH_MAX, SHARED_INPUT_FMT, parameters.outputDir,
+		    rand() % parameters.poolSize);
+	} else {
+	    snprintf(path, PATH_MAX, UNIQUE_INPUT_FMT, parameters.outputDir,
+		    numUnique++);
+	    write_input_file(path);
+	}
+	random_word(from);
+	random_word(to);
+	fprintf(jobSpecFile, JOBSPEC_LINE_FMT, test, path, from, to);
+    }
+    if (fclose(jobSpecFile)) {
+	fprintf(stderr, FILE_ERR_MSG, JOBSPEC_NAME);
+	exit(FILE_ERR);
+    }
+}
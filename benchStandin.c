@@ -0,0 +1,22 @@
+/*
+ * benchStandin
+ * A trivial stand-in for uqwordladder used when benchmarking
+ * 	testuqwordladder. It copies stdin to stdout and exits with status 0, so
+ * 	that nearly all measured time belongs to the harness.
+ */
+
+#include <unistd.h>
+
+// Size of the buffer used to copy stdin to stdout
+#define COPY_BUFFER 4096
+
+int main(int argc, char** argv) {
+    char buffer[COPY_BUFFER];
+    ssize_t numRead;
+    while ((numRead = read(STDIN_FILENO, buffer, COPY_BUFFER)) > 0) {
+	if (write(STDOUT_FILENO, buffer, numRead) != numRead) {
+	    return 1;
+	}
+    }
+    return 0;
+}
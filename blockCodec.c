@@ -0,0 +1,415 @@
+/*
+ * blockCodec
+ * A fast LZ77 block codec for storing expected output files compressed.
+ *
+ * Each block starts with an 8 byte header of its uncompressed length and its
+ * 	stored length, both little endian. A block that does not get smaller
+ * 	is stored as it is, with both lengths equal. Compressed data is a list
+ * 	of sequences, each a token byte, literal bytes to copy, and a match to
+ * 	copy from earlier in the block. The high and low 4 bits of the token
+ * 	are the number of literals and the match length less MIN_MATCH, where
+ * 	15 means that more length bytes follow. The last sequence of a block
+ * 	only has literals.
+ */
+
+#include "blockCodec.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+// Size of a block header
+#define HEADER_LENGTH 8
+
+// Sequence format
+#define MIN_MATCH 4
+#define MAX_OFFSET 65535
+#define RUN_MASK 15
+#define LENGTH_CONTINUE 255
+
+// Size of the hash table of earlier positions in a block, and how quickly to
+// skip ahead through data that does not compress
+#define HASH_BITS 14
+#define HASH_MULTIPLIER 2654435761U
+#define SKIP_SHIFT 6
+
+// Suffix of the temporary file written while compressing a file
+#define TEMP_SUFFIX ".tmp"
+
+/* Function prototypes */
+static int hash_sequence(const unsigned char* position);
+static unsigned char* write_length(unsigned char* out, int length);
+static unsigned char* write_sequence(unsigned char* out,
+	const unsigned char* literals, int numLiterals, int offset,
+	int matchLength);
+static bool read_length(const unsigned char** in, const unsigned char* end,
+	int* length);
+static void write_header(unsigned char* header, int rawLength,
+	int storedLength);
+static ssize_t read_fully(int fd, void* buffer, size_t length);
+static bool write_fully(int fd, const void* buffer, size_t length);
+
+/* codec_compress_block()
+ * ----------------------
+ * Compresses a block of data.
+ *
+ * src: a pointer to the data to compress.
+ * srcLength: the number of bytes to compress, at most CODEC_BLOCK_SIZE.
+ * dst: a pointer to a buffer of at least CODEC_BOUND(srcLength) bytes to
+ * 	store the compressed data in.
+ *
+ * Returns: the number of bytes of compressed data.
+ */
+int codec_compress_block(const char* src, int srcLength, char* dst) {
+    const unsigned char* in = (const unsigned char*) src;
+    unsigned char* out = (unsigned char*) dst;
+    int table[1 << HASH_BITS];
+    for (int i = 0; i < (1 << HASH_BITS); i++) {
+	table[i] = -1;
+    }
+
+    // Greedily take the match at each position found through the table.
+    int anchor = 0;
+    int i = 0;
+    while (i + MIN_MATCH <= srcLength) {
+	int hash = hash_sequence(in + i);
+	int candidate = table[hash];
+	table[hash] = i;
+	if (candidate < 0 || i - candidate > MAX_OFFSET ||
+		memcmp(in + candidate, in + i, MIN_MATCH) != 0) {
+	    i += 1 + ((i - anchor) >> SKIP_SHIFT);
+	    continue;
+	}
+	int matchLength = MIN_MATCH;
+	while (i + matchLength < srcLength &&
+		in[candidate + matchLength] == in[i + matchLength]) {
+	    matchLength++;
+	}
+	out = write_sequence(out, in + anchor, i - anchor, i - candidate,
+		matchLength);
+	i += matchLength;
+	anchor = i;
+    }
+    out = write_sequence(out, in + anchor, srcLength - anchor, 0, 0);
+    return out - (unsigned char*) dst;
+}
+
+/* codec_decompress_block()
+ * ------------------------
+ * Decompresses a block of data, checking that it is well formed.
+ *
+ * src: a pointer to the compressed data.
+ * srcLength: the number of bytes of compressed data.
+ * dst: a pointer to the buffer to store the decompressed data in.
+ * dstCapacity: the size of the buffer.
+ *
+ * Returns: the number of bytes of decompressed data, or -1 if the data is
+ * 	corrupt or does not fit in the buffer.
+ */
+int codec_decompress_block(const char* src, int srcLength, char* dst,
+	int dstCapacity) {
+    const unsigned char* in = (const unsigned char*) src;
+    const unsigned char* end = in + srcLength;
+    unsigned char* start = (unsigned char*) dst;
+    unsigned char* out = start;
+    unsigned char* outEnd = start + dstCapacity;
+
+    while (in < end) {
+	int token = *in++;
+	int numLiterals = token >> 4;
+	if ((numLiterals == RUN_MASK && !read_length(&in, end, &numLiterals))
+		|| numLiterals > end - in || numLiterals > outEnd - out) {
+	    return -1;
+	}
+	memcpy(out, in, numLiterals);
+	in += numLiterals;
+	out += numLiterals;
+	if (in == end) {
+	    break;
+	}
+
+	if (end - in < 2) {
+	    return -1;
+	}
+	int offset = in[0] | in[1] << 8;
+	in += 2;
+	int matchLength = token & RUN_MASK;
+	if (matchLength == RUN_MASK && !read_length(&in, end, &matchLength)) {
+	    return -1;
+	}
+	matchLength += MIN_MATCH;
+	if (offset == 0 || offset > out - start ||
+		matchLength > outEnd - out) {
+	    return -1;
+	}
+	// A match may overlap the bytes it produces, repeating a pattern.
+	if (offset >= matchLength) {
+	    memcpy(out, out - offset, matchLength);
+	    out += matchLength;
+	} else {
+	    for (int i = 0; i < matchLength; i++, out++) {
+		*out = *(out - offset);
+	    }
+	}
+    }
+    return out - start;
+}
+
+/* codec_compress_file()
+ * ---------------------
+ * Replaces a file with its compressed form. The compressed file is written
+ * 	beside it and renamed over it, so the file is never left half
+ * 	written.
+ *
+ * path: a pointer to the array with the filepath of the file.
+ *
+ * Returns: true if the file was compressed, else returns false and leaves the
+ * 	file unchanged.
+ */
+bool codec_compress_file(char* path) {
+    int in = open(path, O_RDONLY);
+    if (in == -1) {
+	return false;
+    }
+    char* tempPath = malloc(strlen(path) + strlen(TEMP_SUFFIX) + 1);
+    sprintf(tempPath, "%s%s", path, TEMP_SUFFIX);
+    int out = open(tempPath, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    char* raw = malloc(CODEC_BLOCK_SIZE);
+    char* block = malloc(HEADER_LENGTH + CODEC_BOUND(CODEC_BLOCK_SIZE));
+
+    bool ok = out != -1 && write_fully(out, CODEC_MAGIC, CODEC_MAGIC_LENGTH);
+    ssize_t numRead;
+    while (ok && (numRead = read_fully(in, raw, CODEC_BLOCK_SIZE)) > 0) {
+	int storedLength = codec_compress_block(raw, numRead,
+		block + HEADER_LENGTH);
+	if (storedLength >= numRead) {
+	    storedLength = numRead;
+	    memcpy(block + HEADER_LENGTH, raw, numRead);
+	}
+	write_header((unsigned char*) block, numRead, storedLength);
+	ok = write_fully(out, block, HEADER_LENGTH + storedLength);
+    }
+    ok = ok && numRead == 0;
+
+    close(in);
+    if (out != -1) {
+	ok = close(out) == 0 && ok;
+    }
+    if (ok) {
+	ok = rename(tempPath, path) == 0;
+    }
+    if (!ok) {
+	unlink(tempPath);
+    }
+    free(tempPath);
+    free(raw);
+    free(block);
+    return ok;
+}
+
+/* codec_read_block()
+ * ------------------
+ * Reads and decompresses the next block of a compressed file, after its
+ * 	CODEC_MAGIC has been read.
+ *
+ * fd: the file descriptor of the compressed file.
+ * compressed: a pointer to a buffer of CODEC_BOUND(CODEC_BLOCK_SIZE) bytes
+ * 	to read the compressed data into.
+ * block: a pointer to a buffer of CODEC_BLOCK_SIZE bytes to store the
+ * 	decompressed block in.
+ *
+ * Returns: the number of bytes in the block, 0 at the end of the file, or -1
+ * 	if the file could not be read or is corrupt.
+ */
+int codec_read_block(int fd, char* compressed, char* block) {
+    unsigned char header[HEADER_LENGTH];
+    ssize_t numRead = read_fully(fd, header, HEADER_LENGTH);
+    if (numRead != HEADER_LENGTH) {
+	return numRead == 0 ? 0 : -1;
+    }
+    uint32_t rawLength = header[0] | header[1] << 8 | header[2] << 16 |
+	    (uint32_t) header[3] << 24;
+    uint32_t storedLength = header[4] | header[5] << 8 | header[6] << 16 |
+	    (uint32_t) header[7] << 24;
+    if (rawLength == 0 || rawLength > CODEC_BLOCK_SIZE ||
+	    storedLength > CODEC_BOUND(CODEC_BLOCK_SIZE)) {
+	return -1;
+    }
+
+    // A stored block is read straight into place.
+    if (storedLength == rawLength) {
+	return read_fully(fd, block, rawLength) == rawLength ? rawLength : -1;
+    }
+    if (read_fully(fd, compressed, storedLength) != storedLength ||
+	    codec_decompress_block(compressed, storedLength, block,
+	    CODEC_BLOCK_SIZE) != rawLength) {
+	return -1;
+    }
+    return rawLength;
+}
+
+/* hash_sequence()
+ * ---------------
+ * Hashes the MIN_MATCH bytes at a position, to find earlier positions with
+ * 	the same bytes.
+ *
+ * position: a pointer to the bytes to hash.
+ *
+ * Returns: the index in the hash table for the bytes.
+ */
+static int hash_sequence(const unsigned char* position) {
+    uint32_t sequence;
+    memcpy(&sequence, position, MIN_MATCH);
+    return (sequence * HASH_MULTIPLIER) >> (32 - HASH_BITS);
+}
+
+/* write_length()
+ * --------------
+ * Writes the part of a literal or match length that did not fit in the
+ * 	token.
+ *
+ * out: a pointer to where to write the length.
+ * length: the remaining length.
+ *
+ * Returns: a pointer to the byte after the length.
+ */
+static unsigned char* write_length(unsigned char* out, int length) {
+    while (length >= LENGTH_CONTINUE) {
+	*out++ = LENGTH_CONTINUE;
+	length -= LENGTH_CONTINUE;
+    }
+    *out++ = length;
+    return out;
+}
+
+/* write_sequence()
+ * ----------------
+ * Writes a sequence of literals followed by a match.
+ *
+ * out: a pointer to where to write the sequence.
+ * literals: a pointer to the literal bytes.
+ * numLiterals: the number of literal bytes.
+ * offset: the distance back to the start of the match.
+ * matchLength: the length of the match, or 0 for the last sequence of a
+ * 	block, which has no match.
+ *
+ * Returns: a pointer to the byte after the sequence.
+ */
+static unsigned char* write_sequence(unsigned char* out,
+	const unsigned char* literals, int numLiterals, int offset,
+	int matchLength) {
+    int matchCode = matchLength > 0 ? matchLength - MIN_MATCH : 0;
+    unsigned char* token = out++;
+    *token = (numLiterals < RUN_MASK ? numLiterals : RUN_MASK) << 4;
+    if (numLiterals >= RUN_MASK) {
+	out = write_length(out, numLiterals - RUN_MASK);
+    }
+    memcpy(out, literals, numLiterals);
+    out += numLiterals;
+    if (matchLength == 0) {
+	return out;
+    }
+
+    *token |= matchCode < RUN_MASK ? matchCode : RUN_MASK;
+    *out++ = offset & 0xff;
+    *out++ = offset >> 8;
+    if (matchCode >= RUN_MASK) {
+	out = write_length(out, matchCode - RUN_MASK);
+    }
+    return out;
+}
+
+/* read_length()
+ * -------------
+ * Reads the part of a literal or match length that did not fit in the
+ * 	token, adding it to the length.
+ *
+ * in: a pointer to the position to read from, which is moved past the
+ * 	length.
+ * end: a pointer to the end of the compressed data.
+ * length: a pointer to the length to add to.
+ *
+ * Returns: true if the length was read, or false if the data ended or the
+ * 	length is longer than any block.
+ */
+static bool read_length(const unsigned char** in, const unsigned char* end,
+	int* length) {
+    int byte;
+    do {
+	if (*in == end || *length > CODEC_BLOCK_SIZE) {
+	    return false;
+	}
+	byte = *(*in)++;
+	*length += byte;
+    } while (byte == LENGTH_CONTINUE);
+    return true;
+}
+
+/* write_header()
+ * --------------
+ * Stores the lengths of a block in its header.
+ *
+ * header: a pointer to the HEADER_LENGTH bytes of the header.
+ * rawLength: the uncompressed length of the block.
+ * storedLength: the length of the block's data in the file.
+ *
+ * Returns: void
+ */
+static void write_header(unsigned char* header, int rawLength,
+	int storedLength) {
+    for (int i = 0; i < 4; i++) {
+	header[i] = rawLength >> (8 * i);
+	header[4 + i] = storedLength >> (8 * i);
+    }
+}
+
+/* read_fully()
+ * ------------
+ * Reads from a file until the buffer is full or the file ends.
+ *
+ * fd: the file descriptor to read from.
+ * buffer: a pointer to the buffer to read into.
+ * length: the number of bytes to read.
+ *
+ * Returns: the number of bytes read, or -1 if reading failed.
+ */
+static ssize_t read_fully(int fd, void* buffer, size_t length) {
+    size_t total = 0;
+    while (total < length) {
+	ssize_t numRead = read(fd, (char*) buffer + total, length - total);
+	if (numRead == 0) {
+	    break;
+	} else if (numRead < 0 && errno != EINTR) {
+	    return -1;
+	}
+	total += numRead > 0 ? numRead : 0;
+    }
+    return total;
+}
+
+/* write_fully()
+ * -------------
+ * Writes all of a buffer to a file.
+ *
+ * fd: the file descriptor to write to.
+ * buffer: a pointer to the data to write.
+ * length: the number of bytes to write.
+ *
+ * Returns: true if all of the data was written, else returns false.
+ */
+static bool write_fully(int fd, const void* buffer, size_t length) {
+    size_t total = 0;
+    while (total < length) {
+	ssize_t numWritten = write(fd, (const char*) buffer + total,
+		length - total);
+	if (numWritten < 0 && errno != EINTR) {
+	    return false;
+	}
+	total += numWritten > 0 ? numWritten : 0;
+    }
+    return true;
+}
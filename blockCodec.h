@@ -0,0 +1,30 @@
+/*
+ * blockCodec
+ * A fast LZ77 block codec for storing expected output files compressed.
+ * 	A compressed file is CODEC_MAGIC followed by blocks of at most
+ * 	CODEC_BLOCK_SIZE bytes of the original file, each compressed on its
+ * 	own so that it can be decompressed while streaming.
+ */
+
+#ifndef BLOCK_CODEC_H
+#define BLOCK_CODEC_H
+
+#include <stdbool.h>
+
+// Marks the start of a compressed file
+#define CODEC_MAGIC "\x89UQZ\r\n\x1a\n"
+#define CODEC_MAGIC_LENGTH 8
+
+// Largest number of uncompressed bytes in a block
+#define CODEC_BLOCK_SIZE 65536
+
+// Largest size of a compressed block of the given size, including its header
+#define CODEC_BOUND(size) ((size) + (size) / 255 + 16)
+
+int codec_compress_block(const char* src, int srcLength, char* dst);
+int codec_decompress_block(const char* src, int srcLength, char* dst,
+	int dstCapacity);
+bool codec_compress_file(char* path);
+int codec_read_block(int fd, char* compressed, char* block);
+
+#endif
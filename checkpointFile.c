@@ -0,0 +1,328 @@
+/*
+ * checkpointFile
+ * A file in the test directory with the verdicts of the tests finished so
+ * 	far in a run, so that an interrupted run can be resumed without
+ * 	running them again.
+ *
+ * The file starts with a header line naming the hash of each candidate
+ * 	program, followed by a line for each finished test: its ID, the
+ * 	modification time of its expected output, and the verdict and run
+ * 	time of each program, separated by tabs. A test is only resumed if
+ * 	the programs and its expected output are the same as when it ran.
+ *
+ * Lines are buffered and synced to disk every CHECKPOINT_BATCH tests or
+ * 	CHECKPOINT_INTERVAL seconds, whichever comes first, so that a crash
+ * 	loses at most one batch. A line cut short by a crash is ignored.
+ */
+
+#include "checkpointFile.h"
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// Header of a checkpoint, followed by the hash of each program
+#define CHECKPOINT_HEADER "# testuqwordladder checkpoint"
+#define CHECKPOINT_HASH " %016" PRIx64
+
+// Separators of the fields of a test, and of the verdict and run time of a
+// program
+#define FIELD_SEPARATOR '\t'
+#define RESULT_SEPARATOR ':'
+
+// Size of the buffer for the lines not yet written, and of the header
+#define CHECKPOINT_BUFFER 65536
+#define HEADER_BUFFER 1024
+
+// Largest number of tests, and longest time in seconds, between syncs
+#define CHECKPOINT_BATCH 64
+#define CHECKPOINT_INTERVAL 1.0
+
+/* Function prototypes */
+static bool read_finished(FinishedTests* finished, char* path,
+	char* header, int numPrograms, bool* endsWithNewline);
+static bool parse_line(FinishedTests* finished, char* line,
+	int numPrograms);
+static double seconds_between(struct timespec* from, struct timespec* to);
+
+/* checkpoint_open()
+ * -----------------
+ * Starts the checkpoint of a run. With resume, the tests finished in the
+ * 	checkpoint of an earlier run of the same programs are read, and the
+ * 	checkpoint is continued. Otherwise a new checkpoint is started.
+ *
+ * checkpoint: a pointer to the struct to store the checkpoint in.
+ * path: a pointer to the array with the path of the checkpoint file.
+ * programHashes: a pointer to the array with the hash of each candidate
+ * 	program.
+ * numPrograms: the number of candidate programs.
+ * resume: whether to resume the tests of an earlier run.
+ *
+ * Returns: the number of tests finished in an earlier run.
+ */
+int checkpoint_open(Checkpoint* checkpoint, char* path,
+	uint64_t* programHashes, int numPrograms, bool resume) {
+    char header[HEADER_BUFFER];
+    size_t length = snprintf(header, HEADER_BUFFER, "%s", CHECKPOINT_HEADER);
+    for (int i = 0; i < numPrograms && length < HEADER_BUFFER; i++) {
+	length += snprintf(header + length, HEADER_BUFFER - length,
+		CHECKPOINT_HASH, programHashes[i]);
+    }
+
+    checkpoint->path = strdup(path);
+    checkpoint->numPrograms = numPrograms;
+    checkpoint->numUnsynced = 0;
+    checkpoint->owner = getpid();
+    clock_gettime(CLOCK_MONOTONIC, &checkpoint->lastSync);
+    memset(&checkpoint->finished, 0, sizeof(FinishedTests));
+    bool endsWithNewline = true;
+    bool resumed = resume && read_finished(&checkpoint->finished, path,
+	    header, numPrograms, &endsWithNewline);
+
+    checkpoint->file = fopen(path, resumed ? "a" : "w");
+    checkpoint->buffer = malloc(CHECKPOINT_BUFFER);
+    if (checkpoint->file == NULL) {
+	return checkpoint->finished.numTests;
+    }
+    setvbuf(checkpoint->file, checkpoint->buffer, _IOFBF, CHECKPOINT_BUFFER);
+    if (!resumed) {
+	fprintf(checkpoint->file, "%s\n", header);
+    } else if (!endsWithNewline) {
+	fputc('\n', checkpoint->file);
+    }
+    checkpoint_sync(checkpoint);
+    return checkpoint->finished.numTests;
+}
+
+/* checkpoint_find()
+ * -----------------
+ * Finds the verdicts of a test finished in an earlier run.
+ *
+ * checkpoint: a pointer to the struct of the checkpoint.
+ * testID: a pointer to the array with the ID of the test.
+ * goldenTime: the modification time of the test's expected output, in
+ * 	nanoseconds, which must be the same as when it ran.
+ * verdicts: a pointer to an array to store the verdict of each program in.
+ * runTimes: a pointer to an array to store the run time of each program in.
+ *
+ * Returns: true if the test was finished, else returns false.
+ */
+bool checkpoint_find(Checkpoint* checkpoint, char* testID,
+	long long goldenTime, int* verdicts, double* runTimes) {
+    FinishedTests* finished = &checkpoint->finished;
+    if (finished->numTests == 0) {
+	return false;
+    }
+    int index = string_table_find(&finished->table, testID);
+    if (index == STRING_NOT_FOUND ||
+	    finished->goldenTimes[index] != goldenTime) {
+	return false;
+    }
+    int numPrograms = checkpoint->numPrograms;
+    memcpy(verdicts, finished->verdicts + index * numPrograms,
+	    sizeof(int) * numPrograms);
+    memcpy(runTimes, finished->runTimes + index * numPrograms,
+	    sizeof(double) * numPrograms);
+    return true;
+}
+
+/* checkpoint_add()
+ * ----------------
+ * Adds a finished test to the checkpoint, and syncs the checkpoint if
+ * 	CHECKPOINT_BATCH tests or CHECKPOINT_INTERVAL seconds have passed
+ * 	since it was last synced.
+ *
+ * checkpoint: a pointer to the struct of the checkpoint.
+ * testID: a pointer to the array with the ID of the test.
+ * goldenTime: the modification time of the test's expected output, in
+ * 	nanoseconds.
+ * verdicts: a pointer to the array with the verdict of each program.
+ * runTimes: a pointer to the array with the run time of each program.
+ *
+ * Returns: void
+ */
+void checkpoint_add(Checkpoint* checkpoint, char* testID,
+	long long goldenTime, int* verdicts, double* runTimes) {
+    if (checkpoint->file == NULL) {
+	return;
+    }
+    fprintf(checkpoint->file, "%s%c%lld", testID, FIELD_SEPARATOR,
+	    goldenTime);
+    for (int i = 0; i < checkpoint->numPrograms; i++) {
+	fprintf(checkpoint->file, "%c%d%c%.6f", FIELD_SEPARATOR, verdicts[i],
+		RESULT_SEPARATOR, runTimes[i]);
+    }
+    fputc('\n', checkpoint->file);
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (++checkpoint->numUnsynced >= CHECKPOINT_BATCH ||
+	    seconds_between(&checkpoint->lastSync, &now) >=
+	    CHECKPOINT_INTERVAL) {
+	checkpoint_sync(checkpoint);
+    }
+}
+
+/* checkpoint_sync()
+ * -----------------
+ * Writes the buffered lines of the checkpoint and waits for them to reach
+ * 	the disk. Only the process that started the checkpoint does this.
+ *
+ * checkpoint: a pointer to the struct of the checkpoint.
+ *
+ * Returns: void
+ */
+void checkpoint_sync(Checkpoint* checkpoint) {
+    if (checkpoint->file == NULL || checkpoint->owner != getpid()) {
+	return;
+    }
+    fflush(checkpoint->file);
+    fsync(fileno(checkpoint->file));
+    checkpoint->numUnsynced = 0;
+    clock_gettime(CLOCK_MONOTONIC, &checkpoint->lastSync);
+}
+
+/* checkpoint_remove()
+ * -------------------
+ * Removes the checkpoint of a run that finished every test, so that the
+ * 	next run does not resume it.
+ *
+ * checkpoint: a pointer to the struct of the checkpoint.
+ *
+ * Returns: void
+ */
+void checkpoint_remove(Checkpoint* checkpoint) {
+    if (checkpoint->file == NULL) {
+	return;
+    }
+    fclose(checkpoint->file);
+    checkpoint->file = NULL;
+    unlink(checkpoint->path);
+}
+
+/* read_finished()
+ * ---------------
+ * Reads the tests finished in the checkpoint of an earlier run.
+ *
+ * finished: a pointer to the struct to store the tests in.
+ * path: a pointer to the array with the path of the checkpoint file.
+ * header: a pointer to the array with the header the checkpoint must start
+ * 	with, which names the same programs.
+ * numPrograms: the number of candidate programs.
+ * endsWithNewline: a pointer to store whether the last line is complete in.
+ *
+ * Returns: true if the checkpoint is of the same programs, else returns
+ * 	false.
+ */
+static bool read_finished(FinishedTests* finished, char* path,
+	char* header, int numPrograms, bool* endsWithNewline) {
+    int fd = open(path, O_RDONLY);
+    struct stat fileStat;
+    if (fd == -1 || fstat(fd, &fileStat) == -1) {
+	if (fd != -1) {
+	    close(fd);
+	}
+	return false;
+    }
+    size_t size = fileStat.st_size;
+    char* text = malloc(size + 1);
+    size_t numRead = 0;
+    ssize_t result;
+    while (numRead < size &&
+	    (result = read(fd, text + numRead, size - numRead)) > 0) {
+	numRead += result;
+    }
+    close(fd);
+    text[numRead] = '\0';
+    size_t headerLength = strlen(header);
+    if (numRead <= headerLength || strncmp(text, header, headerLength) != 0 ||
+	    text[headerLength] != '\n') {
+	free(text);
+	return false;
+    }
+    *endsWithNewline = text[numRead - 1] == '\n';
+
+    // There are at most as many tests as lines.
+    int numLines = 0;
+    for (char* c = text; *c != '\0'; c++) {
+	numLines += *c == '\n';
+    }
+    finished->text = text;
+    finished->testIDs = malloc(sizeof(char*) * numLines);
+    finished->goldenTimes = malloc(sizeof(long long) * numLines);
+    finished->verdicts = malloc(sizeof(int) * numLines * numPrograms);
+    finished->runTimes = malloc(sizeof(double) * numLines * numPrograms);
+    string_table_start(&finished->table, numLines);
+
+    // A line without a newline was cut short.
+    char* line = text + headerLength + 1;
+    char* end;
+    while ((end = strchr(line, '\n')) != NULL) {
+	*end = '\0';
+	parse_line(finished, line, numPrograms);
+	line = end + 1;
+    }
+    return true;
+}
+
+/* parse_line()
+ * ------------
+ * Adds the test on a line of a checkpoint to the finished tests, in place
+ * 	of any earlier line of the same test.
+ *
+ * finished: a pointer to the struct of the finished tests.
+ * line: a pointer to the array with the line, which is split in place.
+ * numPrograms: the number of candidate programs.
+ *
+ * Returns: true if the line is valid, else returns false.
+ */
+static bool parse_line(FinishedTests* finished, char* line,
+	int numPrograms) {
+    char* field = strchr(line, FIELD_SEPARATOR);
+    if (field == NULL) {
+	return false;
+    }
+    *field++ = '\0';
+    int index = finished->numTests;
+    char* end;
+    finished->goldenTimes[index] = strtoll(field, &end, 10);
+    for (int i = 0; i < numPrograms; i++) {
+	if (*end != FIELD_SEPARATOR) {
+	    return false;
+	}
+	finished->verdicts[index * numPrograms + i] = strtol(end + 1, &end,
+		10);
+	if (*end != RESULT_SEPARATOR) {
+	    return false;
+	}
+	finished->runTimes[index * numPrograms + i] = strtod(end + 1, &end);
+    }
+    if (*end != '\0') {
+	return false;
+    }
+    finished->testIDs[index] = line;
+    int earlier = string_table_add(&finished->table, line, index);
+    if (earlier == index) {
+	finished->numTests++;
+    } else {
+	// A later line of the same test replaces the earlier one.
+	finished->goldenTimes[earlier] = finished->goldenTimes[index];
+	memcpy(finished->verdicts + earlier * numPrograms,
+		finished->verdicts + index * numPrograms,
+		sizeof(int) * numPrograms);
+	memcpy(finished->runTimes + earlier * numPrograms,
+		finished->runTimes + index * numPrograms,
+		sizeof(double) * numPrograms);
+    }
+    return true;
+}
+
+/* seconds_between()
+ * -----------------
+ * Returns the number of seconds from one monotonic time to another.
+ */
+static double seconds_between(struct timespec* from, struct timespec* to) {
+    return to->tv_sec - from->tv_sec + (to->tv_nsec - from->tv_nsec) / 1e9;
+}
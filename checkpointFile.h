@@ -0,0 +1,51 @@
+/*
+ * checkpointFile
+ * A file in the test directory with the verdicts of the tests finished so
+ * 	far in a run, so that an interrupted run can be resumed without
+ * 	running them again.
+ */
+
+#ifndef CHECKPOINT_FILE_H
+#define CHECKPOINT_FILE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include <sys/types.h>
+#include "stringTable.h"
+
+// Verdicts and run times of the tests finished in an earlier run, and a
+// hash table of their indexes by test ID
+typedef struct {
+    char* text;
+    char** testIDs;
+    long long* goldenTimes;
+    int* verdicts;
+    double* runTimes;
+    int numTests;
+    StringTable table;
+} FinishedTests;
+
+// Checkpoint of a run, with the records written since the last sync
+typedef struct {
+    char* path;
+    FILE* file;
+    char* buffer;
+    int numPrograms;
+    int numUnsynced;
+    struct timespec lastSync;
+    pid_t owner;
+    FinishedTests finished;
+} Checkpoint;
+
+int checkpoint_open(Checkpoint* checkpoint, char* path,
+	uint64_t* programHashes, int numPrograms, bool resume);
+bool checkpoint_find(Checkpoint* checkpoint, char* testID,
+	long long goldenTime, int* verdicts, double* runTimes);
+void checkpoint_add(Checkpoint* checkpoint, char* testID,
+	long long goldenTime, int* verdicts, double* runTimes);
+void checkpoint_sync(Checkpoint* checkpoint);
+void checkpoint_remove(Checkpoint* checkpoint);
+
+#endif
@@ -0,0 +1,451 @@
+/*
+ * compare
+ * Compares the output of the program under test, read from a pipe, against
+ * 	the expected output in a file. Both are streamed through fixed size
+ * 	buffers, so that large outputs are never held in memory.
+ *
+ * The expected output may be stored compressed by blockCodec, in which case
+ * 	it is decompressed one block at a time as it is read.
+ *
+ * Exact mode compares the bytes with memcmp(). Whitespace mode compares line
+ * 	by line, ignoring trailing whitespace on each line (including the
+ * 	carriage return of CRLF line endings) and trailing blank lines. Lines
+ * 	mode ignores the order of lines: each side is summarised by its number
+ * 	of lines and two sums of per-line hashes, which are equal for any
+ * 	ordering of the same lines.
+ */
+
+#include "compare.h"
+#include "blockCodec.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+
+// Size of the buffer for reading each side of the comparison, which holds
+// one block of a compressed file
+#define READ_BUFFER CODEC_BLOCK_SIZE
+
+// Initial size of the buffer for a line in whitespace mode
+#define INITIAL_LINE_SIZE 256
+
+// Names of the comparison modes in job specification files
+#define EXACT_NAME "exact"
+#define WHITESPACE_NAME "whitespace"
+#define LINES_NAME "lines"
+
+// Hash parameters: FNV-1a for the first per-line hash, and a polynomial
+// hash for the second so that the two are independent.
+#define FNV64_OFFSET 14695981039346656037ULL
+#define FNV64_PRIME 1099511628211ULL
+#define POLY_SEED 0x9e3779b97f4a7c15ULL
+#define POLY_BASE 0x100000001b3ULL
+
+// Buffered reader of a file descriptor. A reader of a compressed file reads
+// into the compressed buffer and decompresses into the buffer.
+typedef struct {
+    int fd;
+    char* buffer;
+    size_t start;
+    size_t end;
+    bool eof;
+    bool error;
+    char* compressed;
+} Reader;
+
+// A line of output, without its newline
+typedef struct {
+    char* text;
+    size_t length;
+    size_t size;
+} Line;
+
+// Order independent summary of the lines of an output
+typedef struct {
+    uint64_t numLines;
+    uint64_t firstSum;
+    uint64_t secondSum;
+} LineMultiset;
+
+/* Function prototypes */
+static void reader_open_expected(Reader* reader);
+static bool reader_fill(Reader* reader);
+static int compare_exact(Reader* actual, Reader* expected);
+static bool read_next_line(Reader* reader, Line* line);
+static void trim_trailing_whitespace(Line* line);
+static bool only_blank_lines(Reader* reader, Line* line);
+static int compare_whitespace(Reader* actual, Reader* expected);
+static uint64_t mix_hash(uint64_t hash);
+static void summarise_lines(Reader* reader, LineMultiset* summary);
+static int compare_lines(Reader* actual, Reader* expected);
+
+/* parse_compare_mode()
+ * --------------------
+ * Gets the comparison mode with the given name.
+ *
+ * name: the name of the mode, as given in a job specifications file.
+ * mode: a pointer to store the mode in.
+ *
+ * Returns: true if the name is a valid mode, else returns false.
+ */
+bool parse_compare_mode(char* name, enum CompareMode* mode) {
+    char* names[] = {EXACT_NAME, WHITESPACE_NAME, LINES_NAME};
+    enum CompareMode modes[] = {COMPARE_EXACT, COMPARE_WHITESPACE,
+	    COMPARE_LINES};
+    for (int i = 0; i < sizeof(modes) / sizeof(modes[0]); i++) {
+	if (strcmp(name, names[i]) == 0) {
+	    *mode = modes[i];
+	    return true;
+	}
+    }
+    return false;
+}
+
+/* compare_mode_name()
+ * -------------------
+ * Returns the name of a comparison mode, as given in a job specifications
+ * 	file.
+ */
+const char* compare_mode_name(enum CompareMode mode) {
+    const char* names[] = {EXACT_NAME, WHITESPACE_NAME, LINES_NAME};
+    return names[mode];
+}
+
+/* compare_output()
+ * ----------------
+ * Compares the output read from a file descriptor against the expected
+ * 	output in a file. Stops reading at the first difference where the
+ * 	mode allows it.
+ *
+ * fd: the file descriptor to read the output from.
+ * expectedPath: a pointer to the array with the filepath of the expected
+ * 	output.
+ * mode: the way of comparing the two.
+ *
+ * Returns: COMPARE_SAME if they match, COMPARE_DIFFERENT if they differ, or
+ * 	COMPARE_TROUBLE if either could not be read, or had a line too long
+ * 	to fit in memory.
+ */
+int compare_output(int fd, char* expectedPath, enum CompareMode mode) {
+    int expectedFd = open(expectedPath, O_RDONLY);
+    if (expectedFd == -1) {
+	return COMPARE_TROUBLE;
+    }
+    Reader actual = {fd, malloc(READ_BUFFER), 0, 0, false, false, NULL};
+    Reader expected = {expectedFd, malloc(READ_BUFFER), 0, 0, false, false,
+	    NULL};
+    reader_open_expected(&expected);
+
+    int result;
+    switch (mode) {
+	case COMPARE_WHITESPACE:
+	    result = compare_whitespace(&actual, &expected);
+	    break;
+	case COMPARE_LINES:
+	    result = compare_lines(&actual, &expected);
+	    break;
+	default:
+	    result = compare_exact(&actual, &expected);
+	    break;
+    }
+    if (actual.error || expected.error) {
+	result = COMPARE_TROUBLE;
+    }
+
+    close(expectedFd);
+    free(actual.buffer);
+    free(expected.buffer);
+    free(expected.compressed);
+    return result;
+}
+
+/* reader_open_expected()
+ * ----------------------
+ * Checks whether the expected output file is compressed by reading the
+ * 	start of it. If it is not, the bytes read stay in the buffer.
+ *
+ * reader: a pointer to the reader of the expected output.
+ *
+ * Returns: void
+ */
+static void reader_open_expected(Reader* reader) {
+    while (reader->end < CODEC_MAGIC_LENGTH && !reader->eof) {
+	ssize_t numRead = read(reader->fd, reader->buffer + reader->end,
+		CODEC_MAGIC_LENGTH - reader->end);
+	if (numRead > 0) {
+	    reader->end += numRead;
+	} else if (numRead == 0 || errno != EINTR) {
+	    reader->eof = true;
+	    reader->error = numRead < 0;
+	}
+    }
+    if (reader->end == CODEC_MAGIC_LENGTH &&
+	    memcmp(reader->buffer, CODEC_MAGIC, CODEC_MAGIC_LENGTH) == 0) {
+	reader->compressed = malloc(CODEC_BOUND(CODEC_BLOCK_SIZE));
+	reader->end = 0;
+    }
+}
+
+/* reader_fill()
+ * -------------
+ * Reads more data into a reader's buffer if all of it has been used.
+ *
+ * reader: a pointer to the reader.
+ *
+ * Returns: true if the buffer has data, or false at the end of the input.
+ */
+static bool reader_fill(Reader* reader) {
+    while (reader->start == reader->end && !reader->eof) {
+	ssize_t numRead = reader->compressed != NULL ?
+		codec_read_block(reader->fd, reader->compressed,
+		reader->buffer) :
+		read(reader->fd, reader->buffer, READ_BUFFER);
+	if (numRead > 0) {
+	    reader->start = 0;
+	    reader->end = numRead;
+	} else if (numRead == 0 || reader->compressed != NULL ||
+		errno != EINTR) {
+	    reader->eof = true;
+	    reader->error = numRead < 0;
+	}
+    }
+    return reader->start < reader->end;
+}
+
+/* compare_exact()
+ * ---------------
+ * Compares two inputs byte for byte.
+ *
+ * actual: a pointer to the reader of the output under test.
+ * expected: a pointer to the reader of the expected output.
+ *
+ * Returns: COMPARE_SAME if they are identical, else COMPARE_DIFFERENT.
+ */
+static int compare_exact(Reader* actual, Reader* expected) {
+    while (true) {
+	bool actualData = reader_fill(actual);
+	bool expectedData = reader_fill(expected);
+	if (!actualData || !expectedData) {
+	    return actualData == expectedData ? COMPARE_SAME :
+		    COMPARE_DIFFERENT;
+	}
+	size_t length = actual->end - actual->start;
+	if (expected->end - expected->start < length) {
+	    length = expected->end - expected->start;
+	}
+	if (memcmp(actual->buffer + actual->start,
+		expected->buffer + expected->start, length) != 0) {
+	    return COMPARE_DIFFERENT;
+	}
+	actual->start += length;
+	expected->start += length;
+    }
+}
+
+/* read_next_line()
+ * ----------------
+ * Reads the next line from a reader, growing the line's buffer as needed.
+ *
+ * reader: a pointer to the reader, whose error is set if the line does not
+ * 	fit in memory.
+ * line: a pointer to the line to store the text in, without its newline.
+ *
+ * Returns: true if a line was read, or false at the end of the input or on
+ * 	an error.
+ */
+static bool read_next_line(Reader* reader, Line* line) {
+    line->length = 0;
+    bool readAny = false;
+    while (reader_fill(reader)) {
+	readAny = true;
+	char* start = reader->buffer + reader->start;
+	size_t available = reader->end - reader->start;
+	char* newline = memchr(start, '\n', available);
+	size_t length = newline != NULL ? newline - start : available;
+
+	if (line->length + length > line->size) {
+	    size_t size = line->size;
+	    while (line->length + length > size) {
+		size *= 2;
+	    }
+	    char* text = realloc(line->text, size);
+	    if (text == NULL) {
+		reader->error = true;
+		return false;
+	    }
+	    line->text = text;
+	    line->size = size;
+	}
+	memcpy(line->text + line->length, start, length);
+	line->length += length;
+	reader->start += length;
+	if (newline != NULL) {
+	    reader->start++;
+	    break;
+	}
+    }
+    return readAny;
+}
+
+/* trim_trailing_whitespace()
+ * --------------------------
+ * Removes spaces, tabs and carriage returns from the end of a line.
+ *
+ * line: a pointer to the line.
+ *
+ * Returns: void
+ */
+static void trim_trailing_whitespace(Line* line) {
+    while (line->length > 0 && (line->text[line->length - 1] == ' ' ||
+	    line->text[line->length - 1] == '\t' ||
+	    line->text[line->length - 1] == '\r')) {
+	line->length--;
+    }
+}
+
+/* only_blank_lines()
+ * ------------------
+ * Checks if the given line and the rest of the reader's input only contain
+ * 	whitespace.
+ *
+ * reader: a pointer to the reader.
+ * line: a pointer to the line most recently read from the reader.
+ *
+ * Returns: true if all remaining lines are blank, else returns false.
+ */
+static bool only_blank_lines(Reader* reader, Line* line) {
+    do {
+	trim_trailing_whitespace(line);
+	if (line->length > 0) {
+	    return false;
+	}
+    } while (read_next_line(reader, line));
+    return true;
+}
+
+/* compare_whitespace()
+ * --------------------
+ * Compares two inputs line by line, ignoring trailing whitespace on each
+ * 	line and trailing blank lines.
+ *
+ * actual: a pointer to the reader of the output under test.
+ * expected: a pointer to the reader of the expected output.
+ *
+ * Returns: COMPARE_SAME if they match, else COMPARE_DIFFERENT.
+ */
+static int compare_whitespace(Reader* actual, Reader* expected) {
+    Line actualLine = {malloc(INITIAL_LINE_SIZE), 0, INITIAL_LINE_SIZE};
+    Line expectedLine = {malloc(INITIAL_LINE_SIZE), 0, INITIAL_LINE_SIZE};
+    int result = COMPARE_SAME;
+    while (true) {
+	bool actualRead = read_next_line(actual, &actualLine);
+	bool expectedRead = read_next_line(expected, &expectedLine);
+	if (!actualRead || !expectedRead) {
+	    // Whichever input is left may only have blank lines.
+	    if ((actualRead && !only_blank_lines(actual, &actualLine)) ||
+		    (expectedRead &&
+		    !only_blank_lines(expected, &expectedLine))) {
+		result = COMPARE_DIFFERENT;
+	    }
+	    break;
+	}
+	trim_trailing_whitespace(&actualLine);
+	trim_trailing_whitespace(&expectedLine);
+	if (actualLine.length != expectedLine.length ||
+		memcmp(actualLine.text, expectedLine.text,
+		actualLine.length) != 0) {
+	    result = COMPARE_DIFFERENT;
+	    break;
+	}
+    }
+    free(actualLine.text);
+    free(expectedLine.text);
+    return result;
+}
+
+/* mix_hash()
+ * ----------
+ * Scrambles the bits of a hash (the splitmix64 finaliser), so that sums of
+ * 	hashes of similar lines do not cancel out.
+ *
+ * hash: the hash to scramble.
+ *
+ * Returns: the scrambled hash.
+ */
+static uint64_t mix_hash(uint64_t hash) {
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d1ce4e5b9ULL;
+    hash ^= hash >> 27;
+    hash *= 0x94d049bb133111ebULL;
+    hash ^= hash >> 31;
+    return hash;
+}
+
+/* summarise_lines()
+ * -----------------
+ * Reads all of an input and summarises its lines independently of their
+ * 	order. A last line without a newline counts as a full line.
+ *
+ * reader: a pointer to the reader.
+ * summary: a pointer to store the summary in.
+ *
+ * Returns: void
+ */
+static void summarise_lines(Reader* reader, LineMultiset* summary) {
+    uint64_t firstHash = FNV64_OFFSET;
+    uint64_t secondHash = POLY_SEED;
+    bool inLine = false;
+    summary->numLines = 0;
+    summary->firstSum = 0;
+    summary->secondSum = 0;
+
+    while (reader_fill(reader)) {
+	char* text = reader->buffer + reader->start;
+	size_t length = reader->end - reader->start;
+	for (size_t i = 0; i < length; i++) {
+	    unsigned char c = text[i];
+	    if (c == '\n') {
+		summary->numLines++;
+		summary->firstSum += mix_hash(firstHash);
+		summary->secondSum += mix_hash(secondHash);
+		firstHash = FNV64_OFFSET;
+		secondHash = POLY_SEED;
+		inLine = false;
+	    } else {
+		firstHash = (firstHash ^ c) * FNV64_PRIME;
+		secondHash = secondHash * POLY_BASE + c + 1;
+		inLine = true;
+	    }
+	}
+	reader->start = reader->end;
+    }
+    if (inLine) {
+	summary->numLines++;
+	summary->firstSum += mix_hash(firstHash);
+	summary->secondSum += mix_hash(secondHash);
+    }
+}
+
+/* compare_lines()
+ * ---------------
+ * Compares two inputs as multisets of lines, ignoring the order of lines.
+ *
+ * actual: a pointer to the reader of the output under test.
+ * expected: a pointer to the reader of the expected output.
+ *
+ * Returns: COMPARE_SAME if they have the same lines, else COMPARE_DIFFERENT.
+ */
+static int compare_lines(Reader* actual, Reader* expected) {
+    LineMultiset actualLines;
+    LineMultiset expectedLines;
+    summarise_lines(actual, &actualLines);
+    summarise_lines(expected, &expectedLines);
+    if (actualLines.numLines == expectedLines.numLines &&
+	    actualLines.firstSum == expectedLines.firstSum &&
+	    actualLines.secondSum == expectedLines.secondSum) {
+	return COMPARE_SAME;
+    }
+    return COMPARE_DIFFERENT;
+}
@@ -0,0 +1,28 @@
+/*
+ * compare
+ * Compares the output of the program under test, read from a pipe, against
+ * 	the expected output in a file.
+ */
+
+#ifndef COMPARE_H
+#define COMPARE_H
+
+#include <stdbool.h>
+
+// Ways of comparing output against the expected output
+enum CompareMode {
+    COMPARE_EXACT = 0,
+    COMPARE_WHITESPACE = 1,
+    COMPARE_LINES = 2
+};
+
+// Results of a comparison, matching the exit statuses of cmp
+#define COMPARE_SAME 0
+#define COMPARE_DIFFERENT 1
+#define COMPARE_TROUBLE 2
+
+bool parse_compare_mode(char* name, enum CompareMode* mode);
+const char* compare_mode_name(enum CompareMode mode);
+int compare_output(int fd, char* expectedPath, enum CompareMode mode);
+
+#endif
@@ -0,0 +1,612 @@
+/*
+ * coverageMap
+ * Lines of a program covered by each test, and the order in which to keep
+ * 	tests so that each adds as many lines as it can.
+ *
+ * The program is run with GCOV_PREFIX set to a data directory, so that its
+ * 	.gcda files are written there under their absolute paths instead of
+ * 	next to the objects. After each test, gcov reads each of them along
+ * 	with the .gcno file at the original path, and prints the line counts
+ * 	to a pipe in its JSON format, which unlike its text format does not
+ * 	need the sources. The .gcda files are then removed for the next test.
+ *
+ * Tests are ordered greedily, each covering the most lines not covered by
+ * 	those before it. The number of new lines a test covers only falls as
+ * 	others are kept, so a test's last count is an upper bound, and only
+ * 	the test with the highest bound needs to be counted again each time.
+ */
+
+#include "coverageMap.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/stat.h>
+
+// Extensions of the coverage data and notes files
+#define DATA_EXTENSION ".gcda"
+#define NOTES_EXTENSION ".gcno"
+
+// Roles of the JSON values gcov prints that hold line counts: the top
+// object, with "files" and "current_working_directory", each object of
+// "files", with "file" and "lines", and each object of "lines", with
+// "line_number" and "count"
+typedef enum {
+    GCOV_TOP,
+    GCOV_FILES,
+    GCOV_FILE,
+    GCOV_LINES,
+    GCOV_LINE,
+    GCOV_OTHER
+} GcovValue;
+
+// Lines run as read from gcov, each the number of its source file in the
+// output and its line number, kept until the output is read since the
+// names of the files and the directory they are relative to may come after
+// their lines
+typedef struct {
+    char* directory;
+    char** sources;
+    int numSources;
+    int sourcesSize;
+    int* lineSources;
+    long* lineNumbers;
+    int numLines;
+    int linesSize;
+    long lineNumber;
+    double count;
+    bool counted;
+} GcovLines;
+
+// Initial sizes of the hash table and of the arrays of lines
+#define INITIAL_TABLE_SIZE 1024
+#define INITIAL_LINES_SIZE 256
+
+/* Function prototypes */
+static int walk_data(CoverageMap* map, int testNum, char* dir,
+	size_t prefixLength);
+static bool read_gcov(CoverageMap* map, int testNum, char* dataPath,
+	size_t prefixLength);
+static char* parse_gcov_value(char* text, GcovValue role, GcovLines* lines);
+static char* parse_gcov_object(char* text, GcovValue role, GcovLines* lines);
+static char* parse_gcov_array(char* text, GcovValue role, GcovLines* lines);
+static char* parse_gcov_string(char* text, char** value);
+static char* skip_space(char* text);
+static void add_gcov_lines(CoverageMap* map, int testNum, GcovLines* lines);
+static void add_line(CoverageMap* map, int testNum, char* key);
+static int find_line(CoverageMap* map, char* key);
+
+/* coverage_start()
+ * ----------------
+ * Starts an empty map of the lines covered by each test.
+ *
+ * map: a pointer to the struct to store the map in.
+ * numOfTests: the number of tests.
+ *
+ * Returns: void
+ */
+void coverage_start(CoverageMap* map, int numOfTests) {
+    map->numOfTests = numOfTests;
+    map->testLines = calloc(numOfTests, sizeof(int*));
+    map->numTestLines = calloc(numOfTests, sizeof(int));
+    map->testLinesSize = calloc(numOfTests, sizeof(int));
+    map->numLines = 0;
+    map->linesSize = INITIAL_LINES_SIZE;
+    map->lineKeys = malloc(sizeof(char*) * map->linesSize);
+    map->lastTest = malloc(sizeof(int) * map->linesSize);
+    string_table_start(&map->table, INITIAL_TABLE_SIZE / 2);
+}
+
+/* coverage_discard()
+ * ------------------
+ * Removes coverage data left in a data directory by an earlier run.
+ *
+ * dataDir: a pointer to the array with the path of the data directory.
+ *
+ * Returns: void
+ */
+void coverage_discard(char* dataDir) {
+    walk_data(NULL, -1, dataDir, strlen(dataDir));
+}
+
+/* coverage_collect()
+ * ------------------
+ * Adds the lines covered by a test, which has just run with its coverage
+ * 	data written to a data directory, and removes the data.
+ *
+ * map: a pointer to the struct of the map.
+ * testNum: the 'n'th test that was run.
+ * dataDir: a pointer to the array with the path of the data directory.
+ *
+ * Returns: true if gcov read any coverage data, else returns false.
+ */
+bool coverage_collect(CoverageMap* map, int testNum, char* dataDir) {
+    return walk_data(map, testNum, dataDir, strlen(dataDir)) > 0;
+}
+
+/* coverage_order()
+ * ----------------
+ * Orders the fewest tests that cover every line covered by any test, each
+ * 	covering the most lines not covered by those before it.
+ *
+ * map: a pointer to the struct of the map.
+ * order: a pointer to an array of numOfTests ints to store the tests in.
+ * gains: a pointer to an array of numOfTests ints to store the number of
+ * 	new lines each test covers in.
+ *
+ * Returns: the number of tests kept.
+ */
+int coverage_order(CoverageMap* map, int* order, int* gains) {
+    bool* covered = calloc(map->numLines, sizeof(bool));
+    int* bounds = malloc(sizeof(int) * map->numOfTests);
+    memcpy(bounds, map->numTestLines, sizeof(int) * map->numOfTests);
+    int numKept = 0;
+    while (true) {
+	int best = -1;
+	for (int test = 0; test < map->numOfTests; test++) {
+	    if (bounds[test] > 0 &&
+		    (best == -1 || bounds[test] > bounds[best])) {
+		best = test;
+	    }
+	}
+	if (best == -1) {
+	    break;
+	}
+	int gain = 0;
+	for (int i = 0; i < map->numTestLines[best]; i++) {
+	    gain += !covered[map->testLines[best][i]];
+	}
+	// A test still covering as many new lines as its bound covers at
+	// least as many as any other test.
+	if (gain < bounds[best]) {
+	    bounds[best] = gain;
+	    continue;
+	}
+	for (int i = 0; i < map->numTestLines[best]; i++) {
+	    covered[map->testLines[best][i]] = true;
+	}
+	order[numKept] = best;
+	gains[numKept++] = gain;
+	bounds[best] = 0;
+    }
+    free(covered);
+    free(bounds);
+    return numKept;
+}
+
+/* coverage_free()
+ * ---------------
+ * Frees the memory of a map.
+ *
+ * map: a pointer to the struct of the map.
+ *
+ * Returns: void
+ */
+void coverage_free(CoverageMap* map) {
+    for (int test = 0; test < map->numOfTests; test++) {
+	free(map->testLines[test]);
+    }
+    for (int i = 0; i < map->numLines; i++) {
+	free(map->lineKeys[i]);
+    }
+    free(map->testLines);
+    free(map->numTestLines);
+    free(map->testLinesSize);
+    free(map->lineKeys);
+    free(map->lastTest);
+    string_table_free(&map->table);
+}
+
+/* walk_data()
+ * -----------
+ * Reads and removes each coverage data file in a directory and those below
+ * 	it.
+ *
+ * map: a pointer to the struct of the map, or NULL to only remove them.
+ * testNum: the 'n'th test the data is from.
+ * dir: a pointer to the array with the path of the directory.
+ * prefixLength: the length of the path of the data directory, which is
+ * 	followed by the original path of each file.
+ *
+ * Returns: the number of data files that gcov read.
+ */
+static int walk_data(CoverageMap* map, int testNum, char* dir,
+	size_t prefixLength) {
+    DIR* stream = opendir(dir);
+    if (stream == NULL) {
+	return 0;
+    }
+    int numRead = 0;
+    struct dirent* entry;
+    while ((entry = readdir(stream)) != NULL) {
+	if (strcmp(entry->d_name, ".") == 0 ||
+		strcmp(entry->d_name, "..") == 0) {
+	    continue;
+	}
+	char path[PATH_MAX];
+	snprintf(path, PATH_MAX, "%s/%s", dir, entry->d_name);
+	size_t length = strlen(path);
+	size_t extLength = strlen(DATA_EXTENSION);
+	struct stat fileStat;
+	if (lstat(path, &fileStat) == -1) {
+	    continue;
+	}
+	if (S_ISDIR(fileStat.st_mode)) {
+	    numRead += walk_data(map, testNum, path, prefixLength);
+	} else if (length > extLength &&
+		strcmp(path + length - extLength, DATA_EXTENSION) == 0) {
+	    numRead += map != NULL &&
+		    read_gcov(map, testNum, path, prefixLength);
+	    unlink(path);
+	}
+    }
+    closedir(stream);
+    return numRead;
+}
+
+/* read_gcov()
+ * -----------
+ * Runs gcov on a coverage data file, with a link to its notes file beside
+ * 	it, and adds the lines it reports as run to those of a test.
+ *
+ * map: a pointer to the struct of the map.
+ * testNum: the 'n'th test the data is from.
+ * dataPath: a pointer to the array with the path of the data file, which is
+ * 	the data directory followed by the original path.
+ * prefixLength: the length of the path of the data directory.
+ *
+ * Returns: true if gcov reported the count of any line, else returns false.
+ */
+static bool read_gcov(CoverageMap* map, int testNum, char* dataPath,
+	size_t prefixLength) {
+    char* originalPath = dataPath + prefixLength;
+    char notesPath[PATH_MAX];
+    char linkPath[PATH_MAX];
+    char dir[PATH_MAX];
+    size_t stemLength = strlen(originalPath) - strlen(DATA_EXTENSION);
+    snprintf(notesPath, PATH_MAX, "%.*s%s", (int)stemLength, originalPath,
+	    NOTES_EXTENSION);
+    stemLength = strlen(dataPath) - strlen(DATA_EXTENSION);
+    snprintf(linkPath, PATH_MAX, "%.*s%s", (int)stemLength, dataPath,
+	    NOTES_EXTENSION);
+    snprintf(dir, PATH_MAX, "%.*s", (int)(strrchr(dataPath, '/') - dataPath),
+	    dataPath);
+    unlink(linkPath);
+    symlink(notesPath, linkPath);
+
+    int countsPipe[2];
+    pipe(countsPipe);
+    pid_t pid = fork();
+    if (pid == 0) {
+	int null = open("/dev/null", O_WRONLY);
+	dup2(countsPipe[1], STDOUT_FILENO);
+	dup2(null, STDERR_FILENO);
+	close(countsPipe[0]);
+	close(countsPipe[1]);
+	close(null);
+	execlp("gcov", "gcov", "--json-format", "--stdout", "-o", dir,
+		dataPath, NULL);
+	_exit(1);
+    }
+    close(countsPipe[1]);
+
+    // The output is read whole, as a single JSON object per data file.
+    FILE* counts = fdopen(countsPipe[0], "r");
+    char* text = NULL;
+    size_t size = 0;
+    GcovLines lines;
+    memset(&lines, 0, sizeof(lines));
+    bool found = false;
+    if (getdelim(&text, &size, '\0', counts) != -1 &&
+	    parse_gcov_value(skip_space(text), GCOV_TOP, &lines) != NULL) {
+	found = lines.counted;
+	add_gcov_lines(map, testNum, &lines);
+    }
+    for (int i = 0; i < lines.numSources; i++) {
+	free(lines.sources[i]);
+    }
+    free(lines.sources);
+    free(lines.lineSources);
+    free(lines.lineNumbers);
+    free(lines.directory);
+    free(text);
+    fclose(counts);
+    waitpid(pid, NULL, 0);
+    unlink(linkPath);
+    return found;
+}
+
+/* parse_gcov_value()
+ * ------------------
+ * Parses a JSON value printed by gcov, keeping the line counts it holds.
+ *
+ * text: a pointer to the first character of the value.
+ * role: what the value holds.
+ * lines: a pointer to the struct to keep the lines run in.
+ *
+ * Returns: a pointer to the character after the value, or NULL if it is not
+ * 	valid JSON.
+ */
+static char* parse_gcov_value(char* text, GcovValue role, GcovLines* lines) {
+    if (*text == '{') {
+	return parse_gcov_object(text, role, lines);
+    } else if (*text == '[') {
+	return parse_gcov_array(text, role, lines);
+    } else if (*text == '"') {
+	return parse_gcov_string(text, NULL);
+    }
+    // Numbers are only needed as the values of keys of a line, which are
+    // read by parse_gcov_object(), and true, false and null not at all.
+    char* end = text;
+    while (*end != '\0' && strchr(",]} \t\r\n", *end) == NULL) {
+	end++;
+    }
+    return end > text ? end : NULL;
+}
+
+/* parse_gcov_object()
+ * -------------------
+ * Parses a JSON object printed by gcov, keeping the name of a source file,
+ * 	the directory names are relative to, or the count of a line.
+ *
+ * text: a pointer to the opening brace of the object.
+ * role: what the object holds.
+ * lines: a pointer to the struct to keep the lines run in.
+ *
+ * Returns: a pointer to the character after the object, or NULL if it is not
+ * 	valid JSON.
+ */
+static char* parse_gcov_object(char* text, GcovValue role, GcovLines* lines) {
+    int source = lines->numSources;
+    if (role == GCOV_FILE) {
+	if (lines->numSources == lines->sourcesSize) {
+	    lines->sourcesSize = lines->sourcesSize > 0 ?
+		    lines->sourcesSize * 2 : INITIAL_LINES_SIZE;
+	    lines->sources = realloc(lines->sources,
+		    sizeof(char*) * lines->sourcesSize);
+	}
+	lines->sources[lines->numSources++] = NULL;
+    } else if (role == GCOV_LINE) {
+	lines->lineNumber = 0;
+	lines->count = -1;
+    }
+    text = skip_space(text + 1);
+    while (*text != '}') {
+	char* key = NULL;
+	text = parse_gcov_string(text, &key);
+	if (text == NULL || *(text = skip_space(text)) != ':') {
+	    free(key);
+	    return NULL;
+	}
+	text = skip_space(text + 1);
+	GcovValue childRole = GCOV_OTHER;
+	char** name = NULL;
+	if (role == GCOV_TOP && strcmp(key, "files") == 0) {
+	    childRole = GCOV_FILES;
+	} else if (role == GCOV_TOP &&
+		strcmp(key, "current_working_directory") == 0 &&
+		*text == '"') {
+	    free(lines->directory);
+	    name = &lines->directory;
+	} else if (role == GCOV_FILE && strcmp(key, "lines") == 0) {
+	    childRole = GCOV_LINES;
+	} else if (role == GCOV_FILE && strcmp(key, "file") == 0 &&
+		*text == '"') {
+	    name = &lines->sources[source];
+	} else if (role == GCOV_LINE && strcmp(key, "line_number") == 0) {
+	    lines->lineNumber = strtol(text, NULL, 10);
+	} else if (role == GCOV_LINE && strcmp(key, "count") == 0) {
+	    lines->count = strtod(text, NULL);
+	}
+	free(key);
+	text = name != NULL ? parse_gcov_string(text, name) :
+		parse_gcov_value(text, childRole, lines);
+	if (text == NULL) {
+	    return NULL;
+	}
+	text = skip_space(text);
+	if (*text == ',') {
+	    text = skip_space(text + 1);
+	} else if (*text != '}') {
+	    return NULL;
+	}
+    }
+
+    // A line is only kept once it has been run.
+    if (role == GCOV_LINE && lines->count >= 0 && lines->lineNumber > 0) {
+	lines->counted = true;
+	if (lines->count > 0 && lines->numSources > 0) {
+	    if (lines->numLines == lines->linesSize) {
+		lines->linesSize = lines->linesSize > 0 ?
+			lines->linesSize * 2 : INITIAL_LINES_SIZE;
+		lines->lineSources = realloc(lines->lineSources,
+			sizeof(int) * lines->linesSize);
+		lines->lineNumbers = realloc(lines->lineNumbers,
+			sizeof(long) * lines->linesSize);
+	    }
+	    lines->lineSources[lines->numLines] = lines->numSources - 1;
+	    lines->lineNumbers[lines->numLines++] = lines->lineNumber;
+	}
+    }
+    return text + 1;
+}
+
+/* parse_gcov_array()
+ * ------------------
+ * Parses a JSON array printed by gcov.
+ *
+ * text: a pointer to the opening bracket of the array.
+ * role: what the array holds.
+ * lines: a pointer to the struct to keep the lines run in.
+ *
+ * Returns: a pointer to the character after the array, or NULL if it is not
+ * 	valid JSON.
+ */
+static char* parse_gcov_array(char* text, GcovValue role, GcovLines* lines) {
+    GcovValue childRole = role == GCOV_FILES ? GCOV_FILE :
+	    role == GCOV_LINES ? GCOV_LINE : GCOV_OTHER;
+    text = skip_space(text + 1);
+    while (*text != ']') {
+	text = parse_gcov_value(text, childRole, lines);
+	if (text == NULL) {
+	    return NULL;
+	}
+	text = skip_space(text);
+	if (*text == ',') {
+	    text = skip_space(text + 1);
+	} else if (*text != ']') {
+	    return NULL;
+	}
+    }
+    return text + 1;
+}
+
+/* parse_gcov_string()
+ * -------------------
+ * Parses a JSON string printed by gcov. Escaped characters other than those
+ * 	in ASCII are kept as '?', which still tells the paths of sources
+ * 	apart.
+ *
+ * text: a pointer to the opening quote of the string.
+ * value: a pointer to store a copy of the string in, or NULL to skip it.
+ *
+ * Returns: a pointer to the character after the string, or NULL if it is not
+ * 	valid JSON.
+ */
+static char* parse_gcov_string(char* text, char** value) {
+    if (*text != '"') {
+	return NULL;
+    }
+    char* copy = value != NULL ? malloc(strlen(text)) : NULL;
+    size_t length = 0;
+    for (text++; *text != '"'; text++) {
+	char c = *text;
+	if (c == '\0') {
+	    free(copy);
+	    return NULL;
+	} else if (c == '\\') {
+	    c = *++text;
+	    if (c == 'u') {
+		char digits[5] = "";
+		strncat(digits, text + 1, 4);
+		if (strlen(digits) < 4) {
+		    free(copy);
+		    return NULL;
+		}
+		long code = strtol(digits, NULL, 16);
+		c = code > 0 && code < 0x80 ? (char)code : '?';
+		text += 4;
+	    } else if (c == 'n' || c == 't' || c == 'r' || c == 'b' ||
+		    c == 'f') {
+		c = strchr("n\nt\tr\rb\bf\f", c)[1];
+	    } else if (c == '\0') {
+		free(copy);
+		return NULL;
+	    }
+	}
+	if (copy != NULL) {
+	    copy[length++] = c;
+	}
+    }
+    if (value != NULL) {
+	copy[length] = '\0';
+	*value = copy;
+    }
+    return text + 1;
+}
+
+/* skip_space()
+ * ------------
+ * Returns a pointer to the first character of text that is not whitespace.
+ */
+static char* skip_space(char* text) {
+    while (isspace((unsigned char)*text)) {
+	text++;
+    }
+    return text;
+}
+
+/* add_gcov_lines()
+ * ----------------
+ * Adds the lines run as read from gcov to those covered by a test, with the
+ * 	names of sources relative to the directory gcov reported made
+ * 	absolute, so that sources of the same name in different directories
+ * 	are told apart.
+ *
+ * map: a pointer to the struct of the map.
+ * testNum: the 'n'th test that covered the lines.
+ * lines: a pointer to the struct with the lines run.
+ *
+ * Returns: void
+ */
+static void add_gcov_lines(CoverageMap* map, int testNum, GcovLines* lines) {
+    for (int i = 0; i < lines->numLines; i++) {
+	char* source = lines->sources[lines->lineSources[i]];
+	if (source == NULL) {
+	    continue;
+	}
+	bool relative = source[0] != '/' && lines->directory != NULL;
+	char key[PATH_MAX * 2 + 16];
+	snprintf(key, sizeof(key), "%s%s%s:%ld",
+		relative ? lines->directory : "", relative ? "/" : "", source,
+		lines->lineNumbers[i]);
+	add_line(map, testNum, key);
+    }
+}
+
+/* add_line()
+ * ----------
+ * Adds a line to those covered by a test, unless it already covers it.
+ *
+ * map: a pointer to the struct of the map.
+ * testNum: the 'n'th test that covered the line.
+ * key: a pointer to the array with the "source:line" of the line.
+ *
+ * Returns: void
+ */
+static void add_line(CoverageMap* map, int testNum, char* key) {
+    int line = find_line(map, key);
+    if (map->lastTest[line] == testNum) {
+	return;
+    }
+    map->lastTest[line] = testNum;
+    if (map->numTestLines[testNum] == map->testLinesSize[testNum]) {
+	map->testLinesSize[testNum] = map->testLinesSize[testNum] > 0 ?
+		map->testLinesSize[testNum] * 2 : INITIAL_LINES_SIZE;
+	map->testLines[testNum] = realloc(map->testLines[testNum],
+		sizeof(int) * map->testLinesSize[testNum]);
+    }
+    map->testLines[testNum][map->numTestLines[testNum]++] = line;
+}
+
+/* find_line()
+ * -----------
+ * Finds the number of a line in the map, adding it if it is not there yet.
+ *
+ * map: a pointer to the struct of the map.
+ * key: a pointer to the array with the "source:line" of the line.
+ *
+ * Returns: the number of the line.
+ */
+static int find_line(CoverageMap* map, char* key) {
+    int line = string_table_find(&map->table, key);
+    if (line != STRING_NOT_FOUND) {
+	return line;
+    }
+    if (map->numLines == map->linesSize) {
+	map->linesSize *= 2;
+	map->lineKeys = realloc(map->lineKeys,
+		sizeof(char*) * map->linesSize);
+	map->lastTest = realloc(map->lastTest, sizeof(int) * map->linesSize);
+    }
+    line = map->numLines++;
+    map->lineKeys[line] = strdup(key);
+    map->lastTest[line] = -1;
+    string_table_add(&map->table, map->lineKeys[line], line);
+    return line;
+}
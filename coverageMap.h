@@ -0,0 +1,34 @@
+/*
+ * coverageMap
+ * Lines of a program covered by each test, read with gcov from a build of
+ * 	the program with --coverage, and the order in which to keep tests so
+ * 	that each adds as many lines as it can.
+ */
+
+#ifndef COVERAGE_MAP_H
+#define COVERAGE_MAP_H
+
+#include <stdbool.h>
+#include "stringTable.h"
+
+// Covered lines of each test, and a hash table of the "source:line" of each
+// line covered by any test
+typedef struct {
+    int numOfTests;
+    int** testLines;
+    int* numTestLines;
+    int* testLinesSize;
+    char** lineKeys;
+    int* lastTest;
+    int numLines;
+    int linesSize;
+    StringTable table;
+} CoverageMap;
+
+void coverage_start(CoverageMap* map, int numOfTests);
+void coverage_discard(char* dataDir);
+bool coverage_collect(CoverageMap* map, int testNum, char* dataDir);
+int coverage_order(CoverageMap* map, int* order, int* gains);
+void coverage_free(CoverageMap* map);
+
+#endif
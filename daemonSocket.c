@@ -0,0 +1,233 @@
+/*
+ * daemonSocket
+ * The Unix domain socket between a testuqwordladder daemon and its clients.
+ *
+ * A request is the program and the selection pattern, each followed by a
+ * 	null character, with the client's stdout and stderr attached as
+ * 	SCM_RIGHTS ancillary data. An empty pattern selects every test.
+ *
+ * The socket is a SOCK_SEQPACKET one, which keeps the boundaries of
+ * 	messages, so that a request is received whole by a single recvmsg(),
+ * 	and never together with the interrupts the client sends after it.
+ */
+
+#include "daemonSocket.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// Number of connections waiting to be accepted by the daemon
+#define LISTEN_BACKLOG 64
+
+/* Function prototypes */
+static bool make_address(char* path, struct sockaddr_un* address);
+static void close_received_fds(struct cmsghdr* header);
+
+/* socket_listen()
+ * ---------------
+ * Creates the daemon's listening socket at a path. A socket file left by a
+ * 	daemon that is no longer running is replaced.
+ *
+ * path: a pointer to the array with the filepath of the socket.
+ *
+ * Returns: the file descriptor of the listening socket, or -1 if it could not
+ * 	be created or another daemon is using the path.
+ */
+int socket_listen(char* path) {
+    struct sockaddr_un address;
+    if (!make_address(path, &address)) {
+	return -1;
+    }
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+	return -1;
+    }
+    if (bind(fd, (struct sockaddr*) &address, sizeof(address)) == -1) {
+	int other = errno == EADDRINUSE ? socket_connect(path) : -1;
+	if (errno != ECONNREFUSED || other != -1 || unlink(path) == -1 ||
+		bind(fd, (struct sockaddr*) &address, sizeof(address)) == -1) {
+	    if (other != -1) {
+		close(other);
+	    }
+	    close(fd);
+	    return -1;
+	}
+    }
+    if (listen(fd, LISTEN_BACKLOG) == -1) {
+	close(fd);
+	return -1;
+    }
+    return fd;
+}
+
+/* socket_connect()
+ * ----------------
+ * Connects to a daemon's socket.
+ *
+ * path: a pointer to the array with the filepath of the socket.
+ *
+ * Returns: the file descriptor of the connection, or -1 if no daemon could
+ * 	be reached.
+ */
+int socket_connect(char* path) {
+    struct sockaddr_un address;
+    if (!make_address(path, &address)) {
+	errno = ENAMETOOLONG;
+	return -1;
+    }
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+	return -1;
+    }
+    if (connect(fd, (struct sockaddr*) &address, sizeof(address)) == -1) {
+	int error = errno;
+	close(fd);
+	errno = error;
+	return -1;
+    }
+    return fd;
+}
+
+/* socket_send_request()
+ * ---------------------
+ * Sends a request to a daemon, along with this process's stdout and stderr.
+ *
+ * fd: the file descriptor of the connection.
+ * program: a pointer to the array with the program to test.
+ * select: a pointer to the array with the pattern of tests to run, or NULL
+ * 	for every test.
+ *
+ * Returns: true if the request was sent, else returns false.
+ */
+bool socket_send_request(int fd, char* program, char* select) {
+    char buffer[REQUEST_BUFFER];
+    if (select == NULL) {
+	select = "";
+    }
+    size_t programLength = strlen(program) + 1;
+    size_t selectLength = strlen(select) + 1;
+    if (programLength + selectLength > REQUEST_BUFFER) {
+	return false;
+    }
+    memcpy(buffer, program, programLength);
+    memcpy(buffer + programLength, select, selectLength);
+
+    struct iovec data = {buffer, programLength + selectLength};
+    char control[CMSG_SPACE(sizeof(int) * REQUEST_FDS)];
+    memset(control, 0, sizeof(control));
+    struct msghdr message = {0};
+    message.msg_iov = &data;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    struct cmsghdr* header = CMSG_FIRSTHDR(&message);
+    header->cmsg_level = SOL_SOCKET;
+    header->cmsg_type = SCM_RIGHTS;
+    header->cmsg_len = CMSG_LEN(sizeof(int) * REQUEST_FDS);
+    int outputFds[REQUEST_FDS] = {STDOUT_FILENO, STDERR_FILENO};
+    memcpy(CMSG_DATA(header), outputFds, sizeof(outputFds));
+
+    ssize_t numSent;
+    while ((numSent = sendmsg(fd, &message, 0)) == -1 && errno == EINTR) {
+    }
+    return numSent == data.iov_len;
+}
+
+/* socket_receive_request()
+ * ------------------------
+ * Receives a request from a client.
+ *
+ * fd: the file descriptor of the connection.
+ * buffer: a pointer to an array of REQUEST_BUFFER bytes to receive the
+ * 	request into.
+ * program: a pointer to store a pointer to the program to test in.
+ * select: a pointer to store a pointer to the pattern of tests to run in,
+ * 	or NULL for every test.
+ * outputFds: a pointer to an array to store the client's stdout and stderr
+ * 	in.
+ *
+ * Returns: true if a complete request was received, else returns false,
+ * 	including for a request longer than the buffer.
+ */
+bool socket_receive_request(int fd, char* buffer, char** program,
+	char** select, int* outputFds) {
+    struct iovec data = {buffer, REQUEST_BUFFER};
+    char control[CMSG_SPACE(sizeof(int) * REQUEST_FDS)] = {0};
+    struct msghdr message = {0};
+    message.msg_iov = &data;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+
+    ssize_t numRead;
+    while ((numRead = recvmsg(fd, &message, MSG_CMSG_CLOEXEC)) == -1 &&
+	    errno == EINTR) {
+    }
+    // The control data is only filled in by a successful receive.
+    if (numRead <= 0) {
+	return false;
+    }
+    struct cmsghdr* header = CMSG_FIRSTHDR(&message);
+    if (header == NULL || header->cmsg_level != SOL_SOCKET ||
+	    header->cmsg_type != SCM_RIGHTS) {
+	return false;
+    }
+    if ((message.msg_flags & (MSG_CTRUNC | MSG_TRUNC)) ||
+	    header->cmsg_len != CMSG_LEN(sizeof(int) * REQUEST_FDS)) {
+	close_received_fds(header);
+	return false;
+    }
+    memcpy(outputFds, CMSG_DATA(header), sizeof(int) * REQUEST_FDS);
+
+    // The request must be the program and the pattern, each terminated.
+    char* programEnd = memchr(buffer, '\0', numRead);
+    if (programEnd == NULL || buffer[numRead - 1] != '\0' ||
+	    programEnd == buffer + numRead - 1) {
+	close(outputFds[0]);
+	close(outputFds[1]);
+	return false;
+    }
+    *program = buffer;
+    *select = programEnd[1] != '\0' ? programEnd + 1 : NULL;
+    return true;
+}
+
+/* close_received_fds()
+ * --------------------
+ * Closes the file descriptors a client sent with a request that is rejected,
+ * 	however many of them were received.
+ *
+ * header: a pointer to the SCM_RIGHTS control message of the request.
+ *
+ * Returns: void
+ */
+static void close_received_fds(struct cmsghdr* header) {
+    size_t numFds = (header->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+    for (size_t i = 0; i < numFds && i < REQUEST_FDS; i++) {
+	int fd;
+	memcpy(&fd, CMSG_DATA(header) + sizeof(int) * i, sizeof(int));
+	close(fd);
+    }
+}
+
+/* make_address()
+ * --------------
+ * Makes the address of a Unix domain socket at a path.
+ *
+ * path: a pointer to the array with the filepath of the socket.
+ * address: a pointer to the struct to store the address in.
+ *
+ * Returns: true if the path fits in an address, else returns false.
+ */
+static bool make_address(char* path, struct sockaddr_un* address) {
+    memset(address, 0, sizeof(*address));
+    address->sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address->sun_path)) {
+	return false;
+    }
+    strcpy(address->sun_path, path);
+    return true;
+}
@@ -0,0 +1,26 @@
+/*
+ * daemonSocket
+ * The Unix domain socket between a testuqwordladder daemon and its clients.
+ * 	A client sends one request with the program to test, which tests to
+ * 	select, and its own stdout and stderr, so that the daemon can write
+ * 	the results straight to them.
+ */
+
+#ifndef DAEMON_SOCKET_H
+#define DAEMON_SOCKET_H
+
+#include <stdbool.h>
+
+// Largest size of a request
+#define REQUEST_BUFFER 8192
+
+// Number of file descriptors sent with a request (stdout and stderr)
+#define REQUEST_FDS 2
+
+int socket_listen(char* path);
+int socket_connect(char* path);
+bool socket_send_request(int fd, char* program, char* select);
+bool socket_receive_request(int fd, char* buffer, char** program,
+	char** select, int* outputFds);
+
+#endif
@@ -0,0 +1,525 @@
+/*
+ * goldenIO
+ * Batched file operations on the expected output files in the test
+ * 	directory. Operations are submitted to io_uring in batches of up to
+ * 	RING_ENTRIES, so that thousands of opens, stats, reads and writes only
+ * 	cost a handful of system calls. Any operation that io_uring cannot
+ * 	complete is done with a plain system call instead.
+ */
+
+#include "goldenIO.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#include <linux/stat.h>
+
+// Number of submission queue entries, which is also the largest batch.
+#define RING_ENTRIES 256
+
+// Mode of created output files
+#define OUTPUT_FILE_MODE (S_IRUSR | S_IWUSR)
+
+// Result of an operation that has not been completed by io_uring.
+#define RESULT_PENDING INT_MIN
+
+// Nanoseconds between checks for completions once io_uring_enter fails
+#define RING_POLL_DELAY 1000000
+
+// Whether io_uring has been set up yet, and if it can be used.
+enum RingState {
+    RING_UNTRIED,
+    RING_READY,
+    RING_UNAVAILABLE
+};
+
+// Memory mapped submission and completion queues of an io_uring instance.
+typedef struct {
+    int fd;
+    unsigned* sqHead;
+    unsigned* sqTail;
+    unsigned* sqMask;
+    unsigned* sqArray;
+    unsigned* cqHead;
+    unsigned* cqTail;
+    unsigned* cqMask;
+    struct io_uring_sqe* sqes;
+    struct io_uring_cqe* cqes;
+    void* sqRing;
+    size_t sqRingSize;
+    void* cqRing;
+    size_t cqRingSize;
+    size_t sqesSize;
+    unsigned numPending;
+    pid_t owner;
+} Ring;
+
+/* Function prototypes */
+static bool ring_available(void);
+static bool ring_setup(void);
+static bool ring_probe(void);
+static struct io_uring_sqe* ring_get_sqe(int opcode, int userData);
+static void ring_submit(int* results);
+static void batch_close(int* fds, int numFds);
+
+static Ring ring;
+static enum RingState ringState = RING_UNTRIED;
+
+/* ring_available()
+ * ----------------
+ * Sets up io_uring the first time it is needed, and again in a forked child
+ * 	that uses it, as the child would otherwise share its parent's queues.
+ *
+ * Returns: true if io_uring can be used, else returns false.
+ */
+static bool ring_available(void) {
+    if (ringState == RING_READY && ring.owner != getpid()) {
+	gio_close();
+	ringState = RING_UNTRIED;
+    }
+    if (ringState == RING_UNTRIED) {
+	ringState = ring_setup() ? RING_READY : RING_UNAVAILABLE;
+    }
+    return ringState == RING_READY;
+}
+
+/* ring_setup()
+ * ------------
+ * Creates an io_uring instance and maps its queues into memory.
+ *
+ * Returns: true if io_uring was set up and supports every operation used
+ * 	here, else returns false.
+ */
+static bool ring_setup(void) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring.fd = syscall(__NR_io_uring_setup, RING_ENTRIES, &params);
+    if (ring.fd < 0) {
+	return false;
+    }
+
+    // Map the submission and completion rings, which share one mapping on
+    // newer kernels, and the submission queue entries.
+    ring.sqRingSize = params.sq_off.array + params.sq_entries *
+	    sizeof(unsigned);
+    ring.cqRingSize = params.cq_off.cqes + params.cq_entries *
+	    sizeof(struct io_uring_cqe);
+    bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMmap && ring.cqRingSize > ring.sqRingSize) {
+	ring.sqRingSize = ring.cqRingSize;
+    }
+    ring.sqRing = mmap(NULL, ring.sqRingSize, PROT_READ | PROT_WRITE,
+	    MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_SQ_RING);
+    ring.cqRing = ring.sqRing;
+    if (!singleMmap && ring.sqRing != MAP_FAILED) {
+	ring.cqRing = mmap(NULL, ring.cqRingSize, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_CQ_RING);
+    }
+    ring.sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring.sqes = mmap(NULL, ring.sqesSize, PROT_READ | PROT_WRITE,
+	    MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_SQES);
+    if (ring.sqRing == MAP_FAILED || ring.cqRing == MAP_FAILED ||
+	    ring.sqes == MAP_FAILED) {
+	gio_close();
+	return false;
+    }
+
+    char* sq = ring.sqRing;
+    char* cq = ring.cqRing;
+    ring.sqHead = (unsigned*) (sq + params.sq_off.head);
+    ring.sqTail = (unsigned*) (sq + params.sq_off.tail);
+    ring.sqMask = (unsigned*) (sq + params.sq_off.ring_mask);
+    ring.sqArray = (unsigned*) (sq + params.sq_off.array);
+    ring.cqHead = (unsigned*) (cq + params.cq_off.head);
+    ring.cqTail = (unsigned*) (cq + params.cq_off.tail);
+    ring.cqMask = (unsigned*) (cq + params.cq_off.ring_mask);
+    ring.cqes = (struct io_uring_cqe*) (cq + params.cq_off.cqes);
+    ring.numPending = 0;
+    ring.owner = getpid();
+
+    if (!ring_probe()) {
+	gio_close();
+	return false;
+    }
+    return true;
+}
+
+/* ring_probe()
+ * ------------
+ * Checks that the kernel supports every io_uring operation used here.
+ *
+ * Returns: true if all operations are supported, else returns false.
+ */
+static bool ring_probe(void) {
+    int opcodes[] = {IORING_OP_STATX, IORING_OP_OPENAT, IORING_OP_CLOSE,
+	    IORING_OP_READ, IORING_OP_WRITE, IORING_OP_UNLINKAT};
+    int numOps = IORING_OP_LAST;
+    struct io_uring_probe* probe = calloc(1, sizeof(struct io_uring_probe) +
+	    numOps * sizeof(struct io_uring_probe_op));
+    bool supported = syscall(__NR_io_uring_register, ring.fd,
+	    IORING_REGISTER_PROBE, probe, numOps) == 0;
+    for (int i = 0; supported && i < sizeof(opcodes) / sizeof(int); i++) {
+	supported = opcodes[i] <= probe->last_op &&
+		(probe->ops[opcodes[i]].flags & IO_URING_OP_SUPPORTED);
+    }
+    free(probe);
+    return supported;
+}
+
+/* ring_get_sqe()
+ * --------------
+ * Gets the next free submission queue entry. At most RING_ENTRIES entries
+ * 	can be taken before calling ring_submit().
+ *
+ * opcode: the io_uring operation of the entry.
+ * userData: the index to store the operation's result at.
+ *
+ * Returns: a pointer to the cleared entry.
+ */
+static struct io_uring_sqe* ring_get_sqe(int opcode, int userData) {
+    unsigned tail = *ring.sqTail + ring.numPending++;
+    unsigned index = tail & *ring.sqMask;
+    struct io_uring_sqe* sqe = &ring.sqes[index];
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+    sqe->opcode = opcode;
+    sqe->user_data = userData;
+    ring.sqArray[index] = index;
+    return sqe;
+}
+
+/* ring_submit()
+ * -------------
+ * Submits all pending entries and waits for them to complete. If
+ * 	io_uring_enter fails, io_uring is not used again, but the entries the
+ * 	kernel has consumed from the submission queue are still waited for,
+ * 	as they complete whatever happens next.
+ *
+ * results: a pointer to the array to store each operation's result in, at
+ * 	the index given by its user data. The result of an operation that
+ * 	the kernel never consumed is left unchanged.
+ *
+ * Returns: void
+ */
+static void ring_submit(int* results) {
+    unsigned numEntries = ring.numPending;
+    unsigned firstHead = __atomic_load_n(ring.sqHead, __ATOMIC_ACQUIRE);
+    unsigned numConsumed = 0;
+    unsigned numCompleted = 0;
+    bool failed = false;
+    __atomic_store_n(ring.sqTail, *ring.sqTail + numEntries,
+	    __ATOMIC_RELEASE);
+    ring.numPending = 0;
+
+    while (numCompleted < (failed ? numConsumed : numEntries)) {
+	int entered = syscall(__NR_io_uring_enter, ring.fd,
+		failed ? 0 : numEntries - numConsumed,
+		(failed ? numConsumed : numEntries) - numCompleted,
+		IORING_ENTER_GETEVENTS, NULL, 0);
+	if (entered < 0 && errno != EINTR && errno != EAGAIN &&
+		errno != EBUSY) {
+	    // Without io_uring_enter to wait in, the completion queue is
+	    // polled instead.
+	    if (failed) {
+		struct timespec delay = {0, RING_POLL_DELAY};
+		nanosleep(&delay, NULL);
+	    }
+	    failed = true;
+	}
+	numConsumed = __atomic_load_n(ring.sqHead, __ATOMIC_ACQUIRE) -
+		firstHead;
+
+	// Reap the completed entries.
+	unsigned head = *ring.cqHead;
+	unsigned tail = __atomic_load_n(ring.cqTail, __ATOMIC_ACQUIRE);
+	for (; head != tail; head++) {
+	    struct io_uring_cqe* cqe = &ring.cqes[head & *ring.cqMask];
+	    results[cqe->user_data] = cqe->res;
+	    numCompleted++;
+	}
+	__atomic_store_n(ring.cqHead, head, __ATOMIC_RELEASE);
+    }
+    if (failed) {
+	// Take back the entries the kernel never consumed, leaving their
+	// results pending, and stop using io_uring.
+	__atomic_store_n(ring.sqTail, firstHead + numConsumed,
+		__ATOMIC_RELEASE);
+	ringState = RING_UNAVAILABLE;
+    }
+}
+
+/* batch_close()
+ * -------------
+ * Closes the given file descriptors, ignoring any that are negative.
+ *
+ * fds: a pointer to the array of file descriptors.
+ * numFds: the number of file descriptors, at most RING_ENTRIES.
+ *
+ * Returns: void
+ */
+static void batch_close(int* fds, int numFds) {
+    int results[RING_ENTRIES];
+    for (int i = 0; i < numFds; i++) {
+	results[i] = RESULT_PENDING;
+	if (fds[i] >= 0 && ring_available()) {
+	    ring_get_sqe(IORING_OP_CLOSE, i)->fd = fds[i];
+	}
+    }
+    if (ring_available()) {
+	ring_submit(results);
+    }
+    for (int i = 0; i < numFds; i++) {
+	if (fds[i] >= 0 && results[i] == RESULT_PENDING) {
+	    close(fds[i]);
+	}
+    }
+}
+
+/* gio_stat_mtimes()
+ * -----------------
+ * Gets the last modification times of the given files.
+ *
+ * paths: a pointer to the array of filepaths.
+ * numPaths: the number of filepaths.
+ * mtimes: a pointer to the array to store each file's modification time in.
+ * exists: a pointer to the array to store whether each file exists in.
+ *
+ * Returns: void
+ */
+void gio_stat_mtimes(char** paths, int numPaths, struct timespec* mtimes,
+	bool* exists) {
+    for (int start = 0; start < numPaths; start += RING_ENTRIES) {
+	int batchSize = numPaths - start < RING_ENTRIES ?
+		numPaths - start : RING_ENTRIES;
+	int results[RING_ENTRIES];
+	struct statx stats[RING_ENTRIES];
+	for (int i = 0; i < batchSize; i++) {
+	    results[i] = RESULT_PENDING;
+	    if (ring_available()) {
+		struct io_uring_sqe* sqe = ring_get_sqe(IORING_OP_STATX, i);
+		sqe->fd = AT_FDCWD;
+		sqe->addr = (unsigned long) paths[start + i];
+		sqe->len = STATX_MTIME;
+		sqe->off = (unsigned long) &stats[i];
+	    }
+	}
+	if (ring_available()) {
+	    ring_submit(results);
+	}
+
+	for (int i = 0; i < batchSize; i++) {
+	    struct stat fileStat;
+	    if (results[i] == RESULT_PENDING) {
+		results[i] = stat(paths[start + i], &fileStat) ? -errno : 0;
+		if (results[i] == 0) {
+		    mtimes[start + i] = fileStat.st_mtim;
+		}
+	    } else {
+		mtimes[start + i].tv_sec = stats[i].stx_mtime.tv_sec;
+		mtimes[start + i].tv_nsec = stats[i].stx_mtime.tv_nsec;
+	    }
+	    exists[start + i] = results[i] == 0;
+	}
+    }
+}
+
+/* gio_create_files()
+ * ------------------
+ * Creates the given files, empty. Existing files are removed first, so that
+ * 	any hard links to them are kept intact.
+ *
+ * paths: a pointer to the array of filepaths.
+ * numPaths: the number of filepaths.
+ *
+ * Returns: the index of the first file that could not be created, or -1 if
+ * 	all files were created.
+ */
+int gio_create_files(char** paths, int numPaths) {
+    int failed = -1;
+    int batchEntries = RING_ENTRIES / 2;
+    for (int start = 0; start < numPaths; start += batchEntries) {
+	int batchSize = numPaths - start < batchEntries ?
+		numPaths - start : batchEntries;
+	int results[RING_ENTRIES];
+	for (int i = 0; i < batchSize; i++) {
+	    results[i] = RESULT_PENDING;
+	    results[batchEntries + i] = RESULT_PENDING;
+	    if (ring_available()) {
+		// The open runs after the unlink whether or not it succeeds.
+		struct io_uring_sqe* sqe = ring_get_sqe(IORING_OP_UNLINKAT,
+			batchEntries + i);
+		sqe->fd = AT_FDCWD;
+		sqe->addr = (unsigned long) paths[start + i];
+		sqe->flags = IOSQE_IO_HARDLINK;
+		sqe = ring_get_sqe(IORING_OP_OPENAT, i);
+		sqe->fd = AT_FDCWD;
+		sqe->addr = (unsigned long) paths[start + i];
+		sqe->len = OUTPUT_FILE_MODE;
+		sqe->open_flags = O_WRONLY | O_CREAT | O_TRUNC;
+	    }
+	}
+	if (ring_available()) {
+	    ring_submit(results);
+	}
+
+	for (int i = 0; i < batchSize; i++) {
+	    if (results[i] == RESULT_PENDING) {
+		if (results[batchEntries + i] == RESULT_PENDING) {
+		    unlink(paths[start + i]);
+		}
+		results[i] = open(paths[start + i],
+			O_WRONLY | O_CREAT | O_TRUNC, OUTPUT_FILE_MODE);
+	    }
+	    if (results[i] < 0 && failed == -1) {
+		failed = start + i;
+	    }
+	}
+	batch_close(results, batchSize);
+    }
+    return failed;
+}
+
+/* gio_write_files()
+ * -----------------
+ * Replaces the contents of the given existing files.
+ *
+ * paths: a pointer to the array of filepaths.
+ * contents: a pointer to the array of strings to write to each file.
+ * numPaths: the number of filepaths.
+ *
+ * Returns: void
+ */
+void gio_write_files(char** paths, char** contents, int numPaths) {
+    for (int start = 0; start < numPaths; start += RING_ENTRIES) {
+	int batchSize = numPaths - start < RING_ENTRIES ?
+		numPaths - start : RING_ENTRIES;
+	int fds[RING_ENTRIES];
+	int results[RING_ENTRIES];
+	for (int i = 0; i < batchSize; i++) {
+	    fds[i] = RESULT_PENDING;
+	    if (ring_available()) {
+		struct io_uring_sqe* sqe = ring_get_sqe(IORING_OP_OPENAT, i);
+		sqe->fd = AT_FDCWD;
+		sqe->addr = (unsigned long) paths[start + i];
+		sqe->open_flags = O_WRONLY | O_TRUNC;
+	    }
+	}
+	if (ring_available()) {
+	    ring_submit(fds);
+	}
+
+	for (int i = 0; i < batchSize; i++) {
+	    if (fds[i] == RESULT_PENDING) {
+		fds[i] = open(paths[start + i], O_WRONLY | O_TRUNC);
+	    }
+	    results[i] = RESULT_PENDING;
+	    if (fds[i] >= 0 && ring_available()) {
+		struct io_uring_sqe* sqe = ring_get_sqe(IORING_OP_WRITE, i);
+		sqe->fd = fds[i];
+		sqe->addr = (unsigned long) contents[start + i];
+		sqe->len = strlen(contents[start + i]);
+	    }
+	}
+	if (ring_available()) {
+	    ring_submit(results);
+	}
+
+	for (int i = 0; i < batchSize; i++) {
+	    if (fds[i] >= 0 && results[i] == RESULT_PENDING) {
+		write(fds[i], contents[start + i], strlen(contents[start + i]));
+	    }
+	}
+	batch_close(fds, batchSize);
+    }
+}
+
+/* gio_read_files()
+ * ----------------
+ * Reads the start of each of the given files into a buffer as a string.
+ *
+ * paths: a pointer to the array of filepaths.
+ * buffers: a pointer to numPaths consecutive buffers of bufferSize
+ * 	characters. The buffer of a file that cannot be read is left empty.
+ * bufferSize: the size of each buffer, including the null terminator.
+ * numPaths: the number of filepaths.
+ *
+ * Returns: void
+ */
+void gio_read_files(char** paths, char* buffers, int bufferSize,
+	int numPaths) {
+    for (int start = 0; start < numPaths; start += RING_ENTRIES) {
+	int batchSize = numPaths - start < RING_ENTRIES ?
+		numPaths - start : RING_ENTRIES;
+	int fds[RING_ENTRIES];
+	int results[RING_ENTRIES];
+	for (int i = 0; i < batchSize; i++) {
+	    fds[i] = RESULT_PENDING;
+	    if (ring_available()) {
+		struct io_uring_sqe* sqe = ring_get_sqe(IORING_OP_OPENAT, i);
+		sqe->fd = AT_FDCWD;
+		sqe->addr = (unsigned long) paths[start + i];
+		sqe->open_flags = O_RDONLY;
+	    }
+	}
+	if (ring_available()) {
+	    ring_submit(fds);
+	}
+
+	for (int i = 0; i < batchSize; i++) {
+	    if (fds[i] == RESULT_PENDING) {
+		fds[i] = open(paths[start + i], O_RDONLY);
+	    }
+	    results[i] = RESULT_PENDING;
+	    char* buffer = buffers + (long) (start + i) * bufferSize;
+	    if (fds[i] >= 0 && ring_available()) {
+		struct io_uring_sqe* sqe = ring_get_sqe(IORING_OP_READ, i);
+		sqe->fd = fds[i];
+		sqe->addr = (unsigned long) buffer;
+		sqe->len = bufferSize - 1;
+	    }
+	}
+	if (ring_available()) {
+	    ring_submit(results);
+	}
+
+	for (int i = 0; i < batchSize; i++) {
+	    char* buffer = buffers + (long) (start + i) * bufferSize;
+	    if (fds[i] >= 0 && results[i] == RESULT_PENDING) {
+		results[i] = read(fds[i], buffer, bufferSize - 1);
+	    }
+	    buffer[fds[i] >= 0 && results[i] > 0 ? results[i] : 0] = '\0';
+	}
+	batch_close(fds, batchSize);
+    }
+}
+
+/* gio_close()
+ * -----------
+ * Releases the io_uring instance, if one was set up.
+ *
+ * Returns: void
+ */
+void gio_close(void) {
+    if (ring.sqes != NULL && ring.sqes != MAP_FAILED) {
+	munmap(ring.sqes, ring.sqesSize);
+    }
+    if (ring.cqRing != NULL && ring.cqRing != MAP_FAILED &&
+	    ring.cqRing != ring.sqRing) {
+	munmap(ring.cqRing, ring.cqRingSize);
+    }
+    if (ring.sqRing != NULL && ring.sqRing != MAP_FAILED) {
+	munmap(ring.sqRing, ring.sqRingSize);
+    }
+    if (ringState == RING_READY || ring.sqRing != NULL) {
+	close(ring.fd);
+    }
+    memset(&ring, 0, sizeof(Ring));
+    ringState = RING_UNAVAILABLE;
+}
@@ -0,0 +1,22 @@
+/*
+ * goldenIO
+ * Batched file operations on the expected output files in the test
+ * 	directory. Uses io_uring when the kernel supports it, and plain
+ * 	system calls otherwise.
+ */
+
+#ifndef GOLDEN_IO_H
+#define GOLDEN_IO_H
+
+#include <stdbool.h>
+#include <time.h>
+
+void gio_stat_mtimes(char** paths, int numPaths, struct timespec* mtimes,
+	bool* exists);
+int gio_create_files(char** paths, int numPaths);
+void gio_write_files(char** paths, char** contents, int numPaths);
+void gio_read_files(char** paths, char* buffers, int bufferSize,
+	int numPaths);
+void gio_close(void);
+
+#endif
@@ -0,0 +1,198 @@
+/*
+ * jobSpecFile
+ * Reads a job specifications file into memory, mapping it where possible,
+ * 	and splits it into lines and tab separated fields in place, so that
+ * 	no memory is allocated for each line.
+ *
+ * A regular file ending in a newline is mapped privately, so that newlines
+ * 	and tabs can be replaced with null characters without changing the
+ * 	file. Any other file is read into a single buffer with room for a null
+ * 	character after the last line.
+ */
+
+#include "jobSpecFile.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Initial size of the buffer for a file that cannot be mapped
+#define INITIAL_FILE_BUFFER 4096
+
+/* Function prototypes */
+static bool map_file(int fd, JobSpecFile* file);
+static void read_file(int fd, JobSpecFile* file);
+static void count_lines(JobSpecFile* file);
+
+/* jobspec_open()
+ * --------------
+ * Opens a job specifications file and loads its contents.
+ *
+ * path: a pointer to the array with the filepath of the file.
+ * file: a pointer to the struct to store the contents in.
+ *
+ * Returns: true if the file was opened, else returns false. A file that
+ * 	opens but cannot be read is treated as empty.
+ */
+bool jobspec_open(char* path, JobSpecFile* file) {
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+	return false;
+    }
+    file->position = 0;
+    if (!map_file(fd, file)) {
+	read_file(fd, file);
+    }
+    close(fd);
+    count_lines(file);
+    return true;
+}
+
+/* jobspec_next_line()
+ * -------------------
+ * Gets the next line of the file, replacing its newline with a null
+ * 	character.
+ *
+ * file: a pointer to the struct of the file.
+ *
+ * Returns: a pointer to the line within the file's contents, or NULL if there
+ * 	are no more lines.
+ */
+char* jobspec_next_line(JobSpecFile* file) {
+    if (file->position >= file->length) {
+	return NULL;
+    }
+    char* line = file->text + file->position;
+    char* newline = memchr(line, '\n', file->length - file->position);
+    if (newline == NULL) {
+	// Only a buffered file can have a last line without a newline.
+	file->text[file->length] = '\0';
+	file->position = file->length;
+    } else {
+	*newline = '\0';
+	file->position = newline - file->text + 1;
+    }
+    return line;
+}
+
+/* jobspec_split_fields()
+ * ----------------------
+ * Splits a line into its tab separated fields, replacing each tab with a
+ * 	null character.
+ *
+ * line: a pointer to a line returned from jobspec_next_line().
+ * fields: a pointer to an array to store a pointer to each field in, with
+ * 	room for one more field than the number of tabs in the line.
+ *
+ * Returns: the number of fields in the line.
+ */
+int jobspec_split_fields(char* line, char** fields) {
+    int numFields = 0;
+    fields[numFields++] = line;
+    for (char* tab = strchr(line, '\t'); tab != NULL;
+	    tab = strchr(tab, '\t')) {
+	*tab++ = '\0';
+	fields[numFields++] = tab;
+    }
+    return numFields;
+}
+
+/* jobspec_close()
+ * ---------------
+ * Releases the contents of a job specifications file. Lines and fields from
+ * 	the file cannot be used afterwards.
+ *
+ * file: a pointer to the struct of the file.
+ *
+ * Returns: void
+ */
+void jobspec_close(JobSpecFile* file) {
+    if (file->mapped) {
+	munmap(file->text, file->length);
+    } else {
+	free(file->text);
+    }
+    file->text = NULL;
+}
+
+/* map_file()
+ * ----------
+ * Maps a regular file that ends in a newline into memory.
+ *
+ * fd: the file descriptor of the file.
+ * file: a pointer to the struct to store the contents in.
+ *
+ * Returns: true if the file was mapped, else returns false.
+ */
+static bool map_file(int fd, JobSpecFile* file) {
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) == -1 || !S_ISREG(fileStat.st_mode) ||
+	    fileStat.st_size == 0) {
+	return false;
+    }
+    char* text = mmap(NULL, fileStat.st_size, PROT_READ | PROT_WRITE,
+	    MAP_PRIVATE, fd, 0);
+    if (text == MAP_FAILED) {
+	return false;
+    }
+    if (text[fileStat.st_size - 1] != '\n') {
+	munmap(text, fileStat.st_size);
+	return false;
+    }
+    madvise(text, fileStat.st_size, MADV_SEQUENTIAL);
+    file->text = text;
+    file->length = fileStat.st_size;
+    file->mapped = true;
+    return true;
+}
+
+/* read_file()
+ * -----------
+ * Reads all of a file into a buffer, leaving room for a null character at
+ * 	the end.
+ *
+ * fd: the file descriptor of the file.
+ * file: a pointer to the struct to store the contents in.
+ *
+ * Returns: void
+ */
+static void read_file(int fd, JobSpecFile* file) {
+    size_t size = INITIAL_FILE_BUFFER;
+    file->text = malloc(size);
+    file->length = 0;
+    file->mapped = false;
+    while (true) {
+	if (file->length + 1 == size) {
+	    size *= 2;
+	    file->text = realloc(file->text, size);
+	}
+	ssize_t numRead = read(fd, file->text + file->length,
+		size - file->length - 1);
+	if (numRead > 0) {
+	    file->length += numRead;
+	} else if (numRead == 0 || errno != EINTR) {
+	    break;
+	}
+    }
+}
+
+/* count_lines()
+ * -------------
+ * Counts the lines and tabs in a file, which bound the number of tests and
+ * 	fields in it.
+ *
+ * file: a pointer to the struct of the file.
+ *
+ * Returns: void
+ */
+static void count_lines(JobSpecFile* file) {
+    file->numLines = 1;
+    file->numTabs = 0;
+    for (size_t i = 0; i < file->length; i++) {
+	file->numLines += file->text[i] == '\n';
+	file->numTabs += file->text[i] == '\t';
+    }
+}
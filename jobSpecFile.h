@@ -0,0 +1,29 @@
+/*
+ * jobSpecFile
+ * Reads a job specifications file into memory, mapping it where possible,
+ * 	and splits it into lines and tab separated fields in place, so that
+ * 	no memory is allocated for each line.
+ */
+
+#ifndef JOB_SPEC_FILE_H
+#define JOB_SPEC_FILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Contents of a job specifications file, and the position of the next line
+typedef struct {
+    char* text;
+    size_t length;
+    size_t position;
+    bool mapped;
+    int numLines;
+    int numTabs;
+} JobSpecFile;
+
+bool jobspec_open(char* path, JobSpecFile* file);
+char* jobspec_next_line(JobSpecFile* file);
+int jobspec_split_fields(char* line, char** fields);
+void jobspec_close(JobSpecFile* file);
+
+#endif
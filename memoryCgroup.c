@@ -0,0 +1,290 @@
+/*
+ * memoryCgroup
+ * Memory limits of a program under test enforced by a cgroup v2 of its own.
+ *
+ * The cgroups are created below the cgroup this process is in, which needs
+ * 	the memory controller enabled for its children. That is only allowed
+ * 	when this process may write to its cgroup, and the cgroup is the root
+ * 	or has the controller enabled already, as in a container or a
+ * 	delegated systemd unit. Otherwise cgroup_setup() reports them
+ * 	unavailable, and the caller falls back to setrlimit().
+ *
+ * Each run gets a cgroup whose memory.max is the limit, without swap, and
+ * 	which is killed as a whole when any of its processes is killed for
+ * 	going over it. The child process joins the cgroup before calling
+ * 	exec, so memory used by this process before the fork is not counted.
+ */
+
+#include "memoryCgroup.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <time.h>
+#include <limits.h>
+
+// Tries at removing a cgroup whose processes are still exiting, a
+// millisecond apart
+#define REMOVE_TRIES 100
+#define REMOVE_DELAY 1000000
+
+// Size of the buffer for reading a file of a cgroup
+#define FILE_BUFFER 4096
+
+/* Function prototypes */
+static bool find_own_cgroup(char* path, size_t size);
+static bool read_cgroup_file(int dirFd, char* name, char* buffer,
+	size_t size);
+static bool write_cgroup_file(int dirFd, char* name, char* text);
+static bool has_word(char* text, char* word);
+
+// Directory of the cgroup this process is in, or -1 if cgroups cannot be
+// used, and the number of cgroups created so far
+static int baseFd = -1;
+static int numCreated = 0;
+
+/* cgroup_setup()
+ * --------------
+ * Finds the cgroup v2 this process is in, and enables the memory controller
+ * 	for the cgroups to be created below it.
+ *
+ * Returns: true if cgroups with memory limits can be created, else returns
+ * 	false.
+ */
+bool cgroup_setup(void) {
+    char path[PATH_MAX];
+    if (!find_own_cgroup(path, sizeof(path))) {
+	return false;
+    }
+    baseFd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    char text[FILE_BUFFER];
+    if (baseFd != -1 &&
+	    read_cgroup_file(baseFd, "cgroup.subtree_control", text,
+	    sizeof(text)) && has_word(text, "memory")) {
+	return true;
+    }
+    if (baseFd != -1 &&
+	    read_cgroup_file(baseFd, "cgroup.controllers", text,
+	    sizeof(text)) && has_word(text, "memory") &&
+	    write_cgroup_file(baseFd, "cgroup.subtree_control", "+memory")) {
+	return true;
+    }
+    if (baseFd != -1) {
+	close(baseFd);
+	baseFd = -1;
+    }
+    return false;
+}
+
+/* cgroup_create()
+ * ---------------
+ * Creates a cgroup for one run of a program, limited to a number of bytes
+ * 	of memory and no swap.
+ *
+ * cgroup: a pointer to the struct to store the cgroup in, whose fd is -1 if
+ * 	it could not be created.
+ * maxBytes: the memory limit in bytes.
+ *
+ * Returns: void
+ */
+void cgroup_create(MemoryCgroup* cgroup, long long maxBytes) {
+    cgroup->fd = -1;
+    if (baseFd == -1) {
+	return;
+    }
+    snprintf(cgroup->name, CGROUP_NAME_BUFFER, "testuqwordladder.%d.%d",
+	    (int) getpid(), numCreated++);
+    if (mkdirat(baseFd, cgroup->name, 0755) == -1) {
+	return;
+    }
+    cgroup->fd = openat(baseFd, cgroup->name,
+	    O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (cgroup->fd == -1) {
+	unlinkat(baseFd, cgroup->name, AT_REMOVEDIR);
+	return;
+    }
+    char limit[CGROUP_NAME_BUFFER];
+    snprintf(limit, sizeof(limit), "%lld", maxBytes);
+    if (!write_cgroup_file(cgroup->fd, "memory.max", limit)) {
+	bool oomKilled;
+	long peakKb;
+	cgroup_finish(cgroup, &oomKilled, &peakKb);
+	return;
+    }
+    // Neither file exists on older kernels, which swap or kill only the
+    // process that went over instead.
+    write_cgroup_file(cgroup->fd, "memory.swap.max", "0");
+    write_cgroup_file(cgroup->fd, "memory.oom.group", "1");
+}
+
+/* cgroup_join()
+ * -------------
+ * Moves the calling process into a cgroup, which a child process does before
+ * 	calling exec.
+ *
+ * cgroup: a pointer to the struct of the cgroup.
+ *
+ * Returns: true if the process is in the cgroup, else returns false.
+ */
+bool cgroup_join(MemoryCgroup* cgroup) {
+    return cgroup->fd != -1 &&
+	    write_cgroup_file(cgroup->fd, "cgroup.procs", "0");
+}
+
+/* cgroup_finish()
+ * ---------------
+ * Reads whether a process in a cgroup was killed for going over its memory
+ * 	limit and the peak memory of the cgroup, once its processes have
+ * 	been reaped, and removes it. Any process left in it is killed first.
+ *
+ * cgroup: a pointer to the struct of the cgroup.
+ * oomKilled: a pointer to store whether a process was killed in.
+ * peakKb: a pointer to store the peak memory in kilobytes in, or
+ * 	CGROUP_UNAVAILABLE if it is not known.
+ *
+ * Returns: void
+ */
+void cgroup_finish(MemoryCgroup* cgroup, bool* oomKilled, long* peakKb) {
+    *oomKilled = false;
+    *peakKb = CGROUP_UNAVAILABLE;
+    if (cgroup->fd == -1) {
+	return;
+    }
+    char text[FILE_BUFFER];
+    if (read_cgroup_file(cgroup->fd, "memory.events", text, sizeof(text))) {
+	char* line = strstr(text, "oom_kill ");
+	*oomKilled = line != NULL && (line == text || line[-1] == '\n') &&
+		strtol(line + strlen("oom_kill "), NULL, 10) > 0;
+    }
+    if (read_cgroup_file(cgroup->fd, "memory.peak", text, sizeof(text))) {
+	*peakKb = strtoll(text, NULL, 10) / 1024;
+    }
+    for (int i = 0; i < REMOVE_TRIES; i++) {
+	if (unlinkat(baseFd, cgroup->name, AT_REMOVEDIR) == 0 ||
+		errno != EBUSY) {
+	    break;
+	}
+	write_cgroup_file(cgroup->fd, "cgroup.kill", "1");
+	struct timespec delay = {0, REMOVE_DELAY};
+	nanosleep(&delay, NULL);
+    }
+    close(cgroup->fd);
+    cgroup->fd = -1;
+}
+
+/* find_own_cgroup()
+ * -----------------
+ * Finds the directory of the cgroup v2 this process is in, from where the
+ * 	cgroup2 filesystem is mounted and the path of the cgroup in it.
+ *
+ * path: a pointer to the array to store the directory in.
+ * size: the size of the array.
+ *
+ * Returns: true if the directory was found, else returns false.
+ */
+static bool find_own_cgroup(char* path, size_t size) {
+    char line[PATH_MAX * 2];
+    char cgroupPath[PATH_MAX] = "";
+    FILE* cgroups = fopen("/proc/self/cgroup", "r");
+    while (cgroups != NULL && fgets(line, sizeof(line), cgroups) != NULL) {
+	if (strncmp(line, "0::", 3) == 0) {
+	    line[strcspn(line, "\n")] = '\0';
+	    snprintf(cgroupPath, sizeof(cgroupPath), "%s", line + 3);
+	}
+    }
+    if (cgroups != NULL) {
+	fclose(cgroups);
+    }
+
+    // Each line of mountinfo has the mount point as its fifth field, and
+    // the filesystem type after a lone "-".
+    char mountPoint[PATH_MAX] = "";
+    FILE* mounts = fopen("/proc/self/mountinfo", "r");
+    while (mounts != NULL && fgets(line, sizeof(line), mounts) != NULL) {
+	char* separator = strstr(line, " - cgroup2 ");
+	char point[PATH_MAX];
+	if (separator != NULL && mountPoint[0] == '\0' &&
+		sscanf(line, "%*s %*s %*s %*s %4095s", point) == 1) {
+	    snprintf(mountPoint, sizeof(mountPoint), "%s", point);
+	}
+    }
+    if (mounts != NULL) {
+	fclose(mounts);
+    }
+    if (cgroupPath[0] == '\0' || mountPoint[0] == '\0') {
+	return false;
+    }
+    return snprintf(path, size, "%s%s", mountPoint,
+	    strcmp(cgroupPath, "/") == 0 ? "" : cgroupPath) < (int) size;
+}
+
+/* read_cgroup_file()
+ * ------------------
+ * Reads a file of a cgroup as a string.
+ *
+ * dirFd: the open directory of the cgroup.
+ * name: the name of the file.
+ * buffer: a pointer to the array to store the contents in.
+ * size: the size of the array.
+ *
+ * Returns: true if the file was read, else returns false.
+ */
+static bool read_cgroup_file(int dirFd, char* name, char* buffer,
+	size_t size) {
+    int fd = openat(dirFd, name, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+	return false;
+    }
+    ssize_t length = read(fd, buffer, size - 1);
+    close(fd);
+    if (length < 0) {
+	return false;
+    }
+    buffer[length] = '\0';
+    return true;
+}
+
+/* write_cgroup_file()
+ * -------------------
+ * Writes a value to a file of a cgroup.
+ *
+ * dirFd: the open directory of the cgroup.
+ * name: the name of the file.
+ * text: the value to write.
+ *
+ * Returns: true if the value was written, else returns false.
+ */
+static bool write_cgroup_file(int dirFd, char* name, char* text) {
+    int fd = openat(dirFd, name, O_WRONLY | O_CLOEXEC);
+    if (fd == -1) {
+	return false;
+    }
+    bool written = write(fd, text, strlen(text)) == (ssize_t) strlen(text);
+    return close(fd) == 0 && written;
+}
+
+/* has_word()
+ * ----------
+ * Checks if a space-separated list, such as of controllers, has a word.
+ *
+ * text: the list.
+ * word: the word to look for.
+ *
+ * Returns: true if the list has the word, else returns false.
+ */
+static bool has_word(char* text, char* word) {
+    size_t length = strlen(word);
+    for (char* found = strstr(text, word); found != NULL;
+	    found = strstr(found + 1, word)) {
+	bool starts = found == text || found[-1] == ' ';
+	bool ends = found[length] == '\0' || found[length] == ' ' ||
+		found[length] == '\n';
+	if (starts && ends) {
+	    return true;
+	}
+    }
+    return false;
+}
@@ -0,0 +1,33 @@
+/*
+ * memoryCgroup
+ * Memory limits of a program under test enforced by a cgroup v2 of its own,
+ * 	whose memory.max is the limit. The kernel kills the program when it
+ * 	goes over the limit and counts the kill in memory.events, so a run
+ * 	over its limit is told apart from one that failed for other reasons,
+ * 	and memory.peak gives the peak memory of the program alone.
+ */
+
+#ifndef MEMORY_CGROUP_H
+#define MEMORY_CGROUP_H
+
+#include <stdbool.h>
+
+// Size of the buffer for the name of a cgroup
+#define CGROUP_NAME_BUFFER 64
+
+// Peak memory of a cgroup that could not be read
+#define CGROUP_UNAVAILABLE -1
+
+// A cgroup of one run of a program, whose directory is open as fd, or -1 if
+// it could not be created
+typedef struct {
+    int fd;
+    char name[CGROUP_NAME_BUFFER];
+} MemoryCgroup;
+
+bool cgroup_setup(void);
+void cgroup_create(MemoryCgroup* cgroup, long long maxBytes);
+bool cgroup_join(MemoryCgroup* cgroup);
+void cgroup_finish(MemoryCgroup* cgroup, bool* oomKilled, long* peakKb);
+
+#endif
@@ -0,0 +1,146 @@
+/*
+ * perfCounters
+ * Hardware performance counters of a program under test, read with
+ * 	perf_event_open().
+ *
+ * The counters are attached to a child process before it runs the program,
+ * 	and are enabled when it calls exec, so that only the program is
+ * 	counted, along with any processes it starts. Only user space is
+ * 	counted, which needs the least privilege. A counter the host does not
+ * 	have, as in most virtual machines and containers, reads as
+ * 	PERF_UNAVAILABLE.
+ */
+
+#include "perfCounters.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+/* Function prototypes */
+static int open_counter(unsigned long long config, pid_t pid, bool onExec);
+
+// Events and names of the counters
+static const unsigned long long counterEvents[PERF_NUM_COUNTERS] = {
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES
+};
+static const char* counterNames[PERF_NUM_COUNTERS] = {
+    "instructions",
+    "cycles",
+    "cache misses",
+    "branch misses"
+};
+
+/* perf_available()
+ * ----------------
+ * Checks whether this process may count instructions, which it cannot if
+ * 	the host has no hardware counters or perf_event_paranoid forbids it.
+ *
+ * Returns: true if the counters can be used, else returns false.
+ */
+bool perf_available(void) {
+    int fd = open_counter(PERF_COUNT_HW_INSTRUCTIONS, 0, false);
+    if (fd == -1) {
+	return false;
+    }
+    close(fd);
+    return true;
+}
+
+/* perf_attach()
+ * -------------
+ * Attaches the counters to a child process that has not yet called exec.
+ *
+ * counters: a pointer to the struct to store the counters in.
+ * pid: the pid of the child process.
+ *
+ * Returns: void. A counter that cannot be attached reads as unavailable.
+ */
+void perf_attach(PerfCounters* counters, pid_t pid) {
+    for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+	counters->fds[i] = pid > 0 ? open_counter(counterEvents[i], pid, true) :
+		-1;
+    }
+}
+
+/* perf_read()
+ * -----------
+ * Reads and closes the counters of a process that has finished.
+ *
+ * counters: a pointer to the struct of the counters.
+ * counts: a pointer to an array of PERF_NUM_COUNTERS counts to store them in.
+ *
+ * Returns: void
+ */
+void perf_read(PerfCounters* counters, long long* counts) {
+    for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+	counts[i] = PERF_UNAVAILABLE;
+	if (counters->fds[i] == -1) {
+	    continue;
+	}
+	long long count;
+	if (read(counters->fds[i], &count, sizeof(count)) == sizeof(count)) {
+	    counts[i] = count;
+	}
+	close(counters->fds[i]);
+	counters->fds[i] = -1;
+    }
+}
+
+/* perf_format_change()
+ * --------------------
+ * Describes how counts differ from reference counts, as a percentage of the
+ * 	reference for each counter, e.g. "instructions +1.2%, cycles -0.4%".
+ *
+ * buffer: a pointer to the array to store the description in.
+ * size: the size of the buffer.
+ * counts: a pointer to the array with the counts.
+ * reference: a pointer to the array with the reference counts.
+ *
+ * Returns: void
+ */
+void perf_format_change(char* buffer, size_t size, long long* counts,
+	long long* reference) {
+    size_t length = 0;
+    for (int i = 0; i < PERF_NUM_COUNTERS && length < size; i++) {
+	char* separator = i > 0 ? ", " : "";
+	if (counts[i] == PERF_UNAVAILABLE || reference[i] <= 0) {
+	    length += snprintf(buffer + length, size - length, "%s%s n/a",
+		    separator, counterNames[i]);
+	} else {
+	    length += snprintf(buffer + length, size - length, "%s%s %+.1f%%",
+		    separator, counterNames[i],
+		    100.0 * (counts[i] - reference[i]) / reference[i]);
+	}
+    }
+}
+
+/* open_counter()
+ * --------------
+ * Opens a hardware counter of user space events for a process.
+ *
+ * config: the hardware event to count.
+ * pid: the pid of the process, or 0 for this process.
+ * onExec: whether to start counting when the process calls exec, rather
+ * 	than never.
+ *
+ * Returns: the file descriptor of the counter, or -1 if it cannot be opened.
+ */
+static int open_counter(unsigned long long config, pid_t pid, bool onExec) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.enable_on_exec = onExec;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return syscall(SYS_perf_event_open, &attr, pid, -1, -1,
+	    PERF_FLAG_FD_CLOEXEC);
+}
@@ -0,0 +1,33 @@
+/*
+ * perfCounters
+ * Hardware performance counters of a program under test, read with
+ * 	perf_event_open(). The counts are far less noisy than wall-clock time
+ * 	on a shared host, so they can show small changes in the work a program
+ * 	does.
+ */
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+// Number of counters: instructions, cycles, cache misses and branch misses
+#define PERF_NUM_COUNTERS 4
+
+// Count of a counter that could not be read
+#define PERF_UNAVAILABLE -1
+
+// Counters attached to a process
+typedef struct {
+    int fds[PERF_NUM_COUNTERS];
+} PerfCounters;
+
+bool perf_available(void);
+void perf_attach(PerfCounters* counters, pid_t pid);
+void perf_read(PerfCounters* counters, long long* counts);
+void perf_format_change(char* buffer, size_t size, long long* counts,
+	long long* reference);
+
+#endif
@@ -0,0 +1,160 @@
+/*
+ * progressDisplay
+ * A status line for runs on a terminal, showing the tests completed out of
+ * 	the total, how many passed and failed, the current throughput, the
+ * 	number of workers, and an estimate of the time remaining.
+ *
+ * The line is redrawn in place at most every PROGRESS_INTERVAL seconds, with
+ * 	a single write each time, and cleared before any other output.
+ *
+ * The estimate scales the expected time of the remaining tests, which is the
+ * 	run time of good-uqwordladder recorded for them, by how long the tests
+ * 	done so far took compared to their expected time. Without expected
+ * 	times it assumes the remaining tests take as long as the average test
+ * 	so far. Tests are added to the total as they are loaded, so until
+ * 	the last of them are, the estimate only covers the tests loaded.
+ */
+
+#include "progressDisplay.h"
+#include <stdio.h>
+
+// Shortest time between redraws of the status line, in seconds
+#define PROGRESS_INTERVAL 0.25
+
+// Status line, and the sequence that returns to the start of the line and
+// erases it
+#define PROGRESS_MSG "%d/%d tests, %d passed, %d failed, %.1f tests/s, " \
+    "%d workers, ETA %d:%02d"
+#define PROGRESS_ERASE "\r\033[K"
+
+/* Function prototypes */
+static double seconds_between(struct timespec* from, struct timespec* to);
+static void draw(Progress* progress, struct timespec* now);
+
+/* progress_start()
+ * ----------------
+ * Starts the status line of a run.
+ *
+ * progress: a pointer to the struct to store the state of the line in.
+ * enabled: whether to show the line, which should only be on a terminal.
+ * numWorkers: the number of programs run at once for each test.
+ *
+ * Returns: void
+ */
+void progress_start(Progress* progress, bool enabled, int numWorkers) {
+    progress->enabled = enabled;
+    progress->drawn = false;
+    progress->numOfTests = 0;
+    progress->numWorkers = numWorkers;
+    progress->numPassed = 0;
+    progress->numFailed = 0;
+    progress->numAtLastDraw = 0;
+    progress->expectedDone = 0;
+    progress->expectedRemaining = 0;
+    clock_gettime(CLOCK_MONOTONIC, &progress->start);
+    progress->lastDraw = progress->start;
+}
+
+/* progress_add_tests()
+ * --------------------
+ * Adds tests that have been loaded to the total of the run.
+ *
+ * progress: a pointer to the struct of the status line.
+ * numOfTests: the number of tests to add.
+ * expectedTime: the expected run time of the tests, in seconds.
+ *
+ * Returns: void
+ */
+void progress_add_tests(Progress* progress, int numOfTests,
+	double expectedTime) {
+    progress->numOfTests += numOfTests;
+    progress->expectedRemaining += expectedTime;
+}
+
+/* progress_test_done()
+ * --------------------
+ * Counts a finished test, and redraws the status line if it has not been
+ * 	drawn for PROGRESS_INTERVAL seconds or all tests are done.
+ *
+ * progress: a pointer to the struct of the status line.
+ * passed: whether the test passed.
+ * expectedTime: the expected run time of the test, in seconds.
+ *
+ * Returns: void
+ */
+void progress_test_done(Progress* progress, bool passed,
+	double expectedTime) {
+    progress->numPassed += passed;
+    progress->numFailed += !passed;
+    progress->expectedDone += expectedTime;
+    progress->expectedRemaining -= expectedTime;
+    if (!progress->enabled) {
+	return;
+    }
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    int numDone = progress->numPassed + progress->numFailed;
+    if (seconds_between(&progress->lastDraw, &now) >= PROGRESS_INTERVAL ||
+	    numDone == progress->numOfTests) {
+	draw(progress, &now);
+    }
+}
+
+/* progress_clear()
+ * ----------------
+ * Erases the status line, so that other output can be printed in its place.
+ * 	It is drawn again after the next test.
+ *
+ * progress: a pointer to the struct of the status line.
+ *
+ * Returns: void
+ */
+void progress_clear(Progress* progress) {
+    if (progress->drawn) {
+	fputs(PROGRESS_ERASE, stdout);
+	progress->drawn = false;
+    }
+}
+
+/* seconds_between()
+ * -----------------
+ * Returns the number of seconds from one monotonic time to another.
+ */
+static double seconds_between(struct timespec* from, struct timespec* to) {
+    return to->tv_sec - from->tv_sec + (to->tv_nsec - from->tv_nsec) / 1e9;
+}
+
+/* draw()
+ * ------
+ * Draws the status line in place of the previous one.
+ *
+ * progress: a pointer to the struct of the status line.
+ * now: a pointer to the current monotonic time.
+ *
+ * Returns: void
+ */
+static void draw(Progress* progress, struct timespec* now) {
+    int numDone = progress->numPassed + progress->numFailed;
+    double elapsed = seconds_between(&progress->start, now);
+    double sinceDraw = seconds_between(&progress->lastDraw, now);
+    double rate = sinceDraw > 0 ?
+	    (numDone - progress->numAtLastDraw) / sinceDraw : 0;
+
+    double remaining = 0;
+    if (progress->expectedDone > 0 && progress->expectedRemaining > 0) {
+	remaining = progress->expectedRemaining * elapsed /
+		progress->expectedDone;
+    } else if (numDone > 0) {
+	remaining = elapsed / numDone * (progress->numOfTests - numDone);
+    }
+    int eta = remaining + 0.5;
+
+    fputs(PROGRESS_ERASE, stdout);
+    fprintf(stdout, PROGRESS_MSG, numDone, progress->numOfTests,
+	    progress->numPassed, progress->numFailed, rate,
+	    progress->numWorkers, eta / 60, eta % 60);
+    fflush(stdout);
+    progress->drawn = true;
+    progress->numAtLastDraw = numDone;
+    progress->lastDraw = *now;
+}
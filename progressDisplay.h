@@ -0,0 +1,36 @@
+/*
+ * progressDisplay
+ * A status line for runs on a terminal, showing the tests completed out of
+ * 	the total, how many passed and failed, the current throughput, the
+ * 	number of workers, and an estimate of the time remaining.
+ */
+
+#ifndef PROGRESS_DISPLAY_H
+#define PROGRESS_DISPLAY_H
+
+#include <stdbool.h>
+#include <time.h>
+
+// State of the status line of a run
+typedef struct {
+    bool enabled;
+    bool drawn;
+    int numOfTests;
+    int numWorkers;
+    int numPassed;
+    int numFailed;
+    int numAtLastDraw;
+    double expectedDone;
+    double expectedRemaining;
+    struct timespec start;
+    struct timespec lastDraw;
+} Progress;
+
+void progress_start(Progress* progress, bool enabled, int numWorkers);
+void progress_add_tests(Progress* progress, int numOfTests,
+	double expectedTime);
+void progress_test_done(Progress* progress, bool passed,
+	double expectedTime);
+void progress_clear(Progress* progress);
+
+#endif
@@ -0,0 +1,577 @@
+/*
+ * runHistory
+ * A file in the test directory with a record of every test run against
+ * 	every candidate program, and reports of how each test has changed
+ * 	over the runs.
+ *
+ * The file starts with HISTORY_MAGIC, followed by the records in the order
+ * 	they were written. A new file is written with its magic under a
+ * 	temporary name and then linked into place, so that no run appends
+ * 	records before the magic. Records are appended to a buffer and
+ * 	written with a single write to the end of the file when it fills or
+ * 	the run ends, so appending takes constant time, and runs writing at
+ * 	once only interleave whole buffers of records.
+ *
+ * A run is identified by the time it started, and a candidate program by
+ * 	the FNV-1a hash of its contents, so that a rebuilt program is told
+ * 	apart from the one before it.
+ *
+ * A report reads the file in one pass through a mapping of it, keeping a
+ * 	few totals for each test in a hash table. A record cut short by a run
+ * 	that was killed while writing is skipped a byte at a time until the
+ * 	next whole record, as the records after it may not be aligned. A
+ * 	test is failing since the first of the failed runs at the end of its
+ * 	history. It is slower since the first of the runs at the end of its
+ * 	history that took more than HISTORY_SLOWER_RATIO times the mean of its
+ * 	earlier runs that passed, once there are HISTORY_BASELINE_RUNS of
+ * 	them.
+ */
+
+#include "runHistory.h"
+#include "stringTable.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <fnmatch.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Start of a history file
+#define HISTORY_MAGIC "UQWLHIS1"
+#define HISTORY_MAGIC_LENGTH 8
+
+// Detecting tests that have become slower
+#define HISTORY_SLOWER_RATIO 1.5
+#define HISTORY_BASELINE_RUNS 3
+
+// Initial size of the hash table of tests in a report
+#define INITIAL_TABLE_SIZE 1024
+
+// Hash parameters (64-bit FNV-1a)
+#define FNV64_OFFSET 14695981039346656037ULL
+#define FNV64_PRIME 1099511628211ULL
+
+// Size of the buffer for reading a program to hash it, and of a time
+#define READ_BUFFER 65536
+#define TIME_BUFFER 32
+
+// Report of the history
+#define HISTORY_SUMMARY_MSG "testuqwordladder: %ld results of %d tests in " \
+    "%s\n"
+#define TREND_MSG "%s: %ld runs, last %.3f s against mean %.3f s " \
+    "(%+.1f%%), cpu %.3f s, peak rss %" PRId64 " KB\n"
+#define FAILING_MSG "%s: Failing since %s with program %016" PRIx64 "\n"
+#define SLOWER_MSG "%s: Slower since %s with program %016" PRIx64 \
+    ", %.3f s against %.3f s\n"
+#define SLOWEST_HEADER "testuqwordladder: Slowest tests by mean run time\n"
+#define SLOWEST_MSG "%s\t%.3f s over %ld runs\n"
+#define TIME_FORMAT "%Y-%m-%d %H:%M:%S"
+#define DAMAGED_MSG "testuqwordladder: Skipped %ld damaged records in %s\n"
+
+// Suffix of the temporary file a new history file is written as
+#define TEMP_SUFFIX ".XXXXXX"
+
+// Totals of the runs of a test so far in a report
+typedef struct {
+    char* testID;
+    bool selected;
+    long numRuns;
+    double totalTime;
+    double lastTime;
+    double lastCpuTime;
+    int64_t lastMaxRss;
+    double baselineTime;
+    long numBaselineRuns;
+    int64_t failingSince;
+    uint64_t failingProgram;
+    int64_t slowerSince;
+    uint64_t slowerProgram;
+    double slowerTime;
+} TestTrend;
+
+// Tests in a report, in the order they first appear, and a hash table of
+// their indexes
+typedef struct {
+    TestTrend* trends;
+    int numTrends;
+    int trendsSize;
+    StringTable index;
+} TrendTable;
+
+/* Function prototypes */
+static char* find_program(char* program, char* path, size_t size);
+static void create_history(char* path);
+static bool valid_record(HistoryRecord* record, char* data, size_t size);
+static void add_record(TrendTable* table, HistoryRecord* record,
+	char* testID, char* select);
+static TestTrend* find_trend(TrendTable* table, char* testID,
+	char* select);
+static uint64_t hash_bytes(uint64_t hash, const char* bytes, size_t length);
+static void print_trend(TestTrend* trend);
+static void format_time(char* buffer, int64_t time);
+static double mean_time(const TestTrend* trend);
+static int compare_mean_times(const void* first, const void* second);
+
+/* history_start()
+ * ---------------
+ * Starts the records of a run, which is identified by the current time.
+ *
+ * history: a pointer to the struct to store the records in.
+ * path: a pointer to the array with the path of the history file.
+ *
+ * Returns: void
+ */
+void history_start(History* history, char* path) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    history->path = strdup(path);
+    history->runStart = (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+    history->owner = getpid();
+    history->buffer = malloc(HISTORY_BUFFER);
+    history->used = 0;
+}
+
+/* history_program_hash()
+ * ----------------------
+ * Hashes the contents of a candidate program, found in PATH if its name has
+ * 	no '/' as execvp() does.
+ *
+ * program: a pointer to the array with the name of the program.
+ *
+ * Returns: the hash, or 0 if the program cannot be read.
+ */
+uint64_t history_program_hash(char* program) {
+    char path[PATH_MAX];
+    int fd = open(find_program(program, path, PATH_MAX), O_RDONLY);
+    if (fd == -1) {
+	return 0;
+    }
+    char* buffer = malloc(READ_BUFFER);
+    uint64_t hash = FNV64_OFFSET;
+    ssize_t numRead;
+    while ((numRead = read(fd, buffer, READ_BUFFER)) > 0) {
+	hash = hash_bytes(hash, buffer, numRead);
+    }
+    free(buffer);
+    close(fd);
+    return hash;
+}
+
+/* history_append()
+ * ----------------
+ * Adds a record of a test run against a candidate program, writing the
+ * 	records before it if the buffer is full.
+ *
+ * history: a pointer to the struct of the records of the run.
+ * testID: a pointer to the array with the ID of the test.
+ * verdict: the verdict of the test, HISTORY_PASS, HISTORY_FAIL,
+ * 	HISTORY_FLAKY or HISTORY_LIMIT.
+ * programHash: the hash of the candidate program.
+ * runTime: how long the program took, in seconds.
+ * cpuTime: the CPU time the program used, in seconds.
+ * maxRss: the peak resident set size of the program, in kilobytes.
+ *
+ * Returns: void
+ */
+void history_append(History* history, char* testID, int verdict,
+	uint64_t programHash, double runTime, double cpuTime, long maxRss) {
+    size_t idLength = strlen(testID);
+    idLength = idLength < HISTORY_MAX_ID ? idLength : HISTORY_MAX_ID;
+    // The ID is always followed by at least one null byte of padding.
+    size_t length = (sizeof(HistoryRecord) + idLength + 8) & ~(size_t)7;
+    if (history->used + length > HISTORY_BUFFER) {
+	history_flush(history);
+    }
+    HistoryRecord record;
+    record.length = length;
+    record.verdict = verdict;
+    record.runStart = history->runStart;
+    record.programHash = programHash;
+    record.runTime = runTime;
+    record.cpuTime = cpuTime;
+    record.maxRss = maxRss;
+    char* end = history->buffer + history->used;
+    memcpy(end, &record, sizeof(record));
+    memcpy(end + sizeof(record), testID, idLength);
+    memset(end + sizeof(record) + idLength, 0,
+	    length - sizeof(record) - idLength);
+    history->used += length;
+}
+
+/* history_flush()
+ * ---------------
+ * Writes the records in the buffer to the end of the history file, creating
+ * 	it if it does not exist. Only the process that started the run
+ * 	writes them.
+ *
+ * history: a pointer to the struct of the records of the run.
+ *
+ * Returns: true if the records were written, else returns false.
+ */
+bool history_flush(History* history) {
+    if (history->used == 0 || history->owner != getpid()) {
+	return true;
+    }
+    if (access(history->path, F_OK) == -1) {
+	create_history(history->path);
+    }
+    int fd = open(history->path, O_WRONLY | O_APPEND);
+    if (fd == -1) {
+	history->used = 0;
+	return false;
+    }
+    bool written = write(fd, history->buffer, history->used) ==
+	    (ssize_t)history->used;
+    close(fd);
+    history->used = 0;
+    return written;
+}
+
+/* history_report()
+ * ----------------
+ * Prints the trend of each test in a history file: its number of runs, the
+ * 	time of its last run against the mean of the runs before it, and its
+ * 	CPU time and peak memory, followed by when it started failing or
+ * 	became slower if it has. Then prints the slowest tests by their mean
+ * 	run time.
+ *
+ * path: a pointer to the array with the path of the history file.
+ * select: a pointer to the array with a shell wildcard pattern of the test
+ * 	IDs to report, or NULL to report all tests.
+ * numSlowest: the number of slowest tests to print.
+ *
+ * Returns: true if the file could be read, else returns false.
+ */
+bool history_report(char* path, char* select, int numSlowest) {
+    int fd = open(path, O_RDONLY);
+    struct stat fileStat;
+    if (fd == -1 || fstat(fd, &fileStat) == -1 ||
+	    fileStat.st_size < HISTORY_MAGIC_LENGTH) {
+	if (fd != -1) {
+	    close(fd);
+	}
+	return false;
+    }
+    size_t size = fileStat.st_size;
+    char* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED ||
+	    memcmp(data, HISTORY_MAGIC, HISTORY_MAGIC_LENGTH) != 0) {
+	if (data != MAP_FAILED) {
+	    munmap(data, size);
+	}
+	return false;
+    }
+
+    TrendTable table;
+    table.numTrends = 0;
+    table.trendsSize = INITIAL_TABLE_SIZE / 2;
+    table.trends = malloc(sizeof(TestTrend) * table.trendsSize);
+    string_table_start(&table.index, INITIAL_TABLE_SIZE / 2);
+
+    // The records after one cut short by a run that was killed while
+    // writing are found again by looking for a whole record at each byte.
+    long numRecords = 0;
+    long numDamaged = 0;
+    bool damaged = false;
+    size_t position = HISTORY_MAGIC_LENGTH;
+    while (position + sizeof(HistoryRecord) <= size) {
+	HistoryRecord record;
+	memcpy(&record, data + position, sizeof(record));
+	if (!valid_record(&record, data + position, size - position)) {
+	    numDamaged += !damaged;
+	    damaged = true;
+	    position++;
+	    continue;
+	}
+	damaged = false;
+	add_record(&table, &record, data + position + sizeof(record),
+		select);
+	position += record.length;
+	numRecords++;
+    }
+    numDamaged += !damaged && position < size;
+
+    int numSelected = 0;
+    for (int i = 0; i < table.numTrends; i++) {
+	numSelected += table.trends[i].selected;
+    }
+    fprintf(stdout, HISTORY_SUMMARY_MSG, numRecords, numSelected, path);
+    if (numDamaged > 0) {
+	fprintf(stdout, DAMAGED_MSG, numDamaged, path);
+    }
+    TestTrend** slowest = malloc(sizeof(TestTrend*) * (numSelected + 1));
+    int numSlowestFound = 0;
+    for (int i = 0; i < table.numTrends; i++) {
+	if (table.trends[i].selected) {
+	    print_trend(&table.trends[i]);
+	    slowest[numSlowestFound++] = &table.trends[i];
+	}
+    }
+    qsort(slowest, numSlowestFound, sizeof(TestTrend*), compare_mean_times);
+    if (numSlowestFound > 0) {
+	fprintf(stdout, SLOWEST_HEADER);
+    }
+    for (int i = 0; i < numSlowestFound && i < numSlowest; i++) {
+	fprintf(stdout, SLOWEST_MSG, slowest[i]->testID,
+		mean_time(slowest[i]), slowest[i]->numRuns);
+    }
+
+    free(slowest);
+    free(table.trends);
+    string_table_free(&table.index);
+    munmap(data, size);
+    return true;
+}
+
+/* find_program()
+ * --------------
+ * Finds the file that execvp() would run for a program name.
+ *
+ * program: a pointer to the array with the name of the program.
+ * path: a pointer to an array to store the path of the file in.
+ * size: the size of the array.
+ *
+ * Returns: a pointer to the path of the file, which is the name itself if it
+ * 	has a '/' or is not found in PATH.
+ */
+static char* find_program(char* program, char* path, size_t size) {
+    char* searchPath = getenv("PATH");
+    if (strchr(program, '/') != NULL || searchPath == NULL) {
+	return program;
+    }
+    for (char* dir = searchPath; ; dir++) {
+	size_t dirLength = strcspn(dir, ":");
+	snprintf(path, size, "%.*s/%s", (int)dirLength,
+		dirLength > 0 ? dir : ".", program);
+	if (access(path, X_OK) == 0) {
+	    return path;
+	}
+	dir += dirLength;
+	if (*dir == '\0') {
+	    return program;
+	}
+    }
+}
+
+/* create_history()
+ * ----------------
+ * Creates a history file with its magic, unless another run creates it
+ * 	first. The magic is written to a temporary file, which is then linked
+ * 	to the history file, so the file never exists without it.
+ *
+ * path: a pointer to the array with the path of the history file.
+ *
+ * Returns: void
+ */
+static void create_history(char* path) {
+    char tempPath[PATH_MAX];
+    if (snprintf(tempPath, PATH_MAX, "%s%s", path, TEMP_SUFFIX) >=
+	    PATH_MAX) {
+	return;
+    }
+    int fd = mkstemp(tempPath);
+    if (fd == -1) {
+	return;
+    }
+    bool written = write(fd, HISTORY_MAGIC, HISTORY_MAGIC_LENGTH) ==
+	    HISTORY_MAGIC_LENGTH;
+    if (close(fd) == 0 && written) {
+	link(tempPath, path);
+    }
+    unlink(tempPath);
+}
+
+/* valid_record()
+ * --------------
+ * Checks if the bytes at a position of a history file are a whole record:
+ * 	a length that fits, a known verdict, and a test ID followed by
+ * 	nothing but null bytes of padding.
+ *
+ * record: a pointer to a copy of the record's header.
+ * data: a pointer to the record in the file.
+ * size: the number of bytes from the record to the end of the file.
+ *
+ * Returns: true if the record is whole, else returns false.
+ */
+static bool valid_record(HistoryRecord* record, char* data, size_t size) {
+    if (record->length <= sizeof(HistoryRecord) || record->length % 8 != 0 ||
+	    record->length > size || record->length >
+	    sizeof(HistoryRecord) + HISTORY_MAX_ID + 8 ||
+	    record->verdict > HISTORY_LIMIT) {
+	return false;
+    }
+    char* testID = data + sizeof(HistoryRecord);
+    char* end = data + record->length;
+    char* padding = memchr(testID, '\0', end - testID);
+    if (padding == NULL || padding == testID) {
+	return false;
+    }
+    for (; padding < end; padding++) {
+	if (*padding != '\0') {
+	    return false;
+	}
+    }
+    return true;
+}
+
+/* add_record()
+ * ------------
+ * Adds a record to the totals of its test.
+ *
+ * table: a pointer to the struct of the tests in the report.
+ * record: a pointer to the record.
+ * testID: a pointer to the array with the ID of the test, which is null
+ * 	terminated in the file.
+ * select: a pointer to the array with the pattern of tests to report, or
+ * 	NULL.
+ *
+ * Returns: void
+ */
+static void add_record(TrendTable* table, HistoryRecord* record,
+	char* testID, char* select) {
+    TestTrend* trend = find_trend(table, testID, select);
+    if (!trend->selected) {
+	return;
+    }
+    trend->numRuns++;
+    trend->totalTime += record->runTime;
+    trend->lastTime = record->runTime;
+    trend->lastCpuTime = record->cpuTime;
+    trend->lastMaxRss = record->maxRss;
+
+    if (record->verdict == HISTORY_FAIL || record->verdict == HISTORY_LIMIT) {
+	if (trend->failingSince == 0) {
+	    trend->failingSince = record->runStart;
+	    trend->failingProgram = record->programHash;
+	}
+	return;
+    }
+    trend->failingSince = 0;
+    double baseline = trend->numBaselineRuns > 0 ?
+	    trend->baselineTime / trend->numBaselineRuns : 0;
+    if (trend->numBaselineRuns >= HISTORY_BASELINE_RUNS &&
+	    record->runTime > baseline * HISTORY_SLOWER_RATIO) {
+	if (trend->slowerSince == 0) {
+	    trend->slowerSince = record->runStart;
+	    trend->slowerProgram = record->programHash;
+	}
+	trend->slowerTime = record->runTime;
+    } else {
+	trend->slowerSince = 0;
+	trend->baselineTime += record->runTime;
+	trend->numBaselineRuns++;
+    }
+}
+
+/* find_trend()
+ * ------------
+ * Finds the totals of a test in a report, adding them if the test has not
+ * 	been seen yet.
+ *
+ * table: a pointer to the struct of the tests in the report.
+ * testID: a pointer to the array with the ID of the test.
+ * select: a pointer to the array with the pattern of tests to report, or
+ * 	NULL.
+ *
+ * Returns: a pointer to the totals of the test.
+ */
+static TestTrend* find_trend(TrendTable* table, char* testID,
+	char* select) {
+    int index = string_table_find(&table->index, testID);
+    if (index != STRING_NOT_FOUND) {
+	return &table->trends[index];
+    }
+    if (table->numTrends == table->trendsSize) {
+	table->trendsSize *= 2;
+	table->trends = realloc(table->trends,
+		sizeof(TestTrend) * table->trendsSize);
+    }
+    index = table->numTrends++;
+    string_table_add(&table->index, testID, index);
+    TestTrend* trend = &table->trends[index];
+    memset(trend, 0, sizeof(TestTrend));
+    trend->testID = testID;
+    trend->selected = select == NULL || fnmatch(select, testID, 0) == 0;
+    return trend;
+}
+
+/* hash_bytes()
+ * ------------
+ * Returns the FNV-1a hash of bytes, continuing from the hash of those
+ * 	before them.
+ */
+static uint64_t hash_bytes(uint64_t hash, const char* bytes, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+	hash ^= (unsigned char)bytes[i];
+	hash *= FNV64_PRIME;
+    }
+    return hash;
+}
+
+/* print_trend()
+ * -------------
+ * Prints the trend of a test, and when it started failing or became slower.
+ *
+ * trend: a pointer to the totals of the test.
+ *
+ * Returns: void
+ */
+static void print_trend(TestTrend* trend) {
+    double earlierMean = trend->numRuns > 1 ?
+	    (trend->totalTime - trend->lastTime) / (trend->numRuns - 1) :
+	    trend->lastTime;
+    double change = earlierMean > 0 ?
+	    100.0 * (trend->lastTime - earlierMean) / earlierMean : 0;
+    fprintf(stdout, TREND_MSG, trend->testID, trend->numRuns,
+	    trend->lastTime, earlierMean, change, trend->lastCpuTime,
+	    trend->lastMaxRss);
+    char since[TIME_BUFFER];
+    if (trend->failingSince != 0) {
+	format_time(since, trend->failingSince);
+	fprintf(stdout, FAILING_MSG, trend->testID, since,
+		trend->failingProgram);
+    }
+    if (trend->slowerSince != 0) {
+	format_time(since, trend->slowerSince);
+	fprintf(stdout, SLOWER_MSG, trend->testID, since,
+		trend->slowerProgram, trend->slowerTime,
+		trend->baselineTime / trend->numBaselineRuns);
+    }
+}
+
+/* format_time()
+ * -------------
+ * Formats the start of a run as a local date and time in a buffer of
+ * 	TIME_BUFFER bytes.
+ */
+static void format_time(char* buffer, int64_t time) {
+    time_t seconds = time / 1000000000;
+    struct tm local;
+    localtime_r(&seconds, &local);
+    strftime(buffer, TIME_BUFFER, TIME_FORMAT, &local);
+}
+
+/* mean_time()
+ * -----------
+ * Returns the mean run time of a test.
+ */
+static double mean_time(const TestTrend* trend) {
+    return trend->numRuns > 0 ? trend->totalTime / trend->numRuns : 0;
+}
+
+/* compare_mean_times()
+ * --------------------
+ * Orders pointers to the totals of tests by decreasing mean run time, for
+ * 	qsort().
+ */
+static int compare_mean_times(const void* first, const void* second) {
+    double firstMean = mean_time(*(TestTrend* const*)first);
+    double secondMean = mean_time(*(TestTrend* const*)second);
+    return (firstMean < secondMean) - (firstMean > secondMean);
+}
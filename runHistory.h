@@ -0,0 +1,55 @@
+/*
+ * runHistory
+ * A file in the test directory with a record of every test run against
+ * 	every candidate program, and reports of how each test has changed
+ * 	over the runs.
+ */
+
+#ifndef RUN_HISTORY_H
+#define RUN_HISTORY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+// Size of the buffer records are appended to before they are written
+#define HISTORY_BUFFER 65536
+
+// Largest length of a test ID stored in a record
+#define HISTORY_MAX_ID 4096
+
+// Verdicts stored in a record, as in the verdicts of a run
+#define HISTORY_PASS 0
+#define HISTORY_FAIL 1
+#define HISTORY_FLAKY 2
+#define HISTORY_LIMIT 3
+
+// A record of a test run against a candidate program, which is followed by
+// the test ID and padded to a multiple of 8 bytes
+typedef struct {
+    uint32_t length;
+    uint32_t verdict;
+    int64_t runStart;
+    uint64_t programHash;
+    double runTime;
+    double cpuTime;
+    int64_t maxRss;
+} HistoryRecord;
+
+// Records of the current run waiting to be written
+typedef struct {
+    char* path;
+    int64_t runStart;
+    pid_t owner;
+    char* buffer;
+    size_t used;
+} History;
+
+void history_start(History* history, char* path);
+uint64_t history_program_hash(char* program);
+void history_append(History* history, char* testID, int verdict,
+	uint64_t programHash, double runTime, double cpuTime, long maxRss);
+bool history_flush(History* history);
+bool history_report(char* path, char* select, int numSlowest);
+
+#endif
@@ -0,0 +1,137 @@
+/*
+ * stressStats
+ * Throughput and latency of a candidate program when several instances of
+ * 	the same test are run at once.
+ *
+ * Latencies are counted in buckets that grow geometrically from
+ * 	STRESS_MIN_LATENCY, eight for each doubling, so that percentiles over
+ * 	any number of runs take a fixed amount of memory and are accurate to
+ * 	within about 9%. A percentile is reported as the upper bound of the
+ * 	bucket it falls in.
+ */
+
+#include "stressStats.h"
+
+// Upper bound of the first bucket, in seconds, and growth of the bounds (the
+// eighth root of two)
+#define STRESS_MIN_LATENCY 0.00001
+#define STRESS_BUCKET_GROWTH 1.0905077326652577
+
+/* Function prototypes */
+static int find_bucket(double latency);
+static double bucket_bound(int bucket);
+
+/* stress_levels()
+ * ---------------
+ * Starts the levels of a stress run: one instance, each power of two up to
+ * 	the largest number of instances, and then that number.
+ *
+ * levels: a pointer to an array of STRESS_MAX_LEVELS structs to store them in.
+ * maxInstances: the largest number of instances to run at once.
+ *
+ * Returns: the number of levels.
+ */
+int stress_levels(StressLevel* levels, int maxInstances) {
+    int numLevels = 0;
+    for (int numInstances = 1; numLevels < STRESS_MAX_LEVELS;
+	    numInstances *= 2) {
+	StressLevel* level = &levels[numLevels++];
+	level->numInstances = numInstances < maxInstances ? numInstances :
+		maxInstances;
+	level->numRuns = 0;
+	level->numFailed = 0;
+	level->wallTime = 0;
+	for (int i = 0; i < STRESS_NUM_BUCKETS; i++) {
+	    level->buckets[i] = 0;
+	}
+	if (numInstances >= maxInstances) {
+	    break;
+	}
+    }
+    return numLevels;
+}
+
+/* stress_add()
+ * ------------
+ * Counts the instances of a test that were run at once.
+ *
+ * level: a pointer to the struct of the level they were run at.
+ * latencies: a pointer to an array with the run time of each instance, in
+ * 	seconds.
+ * numFailed: the number of instances that failed the test.
+ * wallTime: the time from starting the first instance to the last one
+ * 	finishing, in seconds.
+ *
+ * Returns: void
+ */
+void stress_add(StressLevel* level, double* latencies, int numFailed,
+	double wallTime) {
+    for (int i = 0; i < level->numInstances; i++) {
+	level->buckets[find_bucket(latencies[i])]++;
+    }
+    level->numRuns += level->numInstances;
+    level->numFailed += numFailed;
+    level->wallTime += wallTime;
+}
+
+/* stress_throughput()
+ * -------------------
+ * Returns the number of instances run per second at a level, or 0 if none
+ * 	have been.
+ */
+double stress_throughput(StressLevel* level) {
+    return level->wallTime > 0 ? level->numRuns / level->wallTime : 0;
+}
+
+/* stress_percentile()
+ * -------------------
+ * Finds a percentile of the latencies of the instances run at a level.
+ *
+ * level: a pointer to the struct of the level.
+ * fraction: the fraction of instances the percentile is above, e.g. 0.99.
+ *
+ * Returns: the percentile in seconds, or 0 if no instances have been run.
+ */
+double stress_percentile(StressLevel* level, double fraction) {
+    if (level->numRuns == 0) {
+	return 0;
+    }
+    // The nearest rank of the percentile, counting from 1
+    int rank = fraction * level->numRuns;
+    rank += rank < fraction * level->numRuns || rank == 0;
+    int count = 0;
+    for (int i = 0; i < STRESS_NUM_BUCKETS; i++) {
+	count += level->buckets[i];
+	if (count >= rank) {
+	    return bucket_bound(i);
+	}
+    }
+    return bucket_bound(STRESS_NUM_BUCKETS - 1);
+}
+
+/* find_bucket()
+ * -------------
+ * Returns the first bucket whose upper bound is at least a latency, or the
+ * 	last bucket if none is.
+ */
+static int find_bucket(double latency) {
+    double bound = STRESS_MIN_LATENCY;
+    int bucket = 0;
+    while (latency > bound && bucket < STRESS_NUM_BUCKETS - 1) {
+	bound *= STRESS_BUCKET_GROWTH;
+	bucket++;
+    }
+    return bucket;
+}
+
+/* bucket_bound()
+ * --------------
+ * Returns the upper bound of a bucket, in seconds.
+ */
+static double bucket_bound(int bucket) {
+    double bound = STRESS_MIN_LATENCY;
+    for (int i = 0; i < bucket; i++) {
+	bound *= STRESS_BUCKET_GROWTH;
+    }
+    return bound;
+}
@@ -0,0 +1,33 @@
+/*
+ * stressStats
+ * Throughput and latency of a candidate program when several instances of
+ * 	the same test are run at once, for each number of instances from one
+ * 	up to that given with '--stress'.
+ */
+
+#ifndef STRESS_STATS_H
+#define STRESS_STATS_H
+
+// Largest number of levels: one instance, each power of two up to
+// '--stress', and then '--stress' itself
+#define STRESS_MAX_LEVELS 10
+
+// Number of buckets the latencies are counted in
+#define STRESS_NUM_BUCKETS 256
+
+// Runs of the tests with the same number of instances at once
+typedef struct {
+    int numInstances;
+    int numRuns;
+    int numFailed;
+    double wallTime;
+    int buckets[STRESS_NUM_BUCKETS];
+} StressLevel;
+
+int stress_levels(StressLevel* levels, int maxInstances);
+void stress_add(StressLevel* level, double* latencies, int numFailed,
+	double wallTime);
+double stress_throughput(StressLevel* level);
+double stress_percentile(StressLevel* level, double fraction);
+
+#endif
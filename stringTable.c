@@ -0,0 +1,149 @@
+/*
+ * stringTable
+ * An open addressing hash table from strings to the indexes of whatever
+ * 	they name. Strings are hashed with 32-bit FNV-1a and collisions are
+ * 	resolved by linear probing. The table is kept at most half full,
+ * 	doubling when it would be more, so that it never grows once it has
+ * 	been sized for the strings expected.
+ */
+
+#include "stringTable.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Hash parameters (32-bit FNV-1a)
+#define FNV_OFFSET 2166136261u
+#define FNV_PRIME 16777619u
+
+/* Function prototypes */
+static unsigned int find_slot(StringTable* table, char* key);
+static void grow_table(StringTable* table);
+static unsigned int hash_string(char* key);
+
+/* string_table_start()
+ * --------------------
+ * Creates an empty table, sized so that it holds a number of strings
+ * 	without growing.
+ *
+ * table: a pointer to the struct to store the table in.
+ * numExpected: the number of strings expected.
+ *
+ * Returns: void
+ */
+void string_table_start(StringTable* table, unsigned int numExpected) {
+    table->size = 1;
+    while (table->size < numExpected * 2) {
+	table->size *= 2;
+    }
+    table->keys = calloc(table->size, sizeof(char*));
+    table->values = malloc(sizeof(int) * table->size);
+    table->numUsed = 0;
+}
+
+/* string_table_find()
+ * -------------------
+ * Finds the value of a string in a table.
+ *
+ * table: a pointer to the struct of the table.
+ * key: a pointer to the array with the string.
+ *
+ * Returns: the value of the string, or STRING_NOT_FOUND if it is not in the
+ * 	table.
+ */
+int string_table_find(StringTable* table, char* key) {
+    unsigned int slot = find_slot(table, key);
+    return table->keys[slot] != NULL ? table->values[slot] :
+	    STRING_NOT_FOUND;
+}
+
+/* string_table_add()
+ * ------------------
+ * Adds a string to a table with a value, unless it is already there.
+ *
+ * table: a pointer to the struct of the table.
+ * key: a pointer to the array with the string, which is not copied.
+ * value: the value of the string, which is not negative.
+ *
+ * Returns: the value of the string in the table, which is the value given
+ * 	if it was added.
+ */
+int string_table_add(StringTable* table, char* key, int value) {
+    unsigned int slot = find_slot(table, key);
+    if (table->keys[slot] != NULL) {
+	return table->values[slot];
+    }
+    table->keys[slot] = key;
+    table->values[slot] = value;
+    if (++table->numUsed * 2 > table->size) {
+	grow_table(table);
+    }
+    return value;
+}
+
+/* string_table_free()
+ * -------------------
+ * Frees the memory of a table, but not of its strings.
+ *
+ * table: a pointer to the struct of the table.
+ *
+ * Returns: void
+ */
+void string_table_free(StringTable* table) {
+    free(table->keys);
+    free(table->values);
+    table->keys = NULL;
+    table->values = NULL;
+    table->size = 0;
+    table->numUsed = 0;
+}
+
+/* find_slot()
+ * -----------
+ * Returns the slot of a string in a table, or the empty slot it would go in.
+ */
+static unsigned int find_slot(StringTable* table, char* key) {
+    unsigned int slot = hash_string(key) & (table->size - 1);
+    while (table->keys[slot] != NULL && strcmp(table->keys[slot], key) != 0) {
+	slot = (slot + 1) & (table->size - 1);
+    }
+    return slot;
+}
+
+/* grow_table()
+ * ------------
+ * Doubles the number of slots of a table, and adds each string again.
+ *
+ * table: a pointer to the struct of the table.
+ *
+ * Returns: void
+ */
+static void grow_table(StringTable* table) {
+    char** keys = table->keys;
+    int* values = table->values;
+    unsigned int size = table->size;
+    table->size *= 2;
+    table->keys = calloc(table->size, sizeof(char*));
+    table->values = malloc(sizeof(int) * table->size);
+    for (unsigned int i = 0; i < size; i++) {
+	if (keys[i] != NULL) {
+	    unsigned int slot = find_slot(table, keys[i]);
+	    table->keys[slot] = keys[i];
+	    table->values[slot] = values[i];
+	}
+    }
+    free(keys);
+    free(values);
+}
+
+/* hash_string()
+ * -------------
+ * Returns the FNV-1a hash of a string.
+ */
+static unsigned int hash_string(char* key) {
+    unsigned int hash = FNV_OFFSET;
+    for (char* c = key; *c != '\0'; c++) {
+	hash ^= (unsigned char)*c;
+	hash *= FNV_PRIME;
+    }
+    return hash;
+}
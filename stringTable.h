@@ -0,0 +1,28 @@
+/*
+ * stringTable
+ * An open addressing hash table from strings to the indexes of whatever
+ * 	they name, such as test IDs or covered lines. The strings are not
+ * 	copied, so they must outlive the table.
+ */
+
+#ifndef STRING_TABLE_H
+#define STRING_TABLE_H
+
+// Value of a string that is not in a table
+#define STRING_NOT_FOUND -1
+
+// Key and value of each slot, with an empty slot's key being NULL, and the
+// number of slots in use
+typedef struct {
+    char** keys;
+    int* values;
+    unsigned int size;
+    unsigned int numUsed;
+} StringTable;
+
+void string_table_start(StringTable* table, unsigned int numExpected);
+int string_table_find(StringTable* table, char* key);
+int string_table_add(StringTable* table, char* key, int value);
+void string_table_free(StringTable* table);
+
+#endif
@@ -4,29 +4,87 @@
  * Author: Hamza
  */
 
-#include <csse2310a3.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
 #include <unistd.h>
 #include <sys/wait.h>
+#include <sys/resource.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <errno.h>
 #include <signal.h>
+#include <time.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <fnmatch.h>
+#include <limits.h>
+#include <dirent.h>
+#include "goldenIO.h"
+#include "compare.h"
+#include "blockCodec.h"
+#include "jobSpecFile.h"
+#include "daemonSocket.h"
+#include "progressDisplay.h"
+#include "perfCounters.h"
+#include "stressStats.h"
+#include "coverageMap.h"
+#include "runHistory.h"
+#include "checkpointFile.h"
+#include "memoryCgroup.h"
+#include "stringTable.h"
 
 // Required number of command line arguments
-#define MIN_ARGC 3
-#define MAX_ARGC 8
+#define MIN_ARGC 2
+#define MAX_ARGC 46
 #define NUM_REQUIRED_ARGS 2
-#define NUM_OPTIONAL_ARGS 2
+#define NUM_OPTIONAL_ARGS 20
+
+// Largest number of candidate programs to test at once
+#define MAX_PROGRAMS 16
+
+// Largest number of times to re-run a failed test
+#define MAX_RETRIES 16
+
+// Number of retries of a test that passed while they are still running
+#define RETRIES_RUNNING -2
+
+// Largest number of instances of a test to run at once with '--stress'
+#define MAX_STRESS 256
+
+// Largest memory limit of a program in megabytes, and CPU time limit in
+// seconds, with '--memlimit' and '--cpulimit'
+#define MAX_MEMORY_LIMIT 1048576
+#define MAX_CPU_LIMIT 86400
+#define BYTES_PER_MB (1024 * 1024)
 
 // Valid command line arguments
 #define TESTDIR_ARG "--testdir"
 #define RECREATE_ARG "--recreate"
-#define JOBSPECFILE_ARG "jobspecfile"
-#define PROGRAM_ARG "program"
+#define COMPRESS_ARG "--compress"
+#define DAEMON_ARG "--daemon"
+#define CONNECT_ARG "--connect"
+#define SELECT_ARG "--select"
+#define JOBS_ARG "--jobs"
+#define TIMEOUT_FACTOR_ARG "--timeoutfactor"
+#define TIMEOUT_FLOOR_ARG "--timeoutfloor"
+#define PROGRESS_ARG "--progress"
+#define RETRIES_ARG "--retries"
+#define STRICT_ARG "--strict"
+#define COUNTERS_ARG "--counters"
+#define STRESS_ARG "--stress"
+#define MINIMIZE_ARG "--minimize"
+#define RESUME_ARG "--resume"
+#define MEMLIMIT_ARG "--memlimit"
+#define CPULIMIT_ARG "--cpulimit"
+#define RSSRATIO_ARG "--rssratio"
+#define HISTORY_ARG "--history"
+
+// Positions of the required arguments among those not starting with '-'. A
+// daemon only takes the jobspecfile, and a client only the program.
+#define JOBSPECFILE_INDEX 0
+#define CLIENT_PROGRAM_INDEX 0
 
 // Default path for test directory
 #define DEFAULT_TESTDIR_PATH "./tmp"
@@ -35,6 +93,30 @@
 #define TEST_ID 0
 #define INPUT_FILEPATH 1
 
+// An input field starting with this names a generator command instead of a
+// file, whose output is piped to the program's stdin. The command is run by
+// the shell, and the expected output of its tests is kept for as long as the
+// command and the program's arguments are the same.
+#define GENERATOR_PREFIX '|'
+#define GENERATOR_SHELL "/bin/sh"
+#define GENERATOR_TYPE ".generator"
+
+// Exit status of the process comparing stdout when the generator of the
+// test's input failed, and the directory listing open file descriptors
+#define GENERATOR_FAILED 98
+#define FD_DIR "/proc/self/fd"
+
+// Exit status of the shell is this plus the signal that killed its command
+#define SHELL_SIGNAL_BASE 128
+
+// Annotation lines in the job specifications file, which set options for the
+// next test, e.g. "#@ compare=lines"
+#define ANNOTATION_PREFIX "#@"
+#define ANNOTATION_SEPARATORS " \t"
+#define COMPARE_OPTION "compare"
+#define TAGS_OPTION "tags"
+#define TAG_SEPARATOR ','
+
 // File types for output files
 #define NUM_OF_TYPES 3
 #define STDOUT_TYPE ".stdout"
@@ -47,8 +129,16 @@
 // Command to run good-uqwordladder
 #define GOOD_UQWORDLADDER "good-uqwordladder"
 
-// Buffer for reading or writing to .exitstatus file.
-#define EXITSTATUS_BUFFER 5
+// Buffer for copying expected output files between tests.
+#define COPY_BUFFER 4096
+
+// FNV-1a hash parameters for grouping identical test invocations.
+#define FNV_OFFSET 2166136261u
+#define FNV_PRIME 16777619u
+
+// Buffer for reading or writing to .exitstatus file, which holds the exit
+// status and then the run time of good-uqwordladder in microseconds.
+#define EXITSTATUS_BUFFER 48
 
 // Indexes for pid array to increase clarity.
 #define TOTAL_PIDS 3
@@ -60,14 +150,39 @@
 #define READ_END 0
 #define WRITE_END 1
 
-// Filepath for redirecting cmp stdout and stderr 
-#define EMPTY_FILE "/dev/null"
+// 1.5s delay for a test whose good-uqwordladder run time is not known
+#define TEST_DELAY 1500000
 
-// Command for executing cmp
-#define CMP_ARG "cmp"
+// Each test may take this many times as long as good-uqwordladder did, but
+// always at least the floor in seconds.
+#define DEFAULT_TIMEOUT_FACTOR 10.0
+#define DEFAULT_TIMEOUT_FLOOR 0.5
 
-// 1.5s delay for each test
-#define TEST_DELAY 1500000
+// Longest timeout of any test in seconds
+#define MAX_TIMEOUT 86400.0
+
+// Exit code of a process that was killed for taking too long
+#define TIMED_OUT -2
+
+// Exit code of a program that could not be executed. The child process
+// sends the errno of exec back through a pipe that is closed on exec, so
+// this is known as soon as exec returns.
+#define EXEC_FAILED -3
+
+// Exit codes of a program that went over its CPU time limit, or was killed
+// by its cgroup for going over its memory limit
+#define CPU_LIMIT_EXCEEDED -4
+#define OUT_OF_MEMORY -5
+
+// Largest number of good-uqwordladder processes to run at once
+#define MAX_GOLDEN_PROCESSES 64
+
+// Tests are loaded in batches while earlier ones run, starting with a single
+// test and doubling up to the largest batch. The output files of a batch are
+// checked and created at most the largest batch at a time, so that this
+// needs no memory beyond what is on the stack.
+#define PIPELINE_FIRST_BATCH 1
+#define PIPELINE_MAX_BATCH 256
 
 // Constants for reporting test results
 #define STDOUT_REPORT "Stdout"
@@ -76,17 +191,123 @@
 #define REPORT_MSG "Job %s: %s %s\n"
 #define REPORT_MATCHES "matches"
 #define REPORT_DIFFERS "differs"
+#define TIMEOUT_MSG "Job %s: Timed out after %.3f s\n"
+#define EXEC_FAILED_MSG "Unable to execute test %s: %s\n"
 #define MATCHES 0
 #define RUN_TEST_MSG "Running test %s\n"
 #define SUCCESSFUL_TEST_MSG "testuqwordladder: %d out of %d tests passed\n"
 #define NO_TEST_MSG "testuqwordladder: No tests have been completed\n"
 
+// Constants for reporting the results of several candidate programs
+#define CANDIDATE_REPORT_MSG "Job %s with %s: %s %s\n"
+#define CANDIDATE_TEST_ERR_MSG "Unable to execute test %s with %s\n"
+#define CANDIDATE_GENERATOR_ERR_MSG "Job %s with %s: Input generator failed\n"
+#define CANDIDATE_TIMEOUT_MSG "Job %s with %s: Timed out after %.3f s\n"
+#define CANDIDATE_EXEC_FAILED_MSG "Unable to execute test %s with %s: %s\n"
+#define MATRIX_HEADER "Test"
+#define MATRIX_PASS "pass"
+#define MATRIX_FAIL "FAIL"
+#define MATRIX_FLAKY "flaky"
+#define MATRIX_LIMIT "LIMIT"
+#define CANDIDATE_SUMMARY_MSG "testuqwordladder: %s: %d out of %d tests " \
+    "passed in %.3f s\n"
+
+// Constants for reporting failed tests that were run again
+#define FLAKY_MSG "Job %s: Flaky, passed %d of %d retries\n"
+#define RETRIES_FAILED_MSG "Job %s: Failed all %d retries\n"
+#define CANDIDATE_FLAKY_MSG "Job %s with %s: Flaky, passed %d of %d retries\n"
+#define CANDIDATE_RETRIES_FAILED_MSG "Job %s with %s: Failed all %d retries\n"
+#define FLAKY_SUMMARY_MSG "testuqwordladder: %d flaky tests\n"
+#define CANDIDATE_FLAKY_SUMMARY_MSG "testuqwordladder: %s: %d flaky tests\n"
+
+// Constants for reporting programs that went over their resource limits, or
+// used more memory than good-uqwordladder by more than '--rssratio'
+#define CPU_LIMIT_MSG "Job %s: Exceeded its CPU time limit\n"
+#define OUT_OF_MEMORY_MSG "Job %s: Exceeded its memory limit\n"
+#define CANDIDATE_CPU_LIMIT_MSG "Job %s with %s: Exceeded its CPU time limit\n"
+#define CANDIDATE_OUT_OF_MEMORY_MSG "Job %s with %s: Exceeded its memory " \
+    "limit\n"
+#define PEAK_MEMORY_MSG "Job %s: Peak memory of %ld KB is over %.2f times " \
+    "good-uqwordladder's %ld KB\n"
+#define CANDIDATE_PEAK_MEMORY_MSG "Job %s with %s: Peak memory of %ld KB is " \
+    "over %.2f times good-uqwordladder's %ld KB\n"
+#define LIMIT_SUMMARY_MSG "testuqwordladder: %d tests over their limits\n"
+#define CANDIDATE_LIMIT_SUMMARY_MSG "testuqwordladder: %s: %d tests over " \
+    "their limits\n"
+
+// Constants for reporting hardware counters against good-uqwordladder
+#define COUNTERS_MSG "Job %s: Counters against good-uqwordladder: %s\n"
+#define CANDIDATE_COUNTERS_MSG "Job %s with %s: Counters against " \
+    "good-uqwordladder: %s\n"
+#define COUNTERS_SUMMARY_MSG "testuqwordladder: Counters against " \
+    "good-uqwordladder: %s\n"
+#define CANDIDATE_COUNTERS_SUMMARY_MSG "testuqwordladder: %s: counters " \
+    "against good-uqwordladder: %s\n"
+#define COUNTERS_BUFFER 256
+
+// Constants for reporting tests run as several instances at once
+#define STRESS_FAILED_MSG "Job %s: Failed %d of %d instances run at once\n"
+#define CANDIDATE_STRESS_FAILED_MSG "Job %s with %s: Failed %d of %d " \
+    "instances run at once\n"
+#define STRESS_SUMMARY_MSG "testuqwordladder: %d at once: %.1f runs/s " \
+    "(x%.2f), p50 %.3f s, p99 %.3f s, %d of %d failed\n"
+#define CANDIDATE_STRESS_SUMMARY_MSG "testuqwordladder: %s: %d at once: " \
+    "%.1f runs/s (x%.2f), p50 %.3f s, p99 %.3f s, %d of %d failed\n"
+
+// Constants for minimizing the job file by the line coverage of each test.
+// The coverage data of the program is written below the coverage directory
+// in the test directory.
+#define COVERAGE_DIR "coverage"
+#define COVERAGE_PREFIX_ENV "GCOV_PREFIX"
+#define COVERAGE_MSG "Job %s: Covers %d lines\n"
+#define MINIMIZE_SUMMARY_MSG "testuqwordladder: Kept %d of %d tests, " \
+    "covering %d lines\n"
+#define MINIMIZED_HEADER "# Minimized from %s with %s: %d of %d tests, " \
+    "covering %d lines\n"
+#define MINIMIZED_GAIN "# Covers %d new lines\n"
+
+// Constants for the history of every test run, which is kept in the test
+// directory
+#define HISTORY_FILE "history"
+#define HISTORY_SLOWEST 10
+
+// Constants for the checkpoint of the tests finished in a run, which is kept
+// in the test directory until the run finishes every test
+#define CHECKPOINT_FILE "checkpoint"
+#define RESUME_MSG "testuqwordladder: Resuming %d tests finished in an " \
+    "earlier run\n"
+#define RESUMED_MSG "Job %s: %s in an earlier run\n"
+#define CANDIDATE_RESUMED_MSG "Job %s with %s: %s in an earlier run\n"
+#define RESUMED_FAILED "Failed"
+#define RESUMED_FLAKY "Flaky"
+#define RESUMED_LIMIT "Over its limits"
+#define NULL_DEVICE "/dev/null"
+
 // Required number of matches for a successful test
 #define REQUIRED_MATCHES 3
 
+// Self-benchmark build (-DBENCHMARK) reporting and phase control
+#define BENCH_STOP_ENV "TESTUQWORDLADDER_BENCH_STOP"
+#define BENCH_PHASE_MSG "testuqwordladder-bench: %s %.6f s for %d tests\n"
+#define BENCH_OVERHEAD_MSG "testuqwordladder-bench: overhead %.6f s per test\n"
+#define BENCH_ALLOCATIONS_MSG "testuqwordladder-bench: allocations %ld " \
+    "after the first test\n"
+
 // Error messages
 #define USAGE_ERR_MSG "Usage: testuqwordladder [--diffshow N] " \
-    "[--testdir dir] [--recreate] jobspecfile program\n"
+    "[--testdir dir] [--recreate] [--compress] [--select pattern] " \
+    "[--jobs N] [--timeoutfactor k] [--timeoutfloor seconds] " \
+    "[--progress] [--retries N] [--strict] [--counters] [--stress N] " \
+    "[--resume] [--memlimit MB] [--cpulimit seconds] [--rssratio k] " \
+    "jobspecfile program [program ...]\n" \
+    "       testuqwordladder --minimize outfile [--testdir dir] " \
+    "[--recreate] [--compress] [--select pattern] jobspecfile program\n" \
+    "       testuqwordladder --history [--testdir dir] [--select pattern]\n" \
+    "       testuqwordladder --daemon socket [--testdir dir] [--recreate] " \
+    "[--compress] [--timeoutfactor k] [--timeoutfloor seconds] " \
+    "[--retries N] [--strict] [--counters] [--memlimit MB] " \
+    "[--cpulimit seconds] [--rssratio k] jobspecfile\n" \
+    "       testuqwordladder --connect socket [--select pattern] program\n"
 #define JOBSPECFILE_OPEN_ERR_MSG "testuqwordladder: Unable to open job " \
     "file \"%s\"\n"
 #define JOBSPECFILE_SYNTAX_ERR_MSG "testuqwordladder: Syntax error on line" \
@@ -102,6 +323,36 @@
 #define OUTPUT_FILE_ERR_MSG "testuqwordladder: Can't open output file " \
     "\"%s\" for writing\n"
 #define TEST_ERR_MSG "Unable to execute test %s\n"
+#define GENERATOR_ERR_MSG "Job %s: Input generator failed\n"
+#define GENERATOR_REBUILD_ERR_MSG "testuqwordladder: Input generator of job " \
+    "%s failed, so its expected output will be rebuilt next time\n"
+#define PROGRAM_DROPPED_MSG "testuqwordladder: Unable to execute \"%s\": " \
+    "%s, so its remaining tests fail\n"
+#define PROGRAM_EXEC_ERR_MSG "testuqwordladder: Unable to execute \"%s\": " \
+    "%s\n"
+#define DAEMON_SOCKET_ERR_MSG "testuqwordladder: Unable to listen on socket " \
+    "\"%s\"\n"
+#define DAEMON_CONNECT_ERR_MSG "testuqwordladder: Unable to connect to " \
+    "daemon on socket \"%s\"\n"
+#define COUNTERS_UNAVAILABLE_MSG "testuqwordladder: Hardware counters are " \
+    "unavailable, running without them\n"
+#define DAEMON_LOST_ERR_MSG "testuqwordladder: Lost connection to daemon\n"
+#define HISTORY_ERR_MSG "testuqwordladder: Unable to read history file " \
+    "\"%s\"\n"
+#define HISTORY_WRITE_ERR_MSG "testuqwordladder: Unable to write history " \
+    "file \"%s\"\n"
+#define COVERAGE_ERR_MSG "testuqwordladder: No coverage data from \"%s\", " \
+    "which must be built with --coverage\n"
+
+// Environment variable holding the listening socket and pending client of a
+// daemon that restarted itself, as "listenfd,clientfd"
+#define DAEMON_RESTART_ENV "TESTUQWORDLADDER_DAEMON_FDS"
+#define DAEMON_RESTART_FORMAT "%d,%d"
+#define DAEMON_RESTART_BUFFER 32
+#define SELF_EXE "/proc/self/exe"
+
+// Message a client sends to the daemon when it receives SIGINT
+#define INTERRUPT_REQUEST "I"
 
 // Program exit statuses
 enum ExitStatus {
@@ -116,6 +367,11 @@ enum ExitStatus {
     OUTPUT_FILE_ERR = 6,
     NO_TESTS = 9,
     UNSUCCESSFUL_TESTS = 18,
+    DAEMON_SOCKET_ERR = 7,
+    DAEMON_CONNECT_ERR = 8,
+    PROGRAM_EXEC_ERR = 12,
+    COVERAGE_ERR = 13,
+    HISTORY_ERR = 15,
     UNEXPECTED_ERR = 99
 };
 
@@ -127,58 +383,466 @@ typedef struct {
     char* outputFile;
     char* errorFile;
     char* exitStatusFile;
+    enum CompareMode compareMode;
+    char* tags;
+    int numTags;
+    int invocation;
+    bool rebuilding;
+    int expectedExitStatus;
+    double goldenTime;
+    long goldenRss;
+    double timeout;
 } JobSpecs;
 
+// Position of the pipeline in the job specifications file, and the hash
+// tables of the test IDs and invocations of the tests read so far
+typedef struct {
+    int lineNumber;
+    int numArgs;
+    int numListedTests;
+    StringTable idIndex;
+    unsigned int tableSize;
+    int* invocationTable;
+    size_t pathPoolUsed;
+    bool done;
+} JobSpecReader;
+
 // Values of command line arguments
 typedef struct {
     char* jobSpecFilePath;
     int numOfTests;
     JobSpecs* jobSpecs;
-    char* program;
+    char** programs;
+    int numPrograms;
+    int jobs;
+    int retries;
+    bool strict;
+    bool counters;
+    int stress;
+    char* minimize;
+    bool resume;
+    int memLimit;
+    int cpuLimit;
+    bool memoryCgroups;
+    double rssRatio;
+    double timeoutFactor;
+    double timeoutFloor;
     char* testDir;
     bool recreate;
+    bool compress;
+    bool progress;
+    char* select;
+    char* daemonSocket;
+    struct timespec jobSpecMtime;
+    JobSpecFile jobSpecFile;
+    JobSpecReader reader;
+    char** argPool;
+    char* pathPool;
+    char* keyPool;
+    int* programErrors;
 } ProgramParameters;
 
+// A good-uqwordladder process rebuilding the expected output of a test, the
+// generator of its input, and the process compressing its output once both
+// have been reaped, each 0 if there is none or it has been reaped. The
+// rebuild is finished once all of them have been reaped.
+typedef struct {
+    pid_t pid;
+    pid_t generator;
+    pid_t compressor;
+    int test;
+    struct timespec started;
+    bool reaped;
+    int status;
+    long runTime;
+    long maxRss;
+    bool generatorFailed;
+} RebuildRun;
+
+// Expected output being rebuilt in the background while tests run. The tests
+// before nextTest whose output is still being rebuilt either have a
+// good-uqwordladder process running or share the invocation of one that does.
+// More tests are loaded ahead of those being run while the last batch loaded
+// had any to rebuild. The exit statuses of finished rebuilds are queued, and
+// written to their .exitstatus files together.
+typedef struct {
+    JobSpecs* jobSpecs;
+    int numOfTests;
+    int nextTest;
+    bool readAhead;
+    bool compress;
+    char* testDir;
+    double timeoutFactor;
+    double timeoutFloor;
+    RebuildRun runs[MAX_GOLDEN_PROCESSES];
+    int numRunning;
+    pid_t owner;
+    char* statusPaths[MAX_GOLDEN_PROCESSES];
+    char statuses[MAX_GOLDEN_PROCESSES][EXITSTATUS_BUFFER];
+    int numStatuses;
+    pid_t statusesOwner;
+} Rebuilds;
+
+// Retries of a failed test against a candidate program running in the
+// background. The number of them that passed, and the errno of exec if the
+// program could not be executed, are stored once every process has finished
+// or been killed at the test's timeout.
+typedef struct {
+    int testNum;
+    int numInstances;
+    pid_t pid[MAX_RETRIES * TOTAL_PIDS];
+    int statuses[MAX_RETRIES * TOTAL_PIDS];
+    double elapsed[MAX_RETRIES * TOTAL_PIDS];
+    struct rusage usages[MAX_RETRIES * TOTAL_PIDS];
+    MemoryCgroup cgroups[MAX_RETRIES];
+    int execErrors[MAX_RETRIES];
+    int numRunning;
+    struct timespec started;
+    struct timespec deadline;
+    int* numPassed;
+    int* execError;
+} RetryRun;
+
+// Retries of a failed test against a candidate program waiting to start
+typedef struct {
+    int testNum;
+    char* program;
+    int* numPassed;
+    int* execError;
+} RetryRequest;
+
+// Retries running in the background while later tests run, up to '--jobs'
+// of them at once. The retries after those wait in order of the tests
+// failing, and start as running ones finish.
+typedef struct {
+    ProgramParameters parameters;
+    RetryRun runs[MAX_PROGRAMS];
+    int numRuns;
+    RetryRequest* waiting;
+    int numWaiting;
+    int nextWaiting;
+    pid_t owner;
+} Retries;
+
+// Verdicts of a test: flaky tests failed, but then passed when run again, and
+// tests over their limits were killed for using too much CPU time or memory
+enum Verdict {
+    VERDICT_PASS = 0,
+    VERDICT_FAIL = 1,
+    VERDICT_FLAKY = 2,
+    VERDICT_LIMIT = 3
+};
+
+// Results of the tests run so far, for each candidate program
+typedef struct {
+    int numOfRunTests;
+    int* runTests;
+    enum Verdict* verdicts;
+    int* successfulTests;
+    int* flakyTests;
+    int* limitTests;
+    double* runTimes;
+    long long* counterTotals;
+    StressLevel* stressLevels;
+    int numStressLevels;
+} TestResults;
+
+// Resources used by a candidate program on a test: wall-clock and CPU time
+// in seconds, peak memory in kilobytes, and whether its cgroup killed it for
+// going over its memory limit
+typedef struct {
+    double runTime;
+    double cpuTime;
+    long maxRss;
+    bool oomKilled;
+} Usage;
+
+// Results of each unique invocation of the tests, which are reported again
+// for the other tests that share it: the exit statuses of the three
+// processes, the time and memory used and the errno of exec of each
+// candidate, the hardware counters of each candidate and then
+// good-uqwordladder, the number of retries of each candidate that passed,
+// or -1 if it has not been retried, and the number of instances of each
+// candidate that failed when run at once, or -1 if it has not been stressed
+typedef struct {
+    int* codes;
+    Usage* usages;
+    int* execErrors;
+    bool* run;
+    long long* counts;
+    int numCounts;
+    int* retries;
+    int* stress;
+} Invocations;
+
+// An optional command line argument, and whether it is followed by a value
+typedef struct {
+    char* name;
+    bool hasValue;
+} OptionalArg;
+
+// Phases of the harness timed by the self-benchmark build.
+enum BenchPhase {
+    BENCH_PARSE = 0,
+    BENCH_GOLDEN = 1,
+    BENCH_RUN = 2
+};
+
 /* Function prototypes */
 void check_num_args(int argc);
 void check_args_validity(int argc, char** argv); 
 void check_repeated_args(int argc, char** argv); 
 void check_args_index(int argc, char** argv);
-char* get_required_arg(int argc, char** argv, char* arg);
-char* get_testdir(int argc, char** argv);
-bool get_recreate(int argc, char** argv);
-JobSpecs* open_jobspecfile(int argc, char** argv, int* numOfTests); 
-char** add_test_args(char** splitLine, char* program); 
-void check_line_syntax(char* line, int lineNumber, char* jobSpecFilePath);
+int find_optional_arg(char* arg);
+char* get_required_arg(int argc, char** argv, int index);
+char* get_optional_arg(int argc, char** argv, char* arg);
+char** get_programs(int argc, char** argv, int* numPrograms);
+int get_count_arg(int argc, char** argv, char* arg, int defaultValue,
+	int max);
+double get_timeout_arg(int argc, char** argv, char* arg,
+	double defaultValue);
+void open_jobspecfile(ProgramParameters* parameters);
+int read_jobspecs(ProgramParameters* parameters, int maxTests);
+bool load_tests(ProgramParameters* parameters, int maxTests);
+bool check_line_syntax(char** fields, int numFields);
+bool parse_annotation(char* line, enum CompareMode* compareMode,
+	char** tags, int* numTags);
+bool parse_tags(char* value, int* numTags);
 bool check_test_id_syntax(char* testID); 
-void free_split_string(char** splitLine); 
 void check_jobspecs(JobSpecs* jobSpecs, char* jobSpecFilePath, 
 	int lineNumber, int numOfTests);
+bool test_matches(char* pattern, JobSpecs* jobSpec);
+void group_invocations(ProgramParameters parameters, int first);
+unsigned int hash_invocation(JobSpecs* jobSpec);
+bool same_invocation(JobSpecs* first, JobSpecs* second);
 void create_testdir(ProgramParameters parameters); 
-char* get_filepath(char* testDir, char* type, char* testID); 
-void create_output_files(ProgramParameters parameters); 
+int get_filepath(char* filePath, char* testDir, char* type, char* testID);
+void create_output_files(ProgramParameters* parameters, int first); 
+int find_stale_tests(ProgramParameters* parameters, JobSpecs* jobSpecs,
+	int numOfTests, struct timespec jobSpecMtime, int* staleTests);
 void store_output_filepath(ProgramParameters parameters, char* filePath,
 	int typeNum, int testNum); 
 void check_output_file(int fd, char* filePath); 
-bool check_modification_time(char* outputFilePath, char* jobSpecFilePath); 
-void run_gooduqwordladder(ProgramParameters parameters); 
+bool check_modification_time(struct timespec outputMtime,
+	struct timespec jobSpecMtime);
+void schedule_rebuilds(ProgramParameters parameters);
+void start_rebuilds(void);
+bool finish_rebuild(pid_t pid, int status, struct rusage* usage);
+void complete_rebuild(int run);
+pid_t start_compressor(JobSpecs* jobSpec);
+void wait_for_rebuild(ProgramParameters parameters, int testNum);
+void wait_for_rebuilds(void);
+void flush_rebuild_statuses(void);
+void cancel_rebuilds(void);
+void load_expected_exit_statuses(ProgramParameters parameters, int first);
+void set_expected_exit_status(JobSpecs* jobSpec, char* text,
+	double timeoutFactor, double timeoutFloor);
+void link_output_file(char* fromPath, char* toPath);
+bool is_generator(JobSpecs* jobSpec);
+void make_input_pipe(JobSpecs* jobSpec, int* inputPipe);
+int open_input(JobSpecs* jobSpec, int* inputPipe);
+pid_t start_generator(JobSpecs* jobSpec, int* inputPipe, pid_t group);
+bool generator_failed(int status);
+void close_other_fds(void);
+void make_generator_key(JobSpecs* jobSpec, char* key);
+bool check_generator_key(char* keyPath, char* key);
+void write_generator_key(char* keyPath, char* key);
 void run_testjob(ProgramParameters parameters); 
+void record_test(ProgramParameters parameters, int test,
+	Invocations* invocations, TestResults* results, Progress* progress,
+	uint64_t* programHashes);
+int record_finished_tests(ProgramParameters parameters, int* pendingTests,
+	int numPending, Invocations* invocations, TestResults* results,
+	Progress* progress, uint64_t* programHashes);
+void record_interrupted_tests(ProgramParameters parameters, int* pendingTests,
+	int numPending, Invocations* invocations, TestResults* results,
+	Progress* progress, uint64_t* programHashes);
+void add_run_test(TestResults* results, int testNum);
+void run_invocation(ProgramParameters parameters, int testNum,
+	int* exitCodes, int* execErrors, Usage* usages, long long* counts);
+void check_exec_error(char* program, int execError);
+bool exec_error_depends_on_test(int execError);
+void drop_program(ProgramParameters parameters, int program, int execError);
+void measure_gooduqwordladder(ProgramParameters parameters, int testNum,
+	long long* counts);
+void add_counts(long long* totals, long long* counts);
+void report_counters(char* testID, char* candidate, long long* counts,
+	long long* reference);
+int run_instances(ProgramParameters parameters, int testNum, char* program,
+	int numInstances, double* latencies, int* execError);
+int count_passed_instances(ProgramParameters parameters, int testNum,
+	int numInstances, int* statuses, double* elapsed, Usage* usages,
+	int* execErrors, int* execError);
+void queue_retries(int testNum, char* program, int* numPassed,
+	int* execError);
+void start_retries(void);
+bool finish_retry(pid_t pid, int status, struct rusage* usage);
+void complete_retries(int run);
+void kill_retry_run(RetryRun* run);
+bool expire_retries(void);
+struct timespec* retry_deadline(struct timespec* deadline,
+	struct timespec* earliest);
+void wait_for_retries(void);
+void cancel_retries(void);
+int stress_test(ProgramParameters parameters, int testNum, char* program,
+	StressLevel* levels, int numLevels, int* execError);
+void report_retries(ProgramParameters parameters, int testNum,
+	char* candidate, int numPassed);
 void interrupt_handler(int sig);
+void child_handler(int sig);
 void setup_sigaction(void);
-void run_uqwordladder(ProgramParameters parameters, int* outputPipe,
-	int* errorPipe, int testNum);
-void run_three_processes(ProgramParameters parameters, pid_t* pid,
-	int* outputPipe, int* errorPipe, int testNum);
-void run_cmp(int* firstPipe, int* secondPipe, char* filePath); 
-int* get_exit_codes(pid_t* pid);
-bool check_test_error(JobSpecs* jobspecs, int* exitCodes, int testNum);
-int report_cmp_results(JobSpecs* jobSpecs, int testNum, int* exitCodes); 
-void check_interrupt(pid_t* pid, int successfulTests, int numOfRunTests); 
-void kill_processes(pid_t* pid); 
+pid_t fork_process(void);
+pid_t fork_counted_process(PerfCounters* counters);
+pid_t start_gooduqwordladder(JobSpecs* jobSpec, pid_t* generator);
+void exec_gooduqwordladder(JobSpecs* jobSpec, int* inputPipe);
+pid_t wait_for_child(int* status, struct timespec* deadline,
+	struct rusage* usage);
+double seconds_since(struct timespec* start);
+void set_deadline(struct timespec* deadline, struct timespec* start,
+	double timeout);
+pid_t wait_for_test_child(int* status, struct timespec* deadline,
+	struct rusage* usage);
+void wait_test_processes(pid_t* pid, int numPids, double timeout,
+	int* statuses, double* elapsed, struct rusage* usages);
+void run_uqwordladder(ProgramParameters parameters, int* inputPipe,
+	int* outputPipe, int* errorPipe, int testNum, char* program,
+	int statusFd, MemoryCgroup* cgroup);
+void limit_resources(ProgramParameters parameters, MemoryCgroup* cgroup);
+int run_three_processes(ProgramParameters parameters, pid_t* pid,
+	int* outputPipe, int* errorPipe, int testNum, char* program,
+	PerfCounters* counters, MemoryCgroup* cgroup);
+void run_cmp(int* firstPipe, int* secondPipe, char* filePath,
+	enum CompareMode mode, pid_t generator);
+void get_exit_codes(ProgramParameters parameters, int testNum,
+	int* statuses, double* elapsed, Usage* usage, int* exitCodes);
+bool over_cpu_limit(ProgramParameters parameters, int status, Usage* usage);
+void get_usage(struct rusage* processUsage, double elapsed,
+	MemoryCgroup* cgroup, Usage* usage);
+bool check_test_error(JobSpecs* jobspecs, int* exitCodes, int testNum,
+	char* candidate);
+int report_cmp_results(JobSpecs* jobSpecs, int testNum, int* exitCodes,
+	char* candidate);
+void report_exec_failed(JobSpecs* jobSpecs, int testNum, char* candidate,
+	int execError);
+void report_peak_memory(JobSpecs* jobSpec, char* candidate, long maxRss,
+	double rssRatio);
+int count_matches(JobSpecs* jobSpecs, int testNum, int* exitCodes);
+void report_results(ProgramParameters parameters, TestResults* results);
+void minimize_testjob(ProgramParameters parameters);
+void report_history(char* testDir, char* select);
+void save_history(void);
+long long golden_mtime(JobSpecs* jobSpec);
+bool resume_test(ProgramParameters parameters, int testNum,
+	TestResults* results, Progress* progress);
+void save_checkpoint(void);
+void write_minimized_jobspec(ProgramParameters parameters, int* order,
+	int* gains, int numKept, int numLines);
+void report_stress(char* candidate, StressLevel* levels, int numLevels);
+void report_stress_failed(char* testID, char* candidate, int numFailed,
+	StressLevel* levels, int numLevels);
+bool test_selected(ProgramParameters parameters, int testNum);
+void check_interrupt(int successfulTests, int numOfRunTests); 
+void kill_processes(pid_t* pid, int numPids, int* statuses); 
 void free_program_parameters(ProgramParameters parameters); 
+void bench_start(void);
+void bench_phase_done(enum BenchPhase phase, int numOfTests);
+void bench_test_done(void);
+void run_daemon(ProgramParameters parameters, char** argv);
+bool job_file_changed(ProgramParameters parameters);
+void restart_daemon(char** argv, int listenFd, int clientFd);
+void serve_client(ProgramParameters parameters, int clientFd);
+void run_client(char* socketPath, char* program, char* select);
+
+// Optional command line arguments
+const OptionalArg optionalArgs[NUM_OPTIONAL_ARGS] = {
+    {TESTDIR_ARG, true},
+    {RECREATE_ARG, false},
+    {COMPRESS_ARG, false},
+    {DAEMON_ARG, true},
+    {CONNECT_ARG, true},
+    {SELECT_ARG, true},
+    {JOBS_ARG, true},
+    {TIMEOUT_FACTOR_ARG, true},
+    {TIMEOUT_FLOOR_ARG, true},
+    {PROGRESS_ARG, false},
+    {RETRIES_ARG, true},
+    {STRICT_ARG, false},
+    {COUNTERS_ARG, false},
+    {STRESS_ARG, true},
+    {MINIMIZE_ARG, true},
+    {RESUME_ARG, false},
+    {MEMLIMIT_ARG, true},
+    {CPULIMIT_ARG, true},
+    {RSSRATIO_ARG, true},
+    {HISTORY_ARG, false}
+};
+
+// Types of the output files of each test, in the order they are stored in
+const char* outputTypes[NUM_OF_TYPES] = {
+    STDOUT_TYPE,
+    STDERR_TYPE,
+    EXITSTATUS_TYPE
+};
 
 // Global variable that signfies if the program was interrupt by SIGINT.
-bool interrupted = false;
+volatile bool interrupted = false;
+
+// Expected output being rebuilt, which is checked on whenever a child process
+// is reaped.
+Rebuilds rebuilds;
+
+// Retries running in the background, which are checked on whenever a child
+// process is reaped.
+Retries retries;
+
+// Records of the tests run so far that have not been written to the history
+// file, which are written when the program exits.
+History history;
+
+// Verdicts of the tests finished so far, which are synced to the checkpoint
+// file in batches and when the program exits.
+Checkpoint checkpoint;
+
+#ifdef BENCHMARK
+// Start time of the current phase and total time spent waiting for test
+// processes.
+double benchPhaseStart = 0;
+double benchWaitTotal = 0;
+
+// Heap allocations made by this process, and the number made by the end of
+// the first test, or -1 before then. The benchmark build replaces malloc(),
+// calloc() and realloc() with ones that count each call.
+long benchAllocations = 0;
+long benchFirstTestAllocations = -1;
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* pointer, size_t size);
+
+void* malloc(size_t size) {
+    benchAllocations++;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    benchAllocations++;
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, size_t size) {
+    benchAllocations++;
+    return __libc_realloc(pointer, size);
+}
+
+/* bench_now()
+ * -----------
+ * Returns the current monotonic time in seconds.
+ */
+double bench_now(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+#endif
 
 /* interrupt_handler()
  * -------------------
@@ -193,6 +857,38 @@ void interrupt_handler(int sig) {
     interrupted = true;
 }
 
+/* child_handler()
+ * ---------------
+ * Does nothing. Handling SIGCHLD makes it interrupt the wait for a child
+ * 	process in wait_for_child().
+ *
+ * sig: the number of the signal
+ *
+ * Returns: void
+ */
+void child_handler(int sig) {
+}
+
+/* setup_sigaction()
+ * -----------------
+ * Sets up the handlers for SIGINT and SIGCHLD.
+ *
+ * Returns: void
+ */
+void setup_sigaction(void) {
+    struct sigaction interrupt;
+    memset(&interrupt, 0, sizeof(struct sigaction));
+    interrupt.sa_handler = interrupt_handler;
+    interrupt.sa_flags = SA_RESTART;
+    sigaction(SIGINT, &interrupt, NULL);
+
+    struct sigaction child;
+    memset(&child, 0, sizeof(struct sigaction));
+    child.sa_handler = child_handler;
+    child.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+    sigaction(SIGCHLD, &child, NULL);
+}
+
 int main(int argc, char** argv) {
     // Check command line arguments
     check_num_args(argc);
@@ -200,19 +896,97 @@ int main(int argc, char** argv) {
     check_repeated_args(argc, argv); 
     check_args_index(argc, argv);
 
-    // Get all the required parameters from command line arguments.
+    // The history of the tests is reported without running any.
+    if (get_optional_arg(argc, argv, HISTORY_ARG) != NULL) {
+	report_history(get_optional_arg(argc, argv, TESTDIR_ARG),
+		get_optional_arg(argc, argv, SELECT_ARG));
+    }
+
+    // Setup signal handlers so that SIGINT stops the program at any phase.
+    setup_sigaction();
+
+    // Expected output left incomplete when the program exits is removed, so
+    // that it is rebuilt on the next run.
+    rebuilds.owner = getpid();
+    atexit(cancel_rebuilds);
+    atexit(cancel_retries);
+    atexit(save_history);
+    atexit(save_checkpoint);
+
+    // A client only sends the program to test to a daemon.
+    char* connectSocket = get_optional_arg(argc, argv, CONNECT_ARG);
+    if (connectSocket != NULL) {
+	run_client(connectSocket,
+		get_required_arg(argc, argv, CLIENT_PROGRAM_INDEX),
+		get_optional_arg(argc, argv, SELECT_ARG));
+    }
+
+    // Get all the required parameters from command line arguments. A daemon
+    // is given the program by each client instead.
     ProgramParameters parameters;
-    parameters.program = get_required_arg(argc, argv, PROGRAM_ARG);
-    parameters.testDir = get_testdir(argc, argv);
-    parameters.recreate = get_recreate(argc, argv);
-    parameters.jobSpecFilePath = get_required_arg(argc, argv, JOBSPECFILE_ARG);
+    parameters.daemonSocket = get_optional_arg(argc, argv, DAEMON_ARG);
+    parameters.programs = get_programs(argc, argv, &parameters.numPrograms);
+    parameters.jobs = get_count_arg(argc, argv, JOBS_ARG,
+	    parameters.numPrograms, MAX_PROGRAMS);
+    parameters.retries = get_count_arg(argc, argv, RETRIES_ARG, 0,
+	    MAX_RETRIES);
+    parameters.strict = get_optional_arg(argc, argv, STRICT_ARG) != NULL;
+    parameters.stress = get_count_arg(argc, argv, STRESS_ARG, 0, MAX_STRESS);
+    parameters.minimize = get_optional_arg(argc, argv, MINIMIZE_ARG);
+    parameters.resume = get_optional_arg(argc, argv, RESUME_ARG) != NULL;
+    parameters.memLimit = get_count_arg(argc, argv, MEMLIMIT_ARG, 0,
+	    MAX_MEMORY_LIMIT);
+    parameters.cpuLimit = get_count_arg(argc, argv, CPULIMIT_ARG, 0,
+	    MAX_CPU_LIMIT);
+    parameters.memoryCgroups = parameters.memLimit > 0 && cgroup_setup();
+    parameters.rssRatio = get_timeout_arg(argc, argv, RSSRATIO_ARG, 0);
+    parameters.counters = get_optional_arg(argc, argv, COUNTERS_ARG) != NULL;
+    if (parameters.counters && !perf_available()) {
+	fprintf(stderr, COUNTERS_UNAVAILABLE_MSG);
+	parameters.counters = false;
+    }
+    parameters.timeoutFactor = get_timeout_arg(argc, argv, TIMEOUT_FACTOR_ARG,
+	    DEFAULT_TIMEOUT_FACTOR);
+    parameters.timeoutFloor = get_timeout_arg(argc, argv, TIMEOUT_FLOOR_ARG,
+	    DEFAULT_TIMEOUT_FLOOR);
+    parameters.testDir = get_optional_arg(argc, argv, TESTDIR_ARG);
+    if (parameters.testDir == NULL) {
+	parameters.testDir = DEFAULT_TESTDIR_PATH;
+    }
+    parameters.recreate = get_optional_arg(argc, argv, RECREATE_ARG) != NULL;
+    parameters.compress = get_optional_arg(argc, argv, COMPRESS_ARG) != NULL;
+    parameters.progress = get_optional_arg(argc, argv, PROGRESS_ARG) != NULL;
+    parameters.select = get_optional_arg(argc, argv, SELECT_ARG);
+    parameters.jobSpecFilePath =
+	    get_required_arg(argc, argv, JOBSPECFILE_INDEX);
 
-    // Create a data struct of all tests from job specification file.
-    parameters.jobSpecs = open_jobspecfile(argc, argv, &parameters.numOfTests);
-    
-    // Create the test directory with expected output from good-uqwordladder.
-    create_testdir(parameters);
-    create_output_files(parameters);
+    // A daemon restarts itself if the job file changes after it is read.
+    struct stat jobSpecStat;
+    if (stat(parameters.jobSpecFilePath, &jobSpecStat) == 0) {
+	parameters.jobSpecMtime = jobSpecStat.st_mtim;
+    }
+
+    // Open the job specification file, whose tests are loaded as they are
+    // needed.
+    bench_start();
+    open_jobspecfile(&parameters);
+
+    // A daemon loads every test, and its expected output, before it runs tests
+    // for clients.
+    if (parameters.daemonSocket != NULL) {
+	load_tests(&parameters, INT_MAX);
+	for (int test = 0; test < parameters.numOfTests; test++) {
+	    wait_for_rebuild(parameters, test);
+	}
+	flush_rebuild_statuses();
+	check_interrupt(0, 0);
+	run_daemon(parameters, argv);
+    }
+
+    // Write a smaller job file instead of reporting results.
+    if (parameters.minimize != NULL) {
+	minimize_testjob(parameters);
+    }
 
     // Run all tests for the uqwordladder program to be tested, compare its
     // output the expected results and report them.
@@ -228,7 +1002,7 @@ int main(int argc, char** argv) {
  * argc: the number of command line arguments
  *
  * Errors: Exits with status 14 and the usage error message if number of
- * 	command line arguments is less than 3 or more than 8.
+ * 	command line arguments is less than 2 or more than 46.
  */
 void check_num_args(int argc) {
     if (argc < MIN_ARGC || argc > MAX_ARGC) {
@@ -239,7 +1013,12 @@ void check_num_args(int argc) {
 
 /* check_args_validity()
  * ---------------------
- * Checks if the optional command line arguments are valid
+ * Checks if the optional command line arguments are valid, and that the
+ * 	right number of required arguments are given for the mode: the
+ * 	jobspecfile and up to MAX_PROGRAMS programs normally, only the
+ * 	jobspecfile for a daemon, only one program for a client, and none
+ * 	for a report of the history, which only takes '--testdir' and
+ * 	'--select'.
  *
  * argc: the number of command line arguments
  * argv: an array of arrays of the command line arguments
@@ -248,38 +1027,74 @@ void check_num_args(int argc) {
  * 	optional command line arguments are invalid.
  */
 void check_args_validity(int argc, char** argv) {
-    char* validArgs[NUM_OPTIONAL_ARGS] = {TESTDIR_ARG, RECREATE_ARG};
-    
     // Iterate through all the command line args
     int numRequiredArgs = 0;
-    int numInvalidArgs = 0;
+    bool daemon = false;
+    bool client = false;
+    bool select = false;
+    bool daemonOnly = false;
+    bool runOnly = false;
+    bool minimize = false;
+    bool history = false;
+    bool notHistory = false;
     for (int i = 1; i < argc; i++) {
 	if (argv[i][0] == '-') {
-	    // Check if the optional arg is valid.
-	    for (int j = 0; j < NUM_OPTIONAL_ARGS; j++) {
-		if (strcmp(argv[i], validArgs[j]) != 0) {
-		    numInvalidArgs++;
-		}
-	    }
 	    // Exit program if command line arg is invalid.
-	    if (numInvalidArgs >= NUM_OPTIONAL_ARGS) {
+	    int option = find_optional_arg(argv[i]);
+	    if (option == -1) {
 		fprintf(stderr, USAGE_ERR_MSG);
 		exit(USAGE_ERR);
 	    }
+	    daemon |= strcmp(argv[i], DAEMON_ARG) == 0;
+	    client |= strcmp(argv[i], CONNECT_ARG) == 0;
+	    select |= strcmp(argv[i], SELECT_ARG) == 0;
+	    runOnly |= strcmp(argv[i], JOBS_ARG) == 0 ||
+		    strcmp(argv[i], PROGRESS_ARG) == 0 ||
+		    strcmp(argv[i], STRESS_ARG) == 0 ||
+		    strcmp(argv[i], MINIMIZE_ARG) == 0 ||
+		    strcmp(argv[i], RESUME_ARG) == 0;
+	    minimize |= strcmp(argv[i], MINIMIZE_ARG) == 0;
+	    history |= strcmp(argv[i], HISTORY_ARG) == 0;
+	    notHistory |= strcmp(argv[i], HISTORY_ARG) != 0 &&
+		    strcmp(argv[i], TESTDIR_ARG) != 0 &&
+		    strcmp(argv[i], SELECT_ARG) != 0;
+	    daemonOnly |= strcmp(argv[i], TESTDIR_ARG) == 0 ||
+		    strcmp(argv[i], RECREATE_ARG) == 0 ||
+		    strcmp(argv[i], COMPRESS_ARG) == 0 ||
+		    strcmp(argv[i], TIMEOUT_FACTOR_ARG) == 0 ||
+		    strcmp(argv[i], TIMEOUT_FLOOR_ARG) == 0 ||
+		    strcmp(argv[i], RETRIES_ARG) == 0 ||
+		    strcmp(argv[i], STRICT_ARG) == 0 ||
+		    strcmp(argv[i], COUNTERS_ARG) == 0 ||
+		    strcmp(argv[i], MEMLIMIT_ARG) == 0 ||
+		    strcmp(argv[i], CPULIMIT_ARG) == 0 ||
+		    strcmp(argv[i], RSSRATIO_ARG) == 0;
 
-	    // Check if arg is "--testdir" and increase j by 1 to skip
-	    // the 'dir' parameter
-	    if (strcmp(argv[i], validArgs[0]) == 0) {
-		i++;
+	    // Increase i by 1 to skip the parameter of args like "--testdir",
+	    // which must be given one.
+	    if (optionalArgs[option].hasValue && ++i == argc) {
+		fprintf(stderr, USAGE_ERR_MSG);
+		exit(USAGE_ERR);
 	    }
-	    // Reset counter for ntype arg that starts with '-'
-	    numInvalidArgs = 0;
 	} else {
 	    numRequiredArgs++;
 	}
     }
-    // Checks if number of args that do not begin with '-' are equal to 2.
-    if (numRequiredArgs != NUM_REQUIRED_ARGS) {
+    // Checks if number of args that do not begin with '-' are right for the
+    // mode, and that a client is not given options of the daemon. Only one
+    // program is minimized against.
+    if (history && (numRequiredArgs > 0 || notHistory)) {
+	fprintf(stderr, USAGE_ERR_MSG);
+	exit(USAGE_ERR);
+    }
+    int minRequiredArgs = daemon || client ? NUM_REQUIRED_ARGS - 1 :
+	    NUM_REQUIRED_ARGS;
+    int maxRequiredArgs = daemon || client || minimize ? minRequiredArgs :
+	    MAX_PROGRAMS + 1;
+    if ((!history && numRequiredArgs < minRequiredArgs) ||
+	    numRequiredArgs > maxRequiredArgs || (daemon && client) ||
+	    (daemon && select) || ((daemon || client) && runOnly) ||
+	    (client && daemonOnly)) {
 	fprintf(stderr, USAGE_ERR_MSG);
 	exit(USAGE_ERR);
     }
@@ -296,28 +1111,22 @@ void check_args_validity(int argc, char** argv) {
  * 	line arguments were repeated.
  */
 void check_repeated_args(int argc, char** argv) { 
-    char* validArgs[NUM_OPTIONAL_ARGS] = {TESTDIR_ARG, RECREATE_ARG};
-
-    // Iterate through each valid arg
-    int numRepeatedArgs;
-    for (int i = 0; i < NUM_OPTIONAL_ARGS; i++) {
-	numRepeatedArgs = 0;
-	// Check each arg in command line argument and compare to validArgs
-	for (int j = 1; j < argc; j++) {
-	    if (strcmp(argv[j], validArgs[i]) == 0) {
-		numRepeatedArgs++;
-	    }
-	    // Check if arg is "--testdir" and increase j by 1 to skip
-	    // the 'dir' parameter
-	    if (strcmp(argv[j], validArgs[0]) == 0) {
-		j++;
-	    }
+    // Count each valid arg in the command line arguments
+    int numRepeatedArgs[NUM_OPTIONAL_ARGS] = {0};
+    for (int i = 1; i < argc; i++) {
+	int option = find_optional_arg(argv[i]);
+	if (option == -1) {
+	    continue;
 	}
 	// Check if any args were repeated.
-	if (numRepeatedArgs > 1) {
+	if (++numRepeatedArgs[option] > 1) {
 	    fprintf(stderr, USAGE_ERR_MSG);
 	    exit(USAGE_ERR);
 	}
+	// Increase i by 1 to skip the parameter of args like "--testdir"
+	if (optionalArgs[option].hasValue) {
+	    i++;
+	}
     }
 }
 
@@ -332,35 +1141,37 @@ void check_repeated_args(int argc, char** argv) {
  * 	optional arguments are placed after any required arguments.
  */
 void check_args_index(int argc, char** argv) {
-    // Initialise variables to store index of arguments.
-    int optionalArgsIndex[NUM_OPTIONAL_ARGS];
-    int requiredArgsIndex[NUM_REQUIRED_ARGS];
-
-    // Iterate through all args and sort the indexes.
-    int numOptionalArgs = 0;
-    int numRequiredArgs = 0;
+    // Iterate through all args, noting when the first required arg is seen.
+    bool seenRequiredArg = false;
     for (int i = 1; i < argc; i++) {
-	if (argv[i][0] == '-') {
-	    // Increase i by 1 if arg is "--testdir" to avoid 'dir' value.
-	    if (strcmp(argv[i], TESTDIR_ARG) == 0) {
-		optionalArgsIndex[numOptionalArgs++] = i++;
-	    } else {
-		optionalArgsIndex[numOptionalArgs++] = i;
-	    }
-	} else {
-	    requiredArgsIndex[numRequiredArgs++] = i;
+	if (argv[i][0] != '-') {
+	    seenRequiredArg = true;
+	} else if (seenRequiredArg) {
+	    fprintf(stderr, USAGE_ERR_MSG);
+	    exit(USAGE_ERR);
+	} else if (optionalArgs[find_optional_arg(argv[i])].hasValue) {
+	    // Increase i by 1 to avoid the parameter of args like "--testdir"
+	    i++;
 	}
     }
+}
 
-    // Check if the index of any required arg is less than any optional arg.
-    for (int i = 0; i < numOptionalArgs; i++) {
-	for (int j = 0; j < numRequiredArgs; j++) {
-	    if (optionalArgsIndex[i] > requiredArgsIndex[j]) {
-		fprintf(stderr, USAGE_ERR_MSG);
-		exit(USAGE_ERR);
-	    }
+/* find_optional_arg()
+ * -------------------
+ * Finds an argument in the table of optional command line arguments.
+ *
+ * arg: a pointer to the array of the command line argument.
+ *
+ * Returns: the index of the argument in optionalArgs, or -1 if it is not a
+ * 	valid optional argument.
+ */
+int find_optional_arg(char* arg) {
+    for (int i = 0; i < NUM_OPTIONAL_ARGS; i++) {
+	if (strcmp(arg, optionalArgs[i].name) == 0) {
+	    return i;
 	}
     }
+    return -1;
 }
 
 /* get_required_arg()
@@ -370,222 +1181,473 @@ void check_args_index(int argc, char** argv) {
  *
  * argc: the number of command line arguments
  * argv: an array of arrays of the command line arguments
+ * index: the position of the argument among the required arguments
  *
  * Returns: the specified argument's value as a char pointer. But returns
  * 	NULL if it cannot be found.
  */
-char* get_required_arg(int argc, char** argv, char* arg) {
+char* get_required_arg(int argc, char** argv, int index) {
     // Iterate through all command line arguments.
     for (int i = 1; i < argc; i++) {
-	// Ignore the testdir and recreate arguments.
-	if (strcmp(argv[i], TESTDIR_ARG) == 0) {
-	    i++;
+	// Ignore the optional arguments and their parameters.
+	if (argv[i][0] == '-') {
+	    i += optionalArgs[find_optional_arg(argv[i])].hasValue;
 	    continue;
 	}
-	if (argv[i][0] != '-') {
-	    if (strcmp(arg, JOBSPECFILE_ARG) == 0) {
-		return argv[i];
-	    } else {
-		return argv[i + 1];
-	    }
+	if (index-- == 0) {
+	    return argv[i];
 	}
     }
     return NULL;
 }
 
-/* get_testdir()
- * -------------
- * Returns the testdir argument's parameter 'dir' from command line arguments
+/* get_programs()
+ * --------------
+ * Returns the candidate programs to test from the command line arguments,
+ * 	which are all the required arguments after the jobspecfile.
  *
  * argc: the number of command line arguments
  * argv: an array of arrays of the command line arguments
+ * numPrograms: a pointer to store the number of programs in.
  *
- * Returns: the 'dir' parameter given in the command line arguments. However
- * 	it returns NULL if it cannot be found.
+ * Returns: a pointer to the first program within argv, or NULL if there are
+ * 	none, as for a daemon.
  */
-char* get_testdir(int argc, char** argv) {
-    for (int i = 1; i < argc; i++) {
-	if (strcmp(argv[i], TESTDIR_ARG) == 0) {
-	    return argv[i + 1];
-	}
+char** get_programs(int argc, char** argv, int* numPrograms) {
+    // Skip the optional arguments, their parameters and the jobspecfile.
+    int i = 1;
+    while (i < argc && argv[i][0] == '-') {
+	i += 1 + optionalArgs[find_optional_arg(argv[i])].hasValue;
     }
-    return DEFAULT_TESTDIR_PATH;
+    i++;
+    *numPrograms = i < argc ? argc - i : 0;
+    return i < argc ? argv + i : NULL;
 }
 
-/* get_recreate()
- * --------------
- * Returns whether the recreate argument has been specified in the command
- * 	line arguments.
+/* get_count_arg()
+ * ---------------
+ * Returns the value of an argument that counts something, such as how many
+ * 	candidate programs may run each test at once, given by '--jobs N', or
+ * 	how many times to re-run a failed test, given by '--retries N'.
  *
  * argc: the number of command line arguments
  * argv: an array of arrays of the command line arguments
+ * arg: a pointer to the array with the name of the argument.
+ * defaultValue: the value to use if the argument is not given.
+ * max: the largest value allowed.
  *
- * Returns: true if '--recreate' has been specified, else returns false.
+ * Returns: the value of the argument.
+ * Errors: Exits with exit status 14 and prints usage error message if N is
+ * 	not a positive integer of at most max.
  */
-bool get_recreate(int argc, char** argv) {
-    for (int i = 1; i < argc; i++) {
-	if (strcmp(argv[i], RECREATE_ARG) == 0) {
-	    return true;
+int get_count_arg(int argc, char** argv, char* arg, int defaultValue,
+	int max) {
+    char* value = get_optional_arg(argc, argv, arg);
+    if (value == NULL) {
+	return defaultValue;
+    }
+    char* end;
+    long count = strtol(value, &end, 10);
+    if (*value == '\0' || *end != '\0' || count < 1 || count > max) {
+	fprintf(stderr, USAGE_ERR_MSG);
+	exit(USAGE_ERR);
+    }
+    return count;
+}
+
+/* get_timeout_arg()
+ * -----------------
+ * Returns the value of '--timeoutfactor k' or '--timeoutfloor seconds'.
+ *
+ * argc: the number of command line arguments
+ * argv: an array of arrays of the command line arguments
+ * arg: a pointer to the array with the name of the argument.
+ * defaultValue: the value to use if the argument is not given.
+ *
+ * Returns: the value of the argument.
+ * Errors: Exits with exit status 14 and prints usage error message if the
+ * 	value is not a positive number.
+ */
+double get_timeout_arg(int argc, char** argv, char* arg,
+	double defaultValue) {
+    char* value = get_optional_arg(argc, argv, arg);
+    if (value == NULL) {
+	return defaultValue;
+    }
+    char* end;
+    double number = strtod(value, &end);
+    if (*value == '\0' || *end != '\0' || !(number > 0) ||
+	    number > MAX_TIMEOUT) {
+	fprintf(stderr, USAGE_ERR_MSG);
+	exit(USAGE_ERR);
+    }
+    return number;
+}
+
+/* get_optional_arg()
+ * ------------------
+ * Returns an optional argument's parameter from the command line arguments,
+ * 	such as 'dir' for '--testdir dir'.
+ *
+ * argc: the number of command line arguments
+ * argv: an array of arrays of the command line arguments
+ * arg: the optional argument to look for
+ *
+ * Returns: the parameter given after the argument, or the argument itself if
+ * 	it does not take one, such as '--recreate'. However it returns NULL if
+ * 	the argument cannot be found.
+ */
+char* get_optional_arg(int argc, char** argv, char* arg) {
+    for (int i = 1; i < argc && argv[i][0] == '-'; i++) {
+	bool hasValue = optionalArgs[find_optional_arg(argv[i])].hasValue;
+	if (strcmp(argv[i], arg) == 0) {
+	    return hasValue ? argv[i + 1] : argv[i];
 	}
+	i += hasValue;
     }
-    return false;
+    return NULL;
 }
 
 /* open_jobspecfile()
  * ------------------
- * Opens the job specification file specified in the command line arguments
- * 	to create a data structure of the tests to conduct.
+ * Opens the job specification file specified in the command line arguments,
+ * 	and allocates the data structures for its tests, which are read in
+ * 	batches by read_jobspecs(). Each is sized for every line of the file
+ * 	being a test, so that tests can be added without moving earlier ones.
  *
- * argc: the number of command line arguments.
- * argv: an array of arrays of the command line arguments.
- * numOfTests: a pointer to a integer which will store the number of tests.
+ * parameters: a pointer to the struct with the jobspecfile and program from
+ * 	the command line arguments, to store the file and its tests in.
  *
- * Returns: a pointer to an array of structs with all the tests from
- * 	jobspecfile, including test-id, inputfile, and command line arguments.
- * Errors: Exits with status 11 and empty file error if the jobspecfile does
- * 	not have any tests listed.
+ * Errors: Exits with status 20 and open error if the jobspecfile cannot be
+ * 	opened.
  */
-JobSpecs* open_jobspecfile(int argc, char** argv, int* numOfTests) {
+void open_jobspecfile(ProgramParameters* parameters) {
     // Check if job spec file can be opened.
-    char* jobSpecFilePath = get_required_arg(argc, argv, JOBSPECFILE_ARG);
-    FILE* jobSpecFile = fopen(jobSpecFilePath, "r");
-    if (jobSpecFile == NULL) {
+    char* jobSpecFilePath = parameters->jobSpecFilePath;
+    JobSpecFile* jobSpecFile = &parameters->jobSpecFile;
+    if (!jobspec_open(jobSpecFilePath, jobSpecFile)) {
 	fprintf(stderr, JOBSPECFILE_OPEN_ERR_MSG, jobSpecFilePath);
 	exit(JOBSPECFILE_OPEN_ERR);
     }
 
-    // Initialise JobSpecs struct and required variables.
-    char* program = get_required_arg(argc, argv, PROGRAM_ARG);
-    int numTests = 0;
-    JobSpecs* jobSpecs = malloc(sizeof(JobSpecs) * numTests);
+    // Every line has one more field than tabs, plus a slot for NULL after its
+    // arguments.
+    int numLines = jobSpecFile->numLines;
+    parameters->numOfTests = 0;
+    parameters->jobSpecs = malloc(sizeof(JobSpecs) * numLines);
+    parameters->argPool = malloc(sizeof(char*) *
+	    (jobSpecFile->numTabs + 2 * numLines));
+
+    // No test ID is longer than its line, so the filepaths of every test fit
+    // in a pool sized from the file. Pages of it that are never written are
+    // never used.
+    size_t pathsLength = 0;
+    for (int i = 0; i < NUM_OF_TYPES; i++) {
+	pathsLength += get_filepath(NULL, parameters->testDir,
+		(char*) outputTypes[i], "");
+    }
+    parameters->pathPool = malloc(sizeof(char) *
+	    (pathsLength * numLines + NUM_OF_TYPES * jobSpecFile->length));
+
+    // The key of a generator test is made from the fields of its line, so
+    // the longest fits in the length of the file, with a newline and a null.
+    parameters->keyPool = malloc(sizeof(char) * (jobSpecFile->length + 2));
+
+    // Open addressing hash tables of the IDs of all tests, selected or not,
+    // and of the first test of each invocation, that are at most half full.
+    JobSpecReader* reader = &parameters->reader;
+    reader->lineNumber = 0;
+    reader->numArgs = 0;
+    reader->numListedTests = 0;
+    reader->pathPoolUsed = 0;
+    reader->done = false;
+    reader->tableSize = 1;
+    while (reader->tableSize < numLines * 2) {
+	reader->tableSize *= 2;
+    }
+    string_table_start(&reader->idIndex, numLines);
+    reader->invocationTable = malloc(sizeof(int) * reader->tableSize);
+    for (int i = 0; i < reader->tableSize; i++) {
+	reader->invocationTable[i] = -1;
+    }
+}
+
+/* read_jobspecs()
+ * ---------------
+ * Reads the next batch of tests from the job specifications file, splitting
+ * 	and checking each line in place. The fields of every test are stored
+ * 	in one array, argPool, in which the program name replaces each test's
+ * 	input file field so that the fields after it are the test's command
+ * 	line arguments. An error on a line is only found when its batch is
+ * 	read, after the tests before it may have been run.
+ *
+ * With '--select', only the tests whose ID or tags match the pattern are
+ * 	kept, before their input files are checked, so that nothing is done
+ * 	for the other tests. The IDs of all tests are still checked for
+ * 	duplicates, using a hash table of the IDs seen so far.
+ *
+ * parameters: a pointer to the struct with the opened jobspecfile, to add
+ * 	the tests to.
+ * maxTests: the largest number of tests to read.
+ *
+ * Returns: the number of tests read, which is 0 once the whole file has been
+ * 	read or if SIGINT was received.
+ * Errors: Exits with status 11 and empty file error if the jobspecfile does
+ * 	not have any tests listed, or with status 9 if none of them were
+ * 	selected.
+ */
+int read_jobspecs(ProgramParameters* parameters, int maxTests) {
+    char* jobSpecFilePath = parameters->jobSpecFilePath;
+    JobSpecReader* reader = &parameters->reader;
+    JobSpecs* jobSpecs = parameters->jobSpecs;
+    char* program = parameters->programs != NULL ?
+	    parameters->programs[0] : NULL;
+    int first = parameters->numOfTests;
+    int numTests = first;
 
-    // Read each line in the file
-    int lineNumber = 1;
-    char* line;
-    while ((line = read_line(jobSpecFile)) != NULL) {
+    // Read each line in the file until the batch is full
+    enum CompareMode compareMode = COMPARE_EXACT;
+    char* tags = NULL;
+    int numTags = 0;
+    while (!reader->done && numTests - first < maxTests && !interrupted) {
+	char* line = jobspec_next_line(&parameters->jobSpecFile);
+	if (line == NULL) {
+	    reader->done = true;
+	    break;
+	}
+	int lineNumber = ++reader->lineNumber;
+	// An annotation sets options for the next test.
+	if (strncmp(line, ANNOTATION_PREFIX, strlen(ANNOTATION_PREFIX)) == 0 &&
+		!parse_annotation(line, &compareMode, &tags, &numTags)) {
+	    fprintf(stderr, JOBSPECFILE_SYNTAX_ERR_MSG, lineNumber,
+		    jobSpecFilePath);
+	    exit(JOBSPECFILE_SYNTAX_ERR);
+	}
 	// Skip the line if it is a comment or if empty.
-	if (line[0] == '#' || strlen(line) == 0) {
-	    lineNumber++;
-	    free(line);
+	if (line[0] == '#' || line[0] == '\0') {
 	    continue;
 	}
-	// Check if line has met the validity requirements
-	check_line_syntax(strdup(line), lineNumber, jobSpecFilePath);
-	
-	// Add args to jobSpecs data struct
-	// Make data structure with all elements of each line in file.
-	char** splitLine = split_string(line, '\t');
-	jobSpecs = realloc(jobSpecs, sizeof(JobSpecs) * ++numTests);
-	jobSpecs[numTests - 1].testID = strdup(splitLine[TEST_ID]);
-	jobSpecs[numTests - 1].inputFile = strdup(splitLine[INPUT_FILEPATH]);
-	jobSpecs[numTests - 1].args = add_test_args(splitLine, program);
+	// Split the line and check if it has met the validity requirements
+	char** fields = parameters->argPool + reader->numArgs;
+	int numFields = jobspec_split_fields(line, fields);
+	if (!check_line_syntax(fields, numFields)) {
+	    fprintf(stderr, JOBSPECFILE_SYNTAX_ERR_MSG, lineNumber,
+		    jobSpecFilePath);
+	    exit(JOBSPECFILE_SYNTAX_ERR);
+	}
+
+	// Check for any repeated test IDs
+	if (string_table_add(&reader->idIndex, fields[TEST_ID],
+		reader->numListedTests) != reader->numListedTests) {
+	    fprintf(stderr, JOBSPECFILE_DUP_ERR_MSG, lineNumber,
+		    jobSpecFilePath);
+	    exit(JOBSPECFILE_DUP_ERR);
+	}
+	reader->numListedTests++;
+
+	// Add the fields to jobSpecs data struct
+	JobSpecs* jobSpec = &jobSpecs[numTests];
+	jobSpec->testID = fields[TEST_ID];
+	jobSpec->inputFile = fields[INPUT_FILEPATH];
+	jobSpec->compareMode = compareMode;
+	jobSpec->tags = tags;
+	jobSpec->numTags = numTags;
+	compareMode = COMPARE_EXACT;
+	tags = NULL;
+	numTags = 0;
+	if (parameters->select != NULL &&
+		!test_matches(parameters->select, jobSpec)) {
+	    // The next line reuses the fields of a test that is not selected.
+	    continue;
+	}
+	fields[INPUT_FILEPATH] = program;
+	fields[numFields] = NULL;
+	jobSpec->args = fields + INPUT_FILEPATH;
+	reader->numArgs += numFields + 1;
+	numTests++;
 	
 	// Check all arguments for errors.
 	check_jobspecs(jobSpecs, jobSpecFilePath, lineNumber, numTests);
-
-	free(line);
-	free(splitLine);
-	lineNumber++;
     }
-    if (numTests == 0) {
+    parameters->numOfTests = numTests;
+    if (reader->done && reader->numListedTests == 0) {
 	fprintf(stderr, JOBSPECFILE_EMPTY_ERR_MSG, jobSpecFilePath);
 	exit(JOBSPECFILE_EMPTY_ERR);
     }
-    fclose(jobSpecFile);
-    *numOfTests = numTests;
-    return jobSpecs;
+    if (reader->done && numTests == 0) {
+	fprintf(stdout, NO_TEST_MSG);
+	exit(NO_TESTS);
+    }
+    return interrupted ? 0 : numTests - first;
 }
 
-/* add_test_args()
- * ---------------
- * Makes an array of arrays of all the command line arguments for the current
- * 	test.
+/* load_tests()
+ * ------------
+ * Loads the next batch of tests so that they can be run: reads them from the
+ * 	job specifications file, groups their invocations, and starts
+ * 	rebuilding their expected output with good-uqwordladder if it is
+ * 	missing or outdated. Batches are loaded as the tests before them are
+ * 	run, so that the first results do not wait for the whole file to be
+ * 	loaded.
  *
- * splitLine: an array of arrays from split_string() with all elements from a
- * 	line from the job specifications file.
- * program: a pointer to the name of the program to test
+ * parameters: a pointer to the struct with the opened jobspecfile, to add
+ * 	the tests to.
+ * maxTests: the largest number of tests to load.
  *
- * Returns: an array of arrays with all the command line arguments for a test
- * 	from the job specifications file.
+ * Returns: true if any tests were loaded, or false once every test has been
+ * 	loaded or if SIGINT was received.
  */
-char** add_test_args(char** splitLine, char* program) {
-    char** args = malloc(sizeof(char*));
-    
-    args[0] = strdup(program);
-
-    // Put all args into the args array to put into jobSpecs.
-    int numOfArgs = 1;
-    for (int i = 2; splitLine[i] != NULL; i++) {
-	args = realloc(args, sizeof(char*) * ++numOfArgs);
-	args[numOfArgs - 1] = strdup(splitLine[i]);
+bool load_tests(ProgramParameters* parameters, int maxTests) {
+    int first = parameters->numOfTests;
+    if (read_jobspecs(parameters, maxTests) == 0) {
+	return false;
+    }
+    group_invocations(*parameters, first);
+    // Later batches are loaded while tests run, so count towards running them.
+    if (first == 0) {
+	bench_phase_done(BENCH_PARSE, parameters->numOfTests);
     }
 
-    // Put NULL at end of args
-    args = realloc(args, sizeof(char*) * ++numOfArgs);
-    args[numOfArgs - 1] = NULL;
-    return args;
+    // Create the test directory with expected output from good-uqwordladder.
+    if (first == 0) {
+	create_testdir(*parameters);
+    }
+    create_output_files(parameters, first);
+    if (interrupted) {
+	return false;
+    }
+    load_expected_exit_statuses(*parameters, first);
+#ifdef BENCHMARK
+    // The self-benchmark build times the rebuild on its own.
+    for (int test = first; test < parameters->numOfTests; test++) {
+	wait_for_rebuild(*parameters, test);
+    }
+#endif
+    if (first == 0) {
+	bench_phase_done(BENCH_GOLDEN, parameters->numOfTests);
+    }
+    return true;
 }
 
 /* check_line_syntax()
  * -------------------
- * Checks whether each line in the job specifications file is syntactically
+ * Checks whether a line in the job specifications file is syntactically
  * 	correct.
  *
- * line: a line returned from read_line(jobspecfile) to check its syntax.
- * lineNumber: the current line number of the line that is being checked.
- * jobSpecFilePath: an array of the path to the jobspecfile given in command
- * 	line arguments.
+ * fields: an array of the tab separated fields of the line, from
+ * 	jobspec_split_fields().
+ * numFields: the number of fields in the line.
  *
- * Errors: Exits with status 16 and syntax error if the file is syntactically
- * 	incorrect.
+ * Returns: true if the line has a test ID without a forward slash and an
+ * 	input file or generator command, all non-empty, else returns false.
  */
-void check_line_syntax(char* line, int lineNumber, char* jobSpecFilePath) {
-    int lineLength = strlen(line);
-    char** splitLine = split_string(line, '\t');
-
+bool check_line_syntax(char** fields, int numFields) {
     // First checks if there are no tab spaces, then if first character is tab
-    // space, then if remainder of line is empty, then if inputfile is empty,
-    // and checks if test id syntax is correct.
-    if (lineLength == strlen(splitLine[0]) ||
-	    strcmp(splitLine[0], "\0") == 0 ||
-	    splitLine[1] == NULL ||
-	    !strlen(splitLine[INPUT_FILEPATH]) ||
-	    check_test_id_syntax(splitLine[TEST_ID])) {
-	free(line);
-	free(splitLine);
-	fprintf(stderr, JOBSPECFILE_SYNTAX_ERR_MSG, lineNumber,
-		jobSpecFilePath);
-	exit(JOBSPECFILE_SYNTAX_ERR);
-    }
-    free(line);
-    free(splitLine);
+    // space, then if inputfile is empty, and checks if test id syntax is
+    // correct.
+    return numFields > INPUT_FILEPATH &&
+	    fields[TEST_ID][0] != '\0' &&
+	    fields[INPUT_FILEPATH][0] != '\0' &&
+	    (fields[INPUT_FILEPATH][0] != GENERATOR_PREFIX ||
+	    fields[INPUT_FILEPATH][1] != '\0') &&
+	    !check_test_id_syntax(fields[TEST_ID]);
 }
 
-/* check_test_id_syntax()
- * ----------------------
- * Checks if the specified testID contains any forward slash.
+/* parse_annotation()
+ * ------------------
+ * Reads the options in an annotation line of the job specifications file,
+ * 	which apply to the next test. An annotation is "#@" followed by
+ * 	space or tab separated options of the form key=value, such as
+ * 	"compare=lines" or "tags=perf,long". Words that are not options with
+ * 	a known key are ignored.
  *
- * testID: a pointer to an array of the first element from split_string()
- * 	when it is used in check_line_syntax()
+ * line: a line returned from jobspec_next_line() starting with "#@", which
+ * 	is split in place.
+ * compareMode: a pointer to store the comparison mode of the next test in.
+ * tags: a pointer to store a pointer to the tags of the next test in.
+ * numTags: a pointer to store the number of tags of the next test in.
  *
- * Returns: true if the testID contains a forward slash character, else
- * 	returns false.
+ * Returns: true if the value of every known option is valid, else returns
+ * 	false.
  */
-bool check_test_id_syntax(char* testID) {
-    int length = strlen(testID);
-    for (int i = 0; i < length; i++) {
-	if (testID[i] == '/') {
-	    return true;
+bool parse_annotation(char* line, enum CompareMode* compareMode,
+	char** tags, int* numTags) {
+    char* options = line + strlen(ANNOTATION_PREFIX);
+    bool valid = true;
+    char* savePtr;
+    for (char* option = strtok_r(options, ANNOTATION_SEPARATORS, &savePtr);
+	    option != NULL && valid;
+	    option = strtok_r(NULL, ANNOTATION_SEPARATORS, &savePtr)) {
+	// Other text is left alone, as "#@" lines used to be plain comments.
+	char* value = strchr(option, '=');
+	if (value == NULL) {
+	    continue;
+	}
+	*value++ = '\0';
+	if (strcmp(option, COMPARE_OPTION) == 0) {
+	    valid = parse_compare_mode(value, compareMode);
+	} else if (strcmp(option, TAGS_OPTION) == 0) {
+	    *tags = value;
+	    valid = parse_tags(value, numTags);
 	}
     }
-    return false;
+    return valid;
 }
 
-/* check_jobspecs()
- * ----------------
- * After the file has been checked for syntax error, this function conducts
- * 	further tests to validate the job specification file. This function
- * 	is used in open_jobspecfile() when it is being checked for validity.
+/* parse_tags()
+ * ------------
+ * Splits the comma separated tags of a test in place, so that they are
+ * 	consecutive null terminated strings.
+ *
+ * value: a pointer to the array with the value of a "tags" option.
+ * numTags: a pointer to store the number of tags in.
+ *
+ * Returns: true if every tag is non-empty, else returns false.
+ */
+bool parse_tags(char* value, int* numTags) {
+    *numTags = 1;
+    if (*value == '\0') {
+	return false;
+    }
+    for (char* c = value; *c != '\0'; c++) {
+	if (*c != TAG_SEPARATOR) {
+	    continue;
+	}
+	if (c[1] == '\0' || c[1] == TAG_SEPARATOR) {
+	    return false;
+	}
+	*c = '\0';
+	(*numTags)++;
+    }
+    return true;
+}
+
+/* check_test_id_syntax()
+ * ----------------------
+ * Checks if the specified testID contains any forward slash.
+ *
+ * testID: a pointer to an array of the first field of a line from the job
+ * 	specifications file.
+ *
+ * Returns: true if the testID contains a forward slash character, else
+ * 	returns false.
+ */
+bool check_test_id_syntax(char* testID) {
+    int length = strlen(testID);
+    for (int i = 0; i < length; i++) {
+	if (testID[i] == '/') {
+	    return true;
+	}
+    }
+    return false;
+}
+
+/* check_jobspecs()
+ * ----------------
+ * After the file has been checked for syntax error and duplicate test IDs,
+ * 	this function conducts further tests to validate the job specification
+ * 	file. This function is used in open_jobspecfile() when it is being
+ * 	checked for validity.
  *
  * jobSpecs: a pointer to an array of structs containing information on the 
  * 	tests specified in the jobspecfile.
@@ -594,37 +1656,111 @@ bool check_test_id_syntax(char* testID) {
  * lineNumber: the current line number of the line that is being checked.
  * numofTests: the number of tests in jobSpecs.
  *
- * Errors: Exits with status 6 and duplicate test-ID error if the test-ID of
- * 	the current line is the same as any of the previous test-IDs.
- * 	Exits with status 19 and inputfile error if the specified input file
- * 	path in the current line cannot be opened.
+ * Errors: Exits with status 19 and inputfile error if the specified input
+ * 	file path in the current line cannot be opened. A generator command is
+ * 	not run until the test is.
  */
 void check_jobspecs(JobSpecs* jobSpecs, char* jobSpecFilePath, 
 	int lineNumber, int numOfTests) {
-    // Check for any repeated test IDs
-    char* testID = strdup(jobSpecs[numOfTests - 1].testID);
-    for (int i = 0; i < numOfTests - 1; i++) {
-	if (strcmp(testID, jobSpecs[i].testID) == 0) {
-	    fprintf(stderr, JOBSPECFILE_DUP_ERR_MSG, lineNumber,
-		    jobSpecFilePath);
-	    free(testID);
-	    exit(JOBSPECFILE_DUP_ERR);
-	}
-    }
-    free(testID);
-
     // Check if the "inputfile" can be opened.
-    char* inputFilePath = strdup(jobSpecs[numOfTests - 1].inputFile);
-    FILE* inputFile = fopen(inputFilePath, "r");
-    if (inputFile == NULL) {
+    char* inputFilePath = jobSpecs[numOfTests - 1].inputFile;
+    if (is_generator(&jobSpecs[numOfTests - 1])) {
+	return;
+    }
+    int inputFile = open(inputFilePath, O_RDONLY);
+    if (inputFile == -1) {
 	fprintf(stderr, INPUTFILE_OPEN_ERR_MSG, inputFilePath, lineNumber,
 		jobSpecFilePath);
-	free(inputFilePath);
 	exit(INPUTFILE_OPEN_ERR);
     }
-    free(inputFilePath);
-    fclose(inputFile);
+    close(inputFile);
+
+}
+
+/* group_invocations()
+ * -------------------
+ * Finds tests that run the program with identical arguments and input file,
+ * 	and compare its output in the same way, so that each unique invocation
+ * 	only needs to be run once. Sets the
+ * 	invocation of each test to the index of the first test with the same
+ * 	arguments and input file, which is its own index if it is unique.
+ * 	The first test of an invocation is always loaded before the others.
+ *
+ * parameters: the parameters from the command line arguments, including the
+ * 	data structure with all tests from jobSpecFile.
+ * first: the index of the first test to group, as earlier ones are grouped.
+ *
+ * Returns: void
+ */
+void group_invocations(ProgramParameters parameters, int first) {
+    JobSpecs* jobSpecs = parameters.jobSpecs;
+    int numOfTests = parameters.numOfTests;
+    int* table = parameters.reader.invocationTable;
+    unsigned int tableSize = parameters.reader.tableSize;
+
+    for (int test = first; test < numOfTests; test++) {
+	unsigned int slot = hash_invocation(&jobSpecs[test]) & (tableSize - 1);
+	while (table[slot] != -1 &&
+		!same_invocation(&jobSpecs[table[slot]], &jobSpecs[test])) {
+	    slot = (slot + 1) & (tableSize - 1);
+	}
+	if (table[slot] == -1) {
+	    table[slot] = test;
+	}
+	jobSpecs[test].invocation = table[slot];
+    }
+}
+
+/* hash_invocation()
+ * -----------------
+ * Hashes the input file, command line arguments and comparison mode of a
+ * 	test, excluding the program name.
+ *
+ * jobSpec: a pointer to the struct of the test to hash.
+ *
+ * Returns: the FNV-1a hash of the test's invocation.
+ */
+unsigned int hash_invocation(JobSpecs* jobSpec) {
+    unsigned int hash = (FNV_OFFSET ^ jobSpec->compareMode) * FNV_PRIME;
+    for (char* c = jobSpec->inputFile; ; c++) {
+	hash = (hash ^ (unsigned char) *c) * FNV_PRIME;
+	if (*c == '\0') {
+	    break;
+	}
+    }
+    for (int i = 1; jobSpec->args[i] != NULL; i++) {
+	for (char* c = jobSpec->args[i]; ; c++) {
+	    hash = (hash ^ (unsigned char) *c) * FNV_PRIME;
+	    if (*c == '\0') {
+		break;
+	    }
+	}
+    }
+    return hash;
+}
 
+/* same_invocation()
+ * -----------------
+ * Checks if two tests have the same input file, command line arguments and
+ * 	comparison mode.
+ *
+ * first: a pointer to the struct of the first test.
+ * second: a pointer to the struct of the second test.
+ *
+ * Returns: true if the tests run the program identically, else false.
+ */
+bool same_invocation(JobSpecs* first, JobSpecs* second) {
+    if (first->compareMode != second->compareMode ||
+	    strcmp(first->inputFile, second->inputFile) != 0) {
+	return false;
+    }
+    int i;
+    for (i = 1; first->args[i] != NULL && second->args[i] != NULL; i++) {
+	if (strcmp(first->args[i], second->args[i]) != 0) {
+	    return false;
+	}
+    }
+    return first->args[i] == second->args[i];
 }
 
 /* create_testdir()
@@ -649,107 +1785,178 @@ void create_testdir(ProgramParameters parameters) {
 
 /* get_filepath()
  * --------------
- * Generates and makes the filepath for the file with specified testID with
- * 	specified type.
+ * Makes the filepath of an output file, in the form testDir/testID.type.
  *
+ * filePath: a pointer to the array to store the filepath in, or NULL to only
+ * 	get its length.
  * testDir: the test directory specified by the user in the command line
  * 	arguments.
  * type: the type of the file to be created, which can be either '.stdout',
  * 	'.stderr', or '.exitstatus'.
  * testID: the name of test for the file to be created.
  * 
- * Returns: a pointer to a dynamically allocated array with the filepath to
- * 	the file to be created for the specified testID and type.
+ * Returns: the number of characters in the filepath, including the null
+ * 	terminator.
  */
-char* get_filepath(char* testDir, char* type, char* testID) {
-    // Initialise dynamically allocated array to store filepath in.
+int get_filepath(char* filePath, char* testDir, char* type, char* testID) {
     int testDirLength = strlen(testDir);
     int testIDLength = strlen(testID);
     int typeLength = strlen(type);
-    int totalLength = testIDLength + testDirLength + typeLength + 1;
-    char* filePath = malloc(sizeof(char) * (totalLength + 1));
-
-    // Add test directory path to filepath.
-    int length = testDirLength;
-    for (int j = 0; j < length; j++) {
-	filePath[j] = testDir[j];
+    int totalLength = testDirLength + 1 + testIDLength + typeLength + 1;
+    if (filePath == NULL) {
+	return totalLength;
     }
 
-    // Add slash to filepath.
-    length++;
-    filePath[length - 1] = '/';
-
-    // Add testID to filepath
-    length += testIDLength;
-    for (int j = length - testIDLength; j < length; j++) {
-	filePath[j] = testID[j - testDirLength - 1];
-    }
-    
-    // Add type of file to end of filepath
-    length += typeLength;
-    for (int j = length - typeLength; j < length; j++) {
-	filePath[j] = type[j - 1 - testIDLength - testDirLength];
-    }
-    filePath[length] = '\0';
-    return filePath;
+    // Add test directory path, a slash, testID and type to filepath.
+    memcpy(filePath, testDir, testDirLength);
+    filePath[testDirLength] = '/';
+    memcpy(filePath + testDirLength + 1, testID, testIDLength);
+    memcpy(filePath + testDirLength + 1 + testIDLength, type, typeLength + 1);
+    return totalLength;
 }
 
 /* create_output_files()
  * ---------------------
  * Creates the output files for each test in the job specifications file.
+ * 	The modification times of all output files are read, and the files of
+ * 	outdated tests created, in batches rather than one file at a time.
+ * 	The expected output of outdated tests is then rebuilt in the
+ * 	background, while tests whose output is up to date can be run.
+ * 	The filepaths are all made once here, in a single pool, so that
+ * 	running tests does not need to make any.
  *
- * parameters: the parameters from the command line arguments, including the
- * 	data structure with all tests from jobSpecFile.
+ * parameters: a pointer to the parameters from the command line arguments,
+ * 	including the data structure with all tests from jobSpecFile.
+ * first: the index of the first test whose files to create, as earlier ones
+ * 	have theirs already.
  *
  * Returns: void
+ * Errors: Exits with status 6 and output file error if an output file cannot
+ * 	be created, or if the job specifications file's stats cannot be read.
  */
-void create_output_files(ProgramParameters parameters) {
-    int numOfTests = parameters.numOfTests;
-    JobSpecs* jobSpecs = parameters.jobSpecs;
-    char* testDir = parameters.testDir;
-    char* jobSpecFilePath = parameters.jobSpecFilePath;
-    char* type[NUM_OF_TYPES] = {STDOUT_TYPE, STDERR_TYPE, EXITSTATUS_TYPE};
+void create_output_files(ProgramParameters* parameters, int first) {
+    int numOfTests = parameters->numOfTests - first;
+    JobSpecs* jobSpecs = parameters->jobSpecs + first;
+    char* testDir = parameters->testDir;
 
-    bool jobSpecModified = false;
-    bool runGoodUQWordLadder = false;
-    // Iterate through all tests and types and make the required files
+    // Make the filepaths of all output files.
+    char* filePath = parameters->pathPool + parameters->reader.pathPoolUsed;
     for (int test = 0; test < numOfTests; test++) {
-	bool recreateFiles = false;
-	int printMsg = 0;
 	for (int i = 0; i < NUM_OF_TYPES; i++) {
-	    char* testID = strdup(jobSpecs[test].testID);
-	    char* filePath = get_filepath(testDir, type[i], testID);
-
-	    store_output_filepath(parameters, filePath, i, test);
-	    
-	    // Make output files if they are missing, or if jobSpecFile was
-	    // modified after output files were created.
-	    int outputFile = open(filePath, O_WRONLY);
-	    if (outputFile != -1) {
-		jobSpecModified = 
-		    check_modification_time(filePath, jobSpecFilePath);
+	    store_output_filepath(*parameters, filePath, i, first + test);
+	    filePath += get_filepath(filePath, testDir, (char*) outputTypes[i],
+		    jobSpecs[test].testID);
+	}
+	jobSpecs[test].rebuilding = false;
+    }
+    parameters->reader.pathPoolUsed = filePath - parameters->pathPool;
+
+    struct stat jobSpec;
+    if (stat(parameters->jobSpecFilePath, &jobSpec) == -1) {
+	fprintf(stderr, OUTPUT_FILE_ERR_MSG, jobSpecs[0].outputFile);
+	exit(OUTPUT_FILE_ERR);
+    }
+
+    for (int start = 0; start < numOfTests; start += PIPELINE_MAX_BATCH) {
+	int numChunk = numOfTests - start < PIPELINE_MAX_BATCH ?
+		numOfTests - start : PIPELINE_MAX_BATCH;
+	int staleTests[PIPELINE_MAX_BATCH];
+	int numStaleTests = find_stale_tests(parameters, jobSpecs + start,
+		numChunk, jobSpec.st_mtim, staleTests);
+	char* stalePaths[PIPELINE_MAX_BATCH * NUM_OF_TYPES];
+	for (int i = 0; i < numStaleTests; i++) {
+	    JobSpecs* stale = &jobSpecs[start + staleTests[i]];
+	    stalePaths[i * NUM_OF_TYPES] = stale->outputFile;
+	    stalePaths[i * NUM_OF_TYPES + 1] = stale->errorFile;
+	    stalePaths[i * NUM_OF_TYPES + 2] = stale->exitStatusFile;
+	}
+	int failed = gio_create_files(stalePaths,
+		numStaleTests * NUM_OF_TYPES);
+
+	// Report each rebuilt test, up to the first whose files were not
+	// created.
+	for (int i = 0; i < numStaleTests; i++) {
+	    JobSpecs* stale = &jobSpecs[start + staleTests[i]];
+	    fprintf(stdout, REBUILD_MSG, stale->testID);
+	    if (failed != -1 && failed / NUM_OF_TYPES == i) {
+		fprintf(stderr, OUTPUT_FILE_ERR_MSG, stalePaths[failed]);
+		exit(OUTPUT_FILE_ERR);
 	    }
-	    if (recreateFiles || outputFile == -1 || jobSpecModified ||
-		    parameters.recreate) {
-		runGoodUQWordLadder = true;
+	    stale->rebuilding = true;
+	}
+    }
+
+    // Tests sharing the invocation of a rebuilt test get a link to its
+    // output once it has been rebuilt.
+    for (int test = 0; test < numOfTests; test++) {
+	jobSpecs[test].rebuilding |=
+		parameters->jobSpecs[jobSpecs[test].invocation].rebuilding;
+    }
+    schedule_rebuilds(*parameters);
+}
+
+/* find_stale_tests()
+ * ------------------
+ * Finds the tests of a chunk of at most PIPELINE_MAX_BATCH tests whose output
+ * 	files need to be made again, reading the modification times of all of
+ * 	their output files in one batch. The key of each outdated generator
+ * 	test is written before its output is rebuilt, and the output is
+ * 	removed if the rebuild does not finish.
+ *
+ * parameters: a pointer to the parameters from the command line arguments.
+ * jobSpecs: a pointer to the first test of the chunk.
+ * numOfTests: the number of tests in the chunk.
+ * jobSpecMtime: the modification time of the job specifications file.
+ * staleTests: a pointer to the array to store the index in the chunk of each
+ * 	outdated test in.
+ *
+ * Returns: the number of outdated tests.
+ * Errors: Exits with status 6 and output file error if the key of a generator
+ * 	test cannot be written.
+ */
+int find_stale_tests(ProgramParameters* parameters, JobSpecs* jobSpecs,
+	int numOfTests, struct timespec jobSpecMtime, int* staleTests) {
+    char* filePaths[PIPELINE_MAX_BATCH * NUM_OF_TYPES];
+    for (int test = 0; test < numOfTests; test++) {
+	filePaths[test * NUM_OF_TYPES] = jobSpecs[test].outputFile;
+	filePaths[test * NUM_OF_TYPES + 1] = jobSpecs[test].errorFile;
+	filePaths[test * NUM_OF_TYPES + 2] = jobSpecs[test].exitStatusFile;
+    }
+    struct timespec mtimes[PIPELINE_MAX_BATCH * NUM_OF_TYPES];
+    bool exists[PIPELINE_MAX_BATCH * NUM_OF_TYPES];
+    gio_stat_mtimes(filePaths, numOfTests * NUM_OF_TYPES, mtimes, exists);
+
+    // Make output files again for tests if any are missing, or if jobSpecFile
+    // was modified after output files were created. The output of a generator
+    // test is instead made again if its command or arguments changed, so that
+    // editing other lines does not generate its input again.
+    int numStaleTests = 0;
+    for (int test = 0; test < numOfTests; test++) {
+	bool recreateFiles = parameters->recreate;
+	char keyPath[PATH_MAX];
+	char* key = NULL;
+	if (is_generator(&jobSpecs[test])) {
+	    get_filepath(keyPath, parameters->testDir, GENERATOR_TYPE,
+		    jobSpecs[test].testID);
+	    key = parameters->keyPool;
+	    make_generator_key(&jobSpecs[test], key);
+	    recreateFiles |= !check_generator_key(keyPath, key);
+	}
+	for (int file = test * NUM_OF_TYPES; file < (test + 1) * NUM_OF_TYPES;
+		file++) {
+	    if (!exists[file] || (key == NULL &&
+		    check_modification_time(mtimes[file], jobSpecMtime))) {
 		recreateFiles = true;
-		close(outputFile);
-		printMsg++;
-		if (printMsg == 1) {
-		    fprintf(stdout, REBUILD_MSG, testID);
-		}
-		int create = open(filePath, O_WRONLY | O_CREAT | O_TRUNC,
-			S_IRUSR | S_IWUSR);
-		check_output_file(create, filePath);
-		close(create);
 	    }
-	    free(testID);
-	    free(filePath);
+	}
+	if (key != NULL && recreateFiles) {
+	    write_generator_key(keyPath, key);
+	}
+	if (recreateFiles) {
+	    staleTests[numStaleTests++] = test;
 	}
     }
-    if (runGoodUQWordLadder) {
-	run_gooduqwordladder(parameters);
-    }
+    return numStaleTests;
 }
 
 /* store_output_filepath()
@@ -758,7 +1965,7 @@ void create_output_files(ProgramParameters parameters) {
  *
  * parameters: a struct containing the program's main parameters including
  * 	the jobSpecs data struct.
- * filePath: a pointer to the array with the filePath made in get_filepath().
+ * filePath: a pointer to the array for the filePath made in get_filepath().
  * typeNum: the index of the type from the 'type' array in
  * 	create_output_files().
  * testNum: the current test number to store the filePath into.
@@ -770,13 +1977,13 @@ void store_output_filepath(ProgramParameters parameters, char* filePath,
     // Store filePath to corresponding testID for future reference.
     switch (typeNum) {
 	case 0:
-	    parameters.jobSpecs[testNum].outputFile = strdup(filePath);
+	    parameters.jobSpecs[testNum].outputFile = filePath;
 	    break;
 	case 1:
-	    parameters.jobSpecs[testNum].errorFile = strdup(filePath);
+	    parameters.jobSpecs[testNum].errorFile = filePath;
 	    break;
 	case 2:
-	    parameters.jobSpecs[testNum].exitStatusFile = strdup(filePath);
+	    parameters.jobSpecs[testNum].exitStatusFile = filePath;
 	    break;
     }
 }
@@ -805,152 +2012,2401 @@ void check_output_file(int fd, char* filePath) {
  * Checks if the last modification time of the output file was before the
  * 	the last modification time of the job specifications file.
  *
- * outputFilePath: a pointer to an array with filePath from get_filePath().
- * jobSpecFilePath: a pointer to an array with job specifications filepath
- * 	from the ProgramParameters struct.
+ * outputMtime: the last modification time of the output file.
+ * jobSpecMtime: the last modification time of the job specifications file.
  *
  * Returns: true if the jobSpecFile was modified after the last modification
- * 	time of any output file, else returns false.
- * Errors: Exits with status 6 and output file error if the file's stats
- * 	cannot be read.
+ * 	time of the output file, else returns false.
  */
-bool check_modification_time(char* outputFilePath, char* jobSpecFilePath) {
-    // Initialise struct for stat
-    struct stat output;
-    struct stat jobSpec;
-    if (stat(outputFilePath, &output) == -1 || 
-	    stat(jobSpecFilePath, &jobSpec) == -1) {
-	fprintf(stderr, OUTPUT_FILE_ERR_MSG, outputFilePath);
-	exit(OUTPUT_FILE_ERR);
+bool check_modification_time(struct timespec outputMtime,
+	struct timespec jobSpecMtime) {
+    // Compare the times of last modification
+    return outputMtime.tv_sec < jobSpecMtime.tv_sec ||
+	    (outputMtime.tv_sec == jobSpecMtime.tv_sec &&
+	    outputMtime.tv_nsec < jobSpecMtime.tv_nsec);
+}
+
+/* schedule_rebuilds()
+ * -------------------
+ * Adds the tests loaded so far to the expected output being rebuilt, and
+ * 	starts rebuilding that of any outdated tests.
+ *
+ * parameters: a struct containing the program's main parameters including
+ * 	the jobSpecs data struct.
+ *
+ * Returns: void
+ */
+void schedule_rebuilds(ProgramParameters parameters) {
+    rebuilds.readAhead = false;
+    for (int test = rebuilds.numOfTests; test < parameters.numOfTests;
+	    test++) {
+	rebuilds.readAhead |= parameters.jobSpecs[test].rebuilding;
     }
-    
-    // Get the time of last modification and compare them
-    int timeDiff = compare_timespecs(output.st_mtim, jobSpec.st_mtim);
-    if (timeDiff < 0) {
+    rebuilds.jobSpecs = parameters.jobSpecs;
+    rebuilds.numOfTests = parameters.numOfTests;
+    rebuilds.compress = parameters.compress;
+    rebuilds.testDir = parameters.testDir;
+    rebuilds.timeoutFactor = parameters.timeoutFactor;
+    rebuilds.timeoutFloor = parameters.timeoutFloor;
+    start_rebuilds();
+}
+
+/* start_rebuilds()
+ * ----------------
+ * Runs good-uqwordladder for the next tests whose expected output is being
+ * 	rebuilt, in the order they were loaded, so that at most
+ * 	MAX_GOLDEN_PROCESSES are running. Only the first test of each
+ * 	invocation is run.
+ *
+ * Returns: void
+ */
+void start_rebuilds(void) {
+    while (!interrupted && rebuilds.numRunning < MAX_GOLDEN_PROCESSES &&
+	    rebuilds.nextTest < rebuilds.numOfTests) {
+	int test = rebuilds.nextTest++;
+	JobSpecs* jobSpec = &rebuilds.jobSpecs[test];
+	if (!jobSpec->rebuilding || jobSpec->invocation != test) {
+	    continue;
+	}
+	RebuildRun* run = &rebuilds.runs[rebuilds.numRunning];
+	clock_gettime(CLOCK_MONOTONIC, &run->started);
+	run->test = test;
+	run->reaped = false;
+	run->generatorFailed = false;
+	run->compressor = 0;
+	run->pid = start_gooduqwordladder(jobSpec, &run->generator);
+	if (run->pid > 0) {
+	    rebuilds.numRunning++;
+	} else {
+	    set_expected_exit_status(jobSpec, "", rebuilds.timeoutFactor,
+		    rebuilds.timeoutFloor);
+	    jobSpec->rebuilding = false;
+	}
+    }
+}
+
+/* finish_rebuild()
+ * ----------------
+ * Records a reaped child process if it was rebuilding expected output, or
+ * 	generating the input of a rebuild, and completes the rebuild once
+ * 	both good-uqwordladder and the generator have been reaped. When
+ * 	compressing, the output of a good-uqwordladder that exited is then
+ * 	compressed first, after its run time and peak memory were taken.
+ *
+ * pid: the pid of the reaped child process.
+ * status: the wait status of the process.
+ * usage: a pointer to the resources used by the process.
+ *
+ * Returns: true if the process was part of a rebuild, else returns false.
+ */
+bool finish_rebuild(pid_t pid, int status, struct rusage* usage) {
+    for (int i = 0; i < rebuilds.numRunning; i++) {
+	RebuildRun* run = &rebuilds.runs[i];
+	if (run->generator == pid) {
+	    run->generator = 0;
+	    run->generatorFailed = generator_failed(status);
+	} else if (run->compressor == pid) {
+	    run->compressor = 0;
+	    complete_rebuild(i);
+	    return true;
+	} else if (run->pid == pid && !run->reaped) {
+	    run->reaped = true;
+	    run->status = status;
+	    run->runTime = (long) (seconds_since(&run->started) * 1000000);
+	    run->maxRss = usage->ru_maxrss;
+	} else {
+	    continue;
+	}
+	if (!run->reaped || run->generator != 0) {
+	    return true;
+	}
+	if (rebuilds.compress && WIFEXITED(run->status) &&
+		!run->generatorFailed) {
+	    run->compressor = start_compressor(
+		    &rebuilds.jobSpecs[run->test]);
+	}
+	if (run->compressor <= 0) {
+	    run->compressor = 0;
+	    complete_rebuild(i);
+	}
 	return true;
     }
     return false;
 }
 
-/* run_gooduqwordladder()
- * ----------------------
- * Runs the tests in job specifications file with good-uqwordladder and puts
- * 	the output in the corresponding files in the test directory.
+/* complete_rebuild()
+ * ------------------
+ * Completes the expected output of a test whose rebuild has finished, by
+ * 	queueing the exit status, run time and peak memory of
+ * 	good-uqwordladder to be written to the test's .exitstatus file, and
+ * 	starts the next rebuild in its place. If the generator of its input
+ * 	failed, nothing is written, and its key is removed so that the
+ * 	output is rebuilt on the next run.
+ *
+ * run: the index of the rebuild in the running rebuilds.
+ *
+ * Returns: void
+ */
+void complete_rebuild(int run) {
+    RebuildRun* rebuild = &rebuilds.runs[run];
+    JobSpecs* jobSpec = &rebuilds.jobSpecs[rebuild->test];
+    char* text = "";
+    if (rebuild->generatorFailed) {
+	fprintf(stderr, GENERATOR_REBUILD_ERR_MSG, jobSpec->testID);
+	char keyPath[PATH_MAX];
+	get_filepath(keyPath, rebuilds.testDir, GENERATOR_TYPE,
+		jobSpec->testID);
+	unlink(keyPath);
+    } else if (WIFEXITED(rebuild->status)) {
+	if (rebuilds.numStatuses == MAX_GOLDEN_PROCESSES) {
+	    flush_rebuild_statuses();
+	}
+	rebuilds.statusesOwner = getpid();
+	rebuilds.statusPaths[rebuilds.numStatuses] = jobSpec->exitStatusFile;
+	text = rebuilds.statuses[rebuilds.numStatuses++];
+	sprintf(text, "%d\n%ld\n%ld\n", WEXITSTATUS(rebuild->status),
+		rebuild->runTime, rebuild->maxRss);
+    }
+    set_expected_exit_status(jobSpec, text, rebuilds.timeoutFactor,
+	    rebuilds.timeoutFloor);
+    jobSpec->rebuilding = false;
+
+    rebuilds.numRunning--;
+    *rebuild = rebuilds.runs[rebuilds.numRunning];
+    start_rebuilds();
+}
+
+/* wait_for_rebuild()
+ * ------------------
+ * Waits until the expected output of a test has been rebuilt, if it is being
+ * 	rebuilt, while the rebuilds of other tests go on. A test sharing the
+ * 	invocation of another then gets a link to its output.
  *
  * parameters: a struct containing the program's main parameters including
  * 	the jobSpecs data struct.
+ * testNum: the 'n'th test to wait for.
+ *
+ * Returns: void, as soon as SIGINT is received.
+ */
+void wait_for_rebuild(ProgramParameters parameters, int testNum) {
+    JobSpecs* jobSpec = &parameters.jobSpecs[testNum];
+    JobSpecs* first = &parameters.jobSpecs[jobSpec->invocation];
+    while (first->rebuilding && !interrupted) {
+	start_rebuilds();
+	int status;
+	struct rusage usage;
+	pid_t finished = wait_for_test_child(&status, NULL, &usage);
+	if (finished < 0) {
+	    break;
+	}
+	finish_rebuild(finished, status, &usage);
+    }
+    if (first == jobSpec || !jobSpec->rebuilding || first->rebuilding) {
+	return;
+    }
+    // A copy of the .exitstatus file needs its contents written first.
+    flush_rebuild_statuses();
+    link_output_file(first->outputFile, jobSpec->outputFile);
+    link_output_file(first->errorFile, jobSpec->errorFile);
+    link_output_file(first->exitStatusFile, jobSpec->exitStatusFile);
+    jobSpec->expectedExitStatus = first->expectedExitStatus;
+    jobSpec->goldenTime = first->goldenTime;
+    jobSpec->goldenRss = first->goldenRss;
+    jobSpec->timeout = first->timeout;
+    jobSpec->rebuilding = false;
+}
+
+/* wait_for_rebuilds()
+ * -------------------
+ * Waits until every rebuild of expected output has finished, including those
+ * 	waiting to start.
+ *
+ * Returns: void, as soon as SIGINT is received.
+ */
+void wait_for_rebuilds(void) {
+    start_rebuilds();
+    while (rebuilds.numRunning > 0 && !interrupted) {
+	int status;
+	struct rusage usage;
+	pid_t finished = wait_for_test_child(&status, NULL, &usage);
+	if (finished < 0) {
+	    break;
+	}
+	finish_rebuild(finished, status, &usage);
+    }
+}
+
+/* flush_rebuild_statuses()
+ * ------------------------
+ * Writes the queued exit statuses of finished rebuilds to their .exitstatus
+ * 	files in one batch. A forked child drops the statuses queued by its
+ * 	parent instead, as the parent writes them.
  *
  * Returns: void
  */
-void run_gooduqwordladder(ProgramParameters parameters) {
-    JobSpecs* jobSpecs = parameters.jobSpecs;
-    int numOfTests = parameters.numOfTests;
+void flush_rebuild_statuses(void) {
+    if (rebuilds.numStatuses > 0 && rebuilds.statusesOwner == getpid()) {
+	char* contents[MAX_GOLDEN_PROCESSES];
+	for (int i = 0; i < rebuilds.numStatuses; i++) {
+	    contents[i] = rebuilds.statuses[i];
+	}
+	gio_write_files(rebuilds.statusPaths, contents, rebuilds.numStatuses);
+    }
+    rebuilds.numStatuses = 0;
+}
 
-    // Create child processes for each test to be run on command line.
-    pid_t pid[numOfTests];
-    for (int test = 0; test < numOfTests; test++) {
-	fflush(stdout);
-	pid[test] = fork();
-	if (pid[test] == 0) {
-	    jobSpecs[test].args[0] = strdup(GOOD_UQWORDLADDER);
-
-	    // Open corresponding output files and redirect to them.
-	    int in = open(jobSpecs[test].inputFile, O_RDONLY);
-	    int out = open(jobSpecs[test].outputFile, O_WRONLY | O_TRUNC);
-	    int err = open(jobSpecs[test].errorFile, O_WRONLY | O_TRUNC);
-	    dup2(in, STDIN_FILENO);
-	    dup2(out, STDOUT_FILENO);
-	    dup2(err, STDERR_FILENO);
-	    close(in);
-	    close(out);
-	    close(err);
-	    execvp(jobSpecs[test].args[0], jobSpecs[test].args);
-	    exit(99);
-	}
-    }
-
-    // Get exit status for each child process in same order as above, and
-    // store it in corresponding .exitstatus file.
-    int status;
-    for (int test = 0; test < numOfTests; test++) {
-	waitpid(pid[test], &status, 0);
-	if (WIFEXITED(status)) {
-	    int exitStatus = open(jobSpecs[test].exitStatusFile,
-		    O_WRONLY | O_TRUNC);
-	    char buffer[EXITSTATUS_BUFFER];
-	    sprintf(buffer, "%d\n", WEXITSTATUS(status));
-	    write(exitStatus, buffer, strlen(buffer));
-	    close(exitStatus);
+/* cancel_rebuilds()
+ * -----------------
+ * Writes the exit statuses of the rebuilds that finished, then kills the
+ * 	good-uqwordladder processes still rebuilding expected output when the
+ * 	program exits, and removes the output files of every test whose
+ * 	expected output was not rebuilt, so that it is rebuilt on the next
+ * 	run. Only the process that started the rebuilds does this, not any
+ * 	child process that exits.
+ *
+ * Returns: void
+ */
+void cancel_rebuilds(void) {
+    flush_rebuild_statuses();
+    if (getpid() != rebuilds.owner) {
+	return;
+    }
+    // Killing the process group of good-uqwordladder kills its generator
+    // too, even once good-uqwordladder has been reaped.
+    pid_t pid[MAX_GOLDEN_PROCESSES];
+    for (int i = 0; i < rebuilds.numRunning; i++) {
+	RebuildRun* run = &rebuilds.runs[i];
+	pid[i] = run->compressor > 0 ? run->compressor : run->pid;
+    }
+    kill_processes(pid, rebuilds.numRunning, NULL);
+    rebuilds.numRunning = 0;
+    for (int test = 0; test < rebuilds.numOfTests; test++) {
+	JobSpecs* jobSpec = &rebuilds.jobSpecs[test];
+	if (jobSpec->rebuilding) {
+	    unlink(jobSpec->outputFile);
+	    unlink(jobSpec->errorFile);
+	    unlink(jobSpec->exitStatusFile);
+	}
+    }
+}
+
+/* fork_process()
+ * --------------
+ * Creates a child process in a new process group of its own, so that it can
+ * 	be killed together with any processes it starts. Both processes set
+ * 	the group, so it is in place before either of them continues.
+ *
+ * Returns: the pid of the child process to the parent, 0 to the child, or -1
+ * 	if the process could not be created.
+ */
+pid_t fork_process(void) {
+    pid_t pid = fork();
+    if (pid >= 0) {
+	setpgid(pid, pid == 0 ? 0 : pid);
+    }
+    return pid;
+}
+
+/* fork_counted_process()
+ * ----------------------
+ * Creates a child process like fork_process(), with hardware counters
+ * 	attached to it that start counting when it calls exec. The child
+ * 	waits for the counters to be attached before continuing.
+ *
+ * counters: a pointer to the struct to store the counters in.
+ *
+ * Returns: the pid of the child process to the parent, 0 to the child, or -1
+ * 	if the process could not be created.
+ */
+pid_t fork_counted_process(PerfCounters* counters) {
+    int ready[2];
+    if (pipe(ready) == -1) {
+	perf_attach(counters, -1);
+	return fork_process();
+    }
+    pid_t pid = fork_process();
+    if (pid == 0) {
+	// Wait until the parent closes its end of the pipe.
+	char byte;
+	close(ready[WRITE_END]);
+	while (read(ready[READ_END], &byte, 1) == -1 && errno == EINTR) {
+	}
+	close(ready[READ_END]);
+	return 0;
+    }
+    close(ready[READ_END]);
+    perf_attach(counters, pid);
+    close(ready[WRITE_END]);
+    return pid;
+}
+
+/* start_gooduqwordladder()
+ * ------------------------
+ * Creates a child process that runs good-uqwordladder for a test, with its
+ * 	stdout and stderr redirected to the test's output files, and the
+ * 	generator of its input in the same process group. The child is
+ * 	good-uqwordladder itself, so that its run time and resources are
+ * 	those of good-uqwordladder alone.
+ *
+ * jobSpec: a pointer to the struct of the test to run.
+ * generator: a pointer to store the pid of the generator in, or 0 if the
+ * 	test has none.
+ *
+ * Returns: the pid of the child process, or -1 if it could not be created.
+ */
+pid_t start_gooduqwordladder(JobSpecs* jobSpec, pid_t* generator) {
+    int inputPipe[2];
+    make_input_pipe(jobSpec, inputPipe);
+    fflush(stdout);
+    pid_t pid = fork_process();
+    if (pid == 0) {
+	exec_gooduqwordladder(jobSpec, inputPipe);
+    }
+    *generator = pid > 0 ? start_generator(jobSpec, inputPipe, pid) : 0;
+    if (pid < 0) {
+	close(inputPipe[READ_END]);
+	close(inputPipe[WRITE_END]);
+    }
+    return pid;
+}
+
+/* start_compressor()
+ * ------------------
+ * Creates a child process that compresses the output files of a test once
+ * 	good-uqwordladder has exited, so that compression happens in
+ * 	parallel with the other tests and is not timed with it.
+ *
+ * jobSpec: a pointer to the struct of the test.
+ *
+ * Returns: the pid of the child process, or -1 if it could not be created.
+ */
+pid_t start_compressor(JobSpecs* jobSpec) {
+    fflush(stdout);
+    pid_t pid = fork_process();
+    if (pid == 0) {
+	// An output file that cannot be compressed is left uncompressed.
+	codec_compress_file(jobSpec->outputFile);
+	codec_compress_file(jobSpec->errorFile);
+	_exit(OK);
+    }
+    return pid;
+}
+
+/* exec_gooduqwordladder()
+ * -----------------------
+ * Runs good-uqwordladder for a test in the current process, with its stdout
+ * 	and stderr redirected to the test's output files.
+ *
+ * jobSpec: a pointer to the struct of the test to run.
+ * inputPipe: a pointer to the array of the pipe from the generator of the
+ * 	test's input, whose ends are -1 if it has none.
+ *
+ * Errors: Exits with status 99 if good-uqwordladder cannot be run.
+ */
+void exec_gooduqwordladder(JobSpecs* jobSpec, int* inputPipe) {
+    jobSpec->args[0] = GOOD_UQWORDLADDER;
+
+    // Open corresponding output files and redirect to them.
+    int in = open_input(jobSpec, inputPipe);
+    int out = open(jobSpec->outputFile, O_WRONLY | O_TRUNC);
+    int err = open(jobSpec->errorFile, O_WRONLY | O_TRUNC);
+    dup2(in, STDIN_FILENO);
+    dup2(out, STDOUT_FILENO);
+    dup2(err, STDERR_FILENO);
+    close(in);
+    close(out);
+    close(err);
+    execvp(jobSpec->args[0], jobSpec->args);
+    // Leave without flushing the stdio buffers copied from the parent.
+    _exit(UNEXPECTED_ERR);
+}
+
+/* is_generator()
+ * --------------
+ * Returns whether the input of a test is the output of a generator command
+ * 	rather than a file.
+ */
+bool is_generator(JobSpecs* jobSpec) {
+    return jobSpec->inputFile[0] == GENERATOR_PREFIX;
+}
+
+/* make_input_pipe()
+ * -----------------
+ * Makes the pipe from the generator of a test's input to the program, before
+ * 	either of them is created.
+ *
+ * jobSpec: a pointer to the struct of the test.
+ * inputPipe: a pointer to the array to store the pipe in, whose ends are -1
+ * 	if the test has no generator or the pipe cannot be made.
+ *
+ * Returns: void
+ */
+void make_input_pipe(JobSpecs* jobSpec, int* inputPipe) {
+    if (!is_generator(jobSpec) || pipe(inputPipe) == -1) {
+	inputPipe[READ_END] = -1;
+	inputPipe[WRITE_END] = -1;
+    }
+}
+
+/* open_input()
+ * ------------
+ * Opens the input of a test to redirect to the stdin of a program, in the
+ * 	process about to run it. The input of a generator test is the read
+ * 	end of the pipe from its generator, which is started separately by
+ * 	start_generator(), so that the program does not have a child it does
+ * 	not expect.
+ *
+ * jobSpec: a pointer to the struct of the test.
+ * inputPipe: a pointer to the array of the pipe from the generator, whose
+ * 	write end is closed.
+ *
+ * Returns: the file descriptor of the input, or -1 if it cannot be opened.
+ */
+int open_input(JobSpecs* jobSpec, int* inputPipe) {
+    if (!is_generator(jobSpec)) {
+	return open(jobSpec->inputFile, O_RDONLY);
+    }
+    if (inputPipe[READ_END] == -1) {
+	return open(NULL_DEVICE, O_RDONLY);
+    }
+    close(inputPipe[WRITE_END]);
+    return inputPipe[READ_END];
+}
+
+/* start_generator()
+ * -----------------
+ * Creates a child process that runs the generator command of a test with the
+ * 	shell, writing to the pipe to the program, once the program has been
+ * 	created. The caller waits for it, so that a generator that fails is
+ * 	reported. It stops with SIGPIPE if the program exits before reading
+ * 	all of its output. Both ends of the pipe are then closed in the
+ * 	calling process.
+ *
+ * jobSpec: a pointer to the struct of the test.
+ * inputPipe: a pointer to the array of the pipe from the generator.
+ * group: the process group to put the generator in, so that it is killed
+ * 	along with it, or 0 to keep that of the calling process.
+ *
+ * Returns: the pid of the generator, 0 if the test has none, or -1 if it
+ * 	could not be created.
+ */
+pid_t start_generator(JobSpecs* jobSpec, int* inputPipe, pid_t group) {
+    if (inputPipe[WRITE_END] == -1) {
+	return 0;
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+	if (group > 0) {
+	    setpgid(0, group);
+	}
+	int null = open(NULL_DEVICE, O_RDONLY);
+	dup2(null, STDIN_FILENO);
+	dup2(inputPipe[WRITE_END], STDOUT_FILENO);
+	close_other_fds();
+	execl(GENERATOR_SHELL, GENERATOR_SHELL, "-c",
+		jobSpec->inputFile + 1, (char*) NULL);
+	_exit(UNEXPECTED_ERR);
+    }
+    if (pid > 0 && group > 0) {
+	setpgid(pid, group);
+    }
+    close(inputPipe[READ_END]);
+    close(inputPipe[WRITE_END]);
+    return pid;
+}
+
+/* generator_failed()
+ * ------------------
+ * Returns whether a generator with a wait status failed, by exiting with
+ * 	other than 0 or being killed by a signal other than SIGPIPE. The
+ * 	shell exits with SHELL_SIGNAL_BASE plus the signal when the last
+ * 	command of a generator is killed, which is the same.
+ */
+bool generator_failed(int status) {
+    if (WIFSIGNALED(status)) {
+	return WTERMSIG(status) != SIGPIPE;
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) != 0 &&
+	    WEXITSTATUS(status) != SHELL_SIGNAL_BASE + SIGPIPE;
+}
+
+/* close_other_fds()
+ * -----------------
+ * Closes the file descriptors other than stdin, stdout and stderr, which a
+ * 	command started by this program must not keep open, from those
+ * 	listed in /proc, or every one up to the limit if they are not.
+ *
+ * Returns: void
+ */
+void close_other_fds(void) {
+    DIR* fds = opendir(FD_DIR);
+    if (fds == NULL) {
+	long maxFd = sysconf(_SC_OPEN_MAX);
+	for (long fd = STDERR_FILENO + 1; fd < maxFd; fd++) {
+	    close(fd);
+	}
+	return;
+    }
+    struct dirent* entry;
+    while ((entry = readdir(fds)) != NULL) {
+	int fd = atoi(entry->d_name);
+	if (fd > STDERR_FILENO && fd != dirfd(fds)) {
+	    close(fd);
+	}
+    }
+    closedir(fds);
+}
+
+/* make_generator_key()
+ * --------------------
+ * Makes the key of the expected output of a generator test: its command and
+ * 	the program's arguments, separated by tabs as in the job file.
+ *
+ * jobSpec: a pointer to the struct of the test.
+ * key: a pointer to the array to make the key in, which is at least as long
+ * 	as the test's line plus two.
+ *
+ * Returns: void
+ */
+void make_generator_key(JobSpecs* jobSpec, char* key) {
+    char* end = stpcpy(key, jobSpec->inputFile);
+    for (char** arg = jobSpec->args + 1; *arg != NULL; arg++) {
+	*end++ = '\t';
+	end = stpcpy(end, *arg);
+    }
+    strcpy(end, "\n");
+}
+
+/* check_generator_key()
+ * ---------------------
+ * Checks whether the key stored with the expected output of a generator test
+ * 	is the same as its current key, a block at a time.
+ *
+ * keyPath: a pointer to the array with the path of the stored key.
+ * key: a pointer to the array with the current key.
+ *
+ * Returns: true if the stored key is the same, else returns false, including
+ * 	if it cannot be read.
+ */
+bool check_generator_key(char* keyPath, char* key) {
+    int keyFile = open(keyPath, O_RDONLY);
+    if (keyFile == -1) {
+	return false;
+    }
+    size_t length = strlen(key);
+    size_t compared = 0;
+    char buffer[COPY_BUFFER];
+    ssize_t numRead;
+    bool same = true;
+    while (same && (numRead = read(keyFile, buffer, COPY_BUFFER)) > 0) {
+	same = compared + numRead <= length &&
+		memcmp(buffer, key + compared, numRead) == 0;
+	compared += numRead;
+    }
+    close(keyFile);
+    return same && numRead == 0 && compared == length;
+}
+
+/* write_generator_key()
+ * ---------------------
+ * Stores the key of the expected output of a generator test.
+ *
+ * keyPath: a pointer to the array with the path to store the key at.
+ * key: a pointer to the array with the key.
+ *
+ * Returns: void
+ * Errors: Exits with status 6 and output file error if the key cannot be
+ * 	written in full.
+ */
+void write_generator_key(char* keyPath, char* key) {
+    int keyFile = open(keyPath, O_WRONLY | O_CREAT | O_TRUNC,
+	    S_IRUSR | S_IWUSR);
+    size_t length = strlen(key);
+    bool written = keyFile != -1 &&
+	    write(keyFile, key, length) == (ssize_t) length;
+    if (keyFile != -1 && close(keyFile) == -1) {
+	written = false;
+    }
+    if (!written) {
+	unlink(keyPath);
+	fprintf(stderr, OUTPUT_FILE_ERR_MSG, keyPath);
+	exit(OUTPUT_FILE_ERR);
+    }
+}
+
+/* wait_for_child()
+ * ----------------
+ * Waits for any child process to finish and reaps it. SIGINT and SIGCHLD are
+ * 	only unblocked while waiting, so that neither can be missed between
+ * 	checking for them and starting to wait.
+ *
+ * status: a pointer to store the status of the finished process in.
+ * deadline: a pointer to the monotonic time to stop waiting at, or NULL to
+ * 	wait without a time limit.
+ * usage: a pointer to store the resources used by the finished process in,
+ * 	or NULL if they are not needed.
+ *
+ * Returns: the pid of the finished process, 0 if the deadline passed or
+ * 	SIGINT was received first, or -1 if there are no child processes.
+ */
+pid_t wait_for_child(int* status, struct timespec* deadline,
+	struct rusage* usage) {
+    sigset_t blocked;
+    sigset_t original;
+    sigemptyset(&blocked);
+    sigaddset(&blocked, SIGINT);
+    sigaddset(&blocked, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &blocked, &original);
+
+    pid_t pid;
+    while ((pid = wait4(-1, status, WNOHANG, usage)) == 0 && !interrupted) {
+	struct timespec timeout;
+	if (deadline != NULL) {
+	    struct timespec now;
+	    clock_gettime(CLOCK_MONOTONIC, &now);
+	    timeout.tv_sec = deadline->tv_sec - now.tv_sec;
+	    timeout.tv_nsec = deadline->tv_nsec - now.tv_nsec;
+	    if (timeout.tv_nsec < 0) {
+		timeout.tv_sec--;
+		timeout.tv_nsec += 1000000000;
+	    }
+	    if (timeout.tv_sec < 0) {
+		break;
+	    }
+	}
+	pselect(0, NULL, NULL, NULL, deadline != NULL ? &timeout : NULL,
+		&original);
+    }
+    sigprocmask(SIG_SETMASK, &original, NULL);
+    return pid;
+}
+
+/* seconds_since()
+ * ---------------
+ * Returns the number of seconds since a monotonic time.
+ *
+ * start: a pointer to the monotonic time to measure from.
+ */
+double seconds_since(struct timespec* start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec - start->tv_sec + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/* set_deadline()
+ * --------------
+ * Sets a monotonic time a number of seconds after another.
+ *
+ * deadline: a pointer to store the time in.
+ * start: a pointer to the monotonic time to measure from.
+ * timeout: the number of seconds after the start.
+ *
+ * Returns: void
+ */
+void set_deadline(struct timespec* deadline, struct timespec* start,
+	double timeout) {
+    long timeoutNsec = (long) (timeout * 1000000000);
+    *deadline = *start;
+    deadline->tv_sec += timeoutNsec / 1000000000;
+    deadline->tv_nsec += timeoutNsec % 1000000000;
+    if (deadline->tv_nsec >= 1000000000) {
+	deadline->tv_sec++;
+	deadline->tv_nsec -= 1000000000;
+    }
+}
+
+/* wait_for_test_child()
+ * ---------------------
+ * Waits for any child process other than those of the retries running in
+ * 	the background to finish and reaps it, like wait_for_child(). The
+ * 	retries that finish meanwhile are completed, and those still running
+ * 	at their test's timeout are killed.
+ *
+ * status: a pointer to store the status of the finished process in.
+ * deadline: a pointer to the monotonic time to stop waiting at, or NULL to
+ * 	wait without a time limit.
+ * usage: a pointer to store the resources used by the finished process in,
+ * 	or NULL if they are not needed.
+ *
+ * Returns: the pid of the finished process, 0 if the deadline passed or
+ * 	SIGINT was received first, or -1 if there are no child processes.
+ */
+pid_t wait_for_test_child(int* status, struct timespec* deadline,
+	struct rusage* usage) {
+    while (true) {
+	struct timespec earliest;
+	struct rusage childUsage;
+	pid_t pid = wait_for_child(status, retry_deadline(deadline, &earliest),
+		&childUsage);
+	if (pid > 0 && finish_retry(pid, *status, &childUsage)) {
+	    continue;
+	}
+	if (pid == 0 && !interrupted && expire_retries()) {
+	    continue;
+	}
+	if (usage != NULL) {
+	    *usage = childUsage;
+	}
+	return pid;
+    }
+}
+
+/* link_output_file()
+ * ------------------
+ * Replaces an output file with a hard link to another output file, or with a
+ * 	copy of it if the file system does not support hard links.
+ *
+ * fromPath: a pointer to the array with the filepath of the existing file.
+ * toPath: a pointer to the array with the filepath of the file to replace.
+ *
+ * Errors: Exits with status 6 and output file error, removing the partly
+ * 	copied file, if the file cannot be linked, opened, read or written in
+ * 	full.
+ */
+void link_output_file(char* fromPath, char* toPath) {
+    unlink(toPath);
+    if (link(fromPath, toPath) == 0) {
+	return;
+    }
+    int from = open(fromPath, O_RDONLY);
+    int to = from == -1 ? -1 :
+	    open(toPath, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    bool copied = to != -1;
+    char buffer[COPY_BUFFER];
+    ssize_t numRead;
+    while (copied && (numRead = read(from, buffer, COPY_BUFFER)) != 0) {
+	if (numRead == -1) {
+	    copied = errno == EINTR;
+	    continue;
+	}
+	// Write all of the block, as a write to a full disk can be short.
+	for (ssize_t written = 0; copied && written < numRead; ) {
+	    ssize_t numWritten = write(to, buffer + written, numRead - written);
+	    if (numWritten > 0) {
+		written += numWritten;
+	    } else {
+		copied = numWritten == -1 && errno == EINTR;
+	    }
+	}
+    }
+    if (from != -1) {
+	close(from);
+    }
+    if (to != -1 && close(to) == -1) {
+	copied = false;
+    }
+    if (!copied) {
+	// A partial copy would be compared against as if it were complete.
+	unlink(toPath);
+	fprintf(stderr, OUTPUT_FILE_ERR_MSG, toPath);
+	exit(OUTPUT_FILE_ERR);
+    }
+}
+
+/* load_expected_exit_statuses()
+ * ------------------------------
+ * Reads the expected exit status of a batch of tests from the .exitstatus
+ * 	files, all at once, before they are run. Tests whose expected output
+ * 	is being rebuilt get theirs once it has been.
+ *
+ * parameters: a struct containing the program's main parameters including
+ * 	the jobSpecs data struct.
+ * first: the index of the first test of the batch, which runs to the last
+ * 	test loaded.
+ *
+ * Returns: void
+ */
+void load_expected_exit_statuses(ProgramParameters parameters, int first) {
+    JobSpecs* jobSpecs = parameters.jobSpecs;
+    int numOfTests = parameters.numOfTests;
+
+    // Only the first test of each invocation needs to be read, as the others
+    // share its files. They are read at most the largest batch at a time.
+    char* exitStatusPaths[PIPELINE_MAX_BATCH];
+    char buffers[PIPELINE_MAX_BATCH * EXITSTATUS_BUFFER];
+    for (int start = first; start < numOfTests; start += PIPELINE_MAX_BATCH) {
+	int end = numOfTests - start < PIPELINE_MAX_BATCH ? numOfTests :
+		start + PIPELINE_MAX_BATCH;
+	int numFiles = 0;
+	for (int test = start; test < end; test++) {
+	    if (jobSpecs[test].invocation == test &&
+		    !jobSpecs[test].rebuilding) {
+		exitStatusPaths[numFiles++] = jobSpecs[test].exitStatusFile;
+	    }
+	}
+	gio_read_files(exitStatusPaths, buffers, EXITSTATUS_BUFFER, numFiles);
+
+	int file = 0;
+	for (int test = start; test < end; test++) {
+	    if (jobSpecs[test].rebuilding) {
+		continue;
+	    }
+	    if (jobSpecs[test].invocation != test) {
+		JobSpecs* first = &jobSpecs[jobSpecs[test].invocation];
+		jobSpecs[test].expectedExitStatus = first->expectedExitStatus;
+		jobSpecs[test].goldenTime = first->goldenTime;
+		jobSpecs[test].goldenRss = first->goldenRss;
+		jobSpecs[test].timeout = first->timeout;
+		continue;
+	    }
+	    set_expected_exit_status(&jobSpecs[test],
+		    buffers + EXITSTATUS_BUFFER * file++,
+		    parameters.timeoutFactor, parameters.timeoutFloor);
+	}
+    }
+}
+
+/* set_expected_exit_status()
+ * --------------------------
+ * Sets the expected exit status of a test from the contents of its
+ * 	.exitstatus file. The test's timeout is the run time of
+ * 	good-uqwordladder recorded with it times the timeout factor, but at
+ * 	least the timeout floor, or 1.5 seconds if no run time was recorded.
+ *
+ * jobSpec: a pointer to the struct of the test.
+ * text: a pointer to the array with the contents of the file.
+ * timeoutFactor: the timeout factor from the command line arguments.
+ * timeoutFloor: the timeout floor from the command line arguments.
+ *
+ * Returns: void
+ */
+void set_expected_exit_status(JobSpecs* jobSpec, char* text,
+	double timeoutFactor, double timeoutFloor) {
+    jobSpec->expectedExitStatus = atoi(text);
+    jobSpec->goldenRss = 0;
+    char* runTime = strchr(text, '\n');
+    if (runTime == NULL || runTime[1] < '0' || runTime[1] > '9') {
+	jobSpec->goldenTime = 0;
+	jobSpec->timeout = TEST_DELAY / 1000000.0;
+	return;
+    }
+    jobSpec->goldenTime = strtol(runTime + 1, NULL, 10) / 1000000.0;
+    char* maxRss = strchr(runTime + 1, '\n');
+    if (maxRss != NULL) {
+	jobSpec->goldenRss = strtol(maxRss + 1, NULL, 10);
+    }
+    double timeout = jobSpec->goldenTime * timeoutFactor;
+    timeout = timeout < MAX_TIMEOUT ? timeout : MAX_TIMEOUT;
+    jobSpec->timeout = timeout > timeoutFloor ? timeout : timeoutFloor;
+}
+
+/* run_testjob()
+ * -------------
+ * Runs all tests specified in the job specifications file, or those selected
+ * 	with '--select', against each candidate program and reports results.
+ * 	Tests are loaded in batches of increasing size as they are needed,
+ * 	so that the first test starts as soon as it has been loaded. With
+ * 	'--progress' on a terminal, only failed tests are reported, below
+ * 	a status line of the run. With '--retries N', a failed test is run N
+ * 	more times in the background while the tests after it run, and is
+ * 	flaky rather than failed if any of them pass. With '--counters', the
+ * 	hardware counters of each program are reported against those of
+ * 	good-uqwordladder. With '--stress N', once every test has run and
+ * 	the retries and rebuilds have finished, a test that passed is run
+ * 	again as 1, 2, 4 and so on up to N instances at once, and fails if
+ * 	any of them do. The verdicts of finished tests are kept in a checkpoint
+ * 	until every test is finished, and with '--resume', the tests
+ * 	finished by an interrupted run of the same programs and expected
+ * 	output are not run again.
+ *
+ * parameters: a struct containing the program's main parameters including 
+ * 	the jobSpecs data struct.
+ *
+ * Errors: Exits with status 18 if a test fails, or is flaky with '--strict',
+ * 	or exits with status 9 if no tests were done.
+ */
+void run_testjob(ProgramParameters parameters) {
+    JobSpecs* jobSpecs = parameters.jobSpecs;
+    int numPrograms = parameters.numPrograms;
+
+    // Every line of the file may be a test, which are not all loaded yet.
+    int numOfTests = parameters.jobSpecFile.numLines;
+    TestResults results;
+    results.numOfRunTests = 0;
+    parameters.programErrors = calloc(numPrograms, sizeof(int));
+    results.runTests = malloc(sizeof(int) * numOfTests);
+    results.verdicts = malloc(sizeof(enum Verdict) * numOfTests * numPrograms);
+    results.successfulTests = calloc(numPrograms, sizeof(int));
+    results.flakyTests = calloc(numPrograms, sizeof(int));
+    results.limitTests = calloc(numPrograms, sizeof(int));
+    results.runTimes = calloc(numPrograms, sizeof(double));
+    results.counterTotals =
+	    calloc((numPrograms + 1) * PERF_NUM_COUNTERS, sizeof(long long));
+    results.stressLevels = malloc(sizeof(StressLevel) * numPrograms *
+	    STRESS_MAX_LEVELS);
+    results.numStressLevels = 0;
+    for (int i = 0; i < numPrograms && parameters.stress > 0; i++) {
+	results.numStressLevels = stress_levels(results.stressLevels +
+		i * STRESS_MAX_LEVELS, parameters.stress);
+    }
+
+    // Every test run is recorded in the history file, along with a hash of
+    // each candidate program so that rebuilds of it can be told apart.
+    char historyPath[PATH_MAX];
+    snprintf(historyPath, PATH_MAX, "%s/%s", parameters.testDir,
+	    HISTORY_FILE);
+    history_start(&history, historyPath);
+    uint64_t programHashes[numPrograms];
+    for (int i = 0; i < numPrograms; i++) {
+	programHashes[i] = history_program_hash(parameters.programs[i]);
+    }
+    if (parameters.daemonSocket == NULL) {
+	char checkpointPath[PATH_MAX];
+	snprintf(checkpointPath, PATH_MAX, "%s/%s", parameters.testDir,
+		CHECKPOINT_FILE);
+	int numResumed = checkpoint_open(&checkpoint, checkpointPath,
+		programHashes, numPrograms, parameters.resume);
+	if (numResumed > 0) {
+	    fprintf(stdout, RESUME_MSG, numResumed);
+	}
+    }
+
+    Invocations invocations;
+    invocations.codes =
+	    malloc(sizeof(int) * TOTAL_PIDS * numPrograms * numOfTests);
+    invocations.usages = malloc(sizeof(Usage) * numPrograms * numOfTests);
+    invocations.execErrors = malloc(sizeof(int) * numPrograms * numOfTests);
+    invocations.run = calloc(numOfTests, sizeof(bool));
+    invocations.numCounts = (numPrograms + 1) * PERF_NUM_COUNTERS;
+    invocations.counts = parameters.counters ? malloc(sizeof(long long) *
+	    invocations.numCounts * numOfTests) : NULL;
+    invocations.retries = malloc(sizeof(int) * numPrograms * numOfTests);
+    invocations.stress = malloc(sizeof(int) * numPrograms * numOfTests);
+    for (int i = 0; i < numPrograms * numOfTests; i++) {
+	invocations.retries[i] = -1;
+	invocations.stress[i] = -1;
+    }
+
+    // Tests that have been run but are waiting for their retries to finish
+    // before they are recorded, in the order they were run.
+    int* pendingTests = malloc(sizeof(int) * numOfTests);
+    int numPending = 0;
+    retries.parameters = parameters;
+    retries.numRuns = 0;
+    retries.waiting = malloc(sizeof(RetryRequest) * numPrograms * numOfTests);
+    retries.numWaiting = 0;
+    retries.nextWaiting = 0;
+    retries.owner = getpid();
+
+    Progress progress;
+    progress_start(&progress, parameters.progress && isatty(STDOUT_FILENO),
+	    parameters.jobs);
+    int batchSize = PIPELINE_FIRST_BATCH;
+#ifdef BENCHMARK
+    // Timing loading on its own needs every test loaded in the first batch.
+    if (getenv(BENCH_STOP_ENV) != NULL) {
+	batchSize = INT_MAX;
+    }
+#endif
+    int numQueued = 0;
+    for (int test = 0; ; test++) {
+	// Load the next batch once every test loaded so far has been run. While
+	// expected output is being rebuilt and no more rebuilds are waiting to
+	// start, the batch after it is loaded too, so that rebuilding keeps
+	// ahead of the tests.
+	if (test == parameters.numOfTests) {
+	    load_tests(&parameters, batchSize);
+	}
+	if (rebuilds.readAhead &&
+		rebuilds.numRunning < MAX_GOLDEN_PROCESSES &&
+		rebuilds.nextTest == rebuilds.numOfTests) {
+	    load_tests(&parameters, batchSize);
+	}
+	if (test == parameters.numOfTests || interrupted) {
+	    break;
+	}
+	if (numQueued < parameters.numOfTests) {
+	    // The status line estimates the time left from the recorded run
+	    // times of good-uqwordladder, which tests being rebuilt do not
+	    // have yet.
+	    int numSelected = 0;
+	    double expectedTime = 0;
+	    for (int i = numQueued; i < parameters.numOfTests; i++) {
+		if (test_selected(parameters, i)) {
+		    numSelected++;
+		    expectedTime += jobSpecs[i].rebuilding ? 0 :
+			    jobSpecs[i].goldenTime;
+		}
+	    }
+	    progress_add_tests(&progress, numSelected, expectedTime);
+	    numQueued = parameters.numOfTests;
+	    batchSize = batchSize < PIPELINE_MAX_BATCH / 2 ? batchSize * 2 :
+		    PIPELINE_MAX_BATCH;
+	}
+	if (!test_selected(parameters, test)) {
+	    continue;
+	}
+	wait_for_rebuild(parameters, test);
+	if (resume_test(parameters, test, &results, &progress)) {
+	    continue;
+	}
+	if (!progress.enabled) {
+	    fprintf(stdout, RUN_TEST_MSG, jobSpecs[test].testID);
+	    fflush(stdout);
+	}
+	int invocation = jobSpecs[test].invocation;
+	int* codes = invocations.codes + invocation * numPrograms * TOTAL_PIDS;
+	int* execErrors = invocations.execErrors + invocation * numPrograms;
+	if (!invocations.run[invocation]) {
+	    run_invocation(parameters, invocation, codes, execErrors,
+		    invocations.usages + invocation * numPrograms,
+		    invocations.counts != NULL ? invocations.counts +
+		    invocation * invocations.numCounts : NULL);
+	    invocations.run[invocation] = true;
+	}
+	// A test cut short by SIGINT is not recorded.
+	if (interrupted) {
+	    break;
+	}
+
+	// A failed test is run again in the background with '--retries', so
+	// that the tests after it are not held up, and its verdict is recorded
+	// once they finish. A program over its limits or that could not be
+	// executed is not run again.
+	for (int i = 0; i < numPrograms && parameters.retries > 0; i++) {
+	    int* passedRetries =
+		    invocations.retries + invocation * numPrograms + i;
+	    int programCode = codes[i * TOTAL_PIDS + UQWORDLADDER_PID];
+	    if (*passedRetries == -1 && execErrors[i] == 0 &&
+		    programCode != CPU_LIMIT_EXCEEDED &&
+		    programCode != OUT_OF_MEMORY &&
+		    count_matches(jobSpecs, test, codes + i * TOTAL_PIDS) !=
+		    REQUIRED_MATCHES) {
+		*passedRetries = RETRIES_RUNNING;
+		queue_retries(invocation, parameters.programs[i],
+			passedRetries, &execErrors[i]);
+	    }
+	}
+	// With '--stress', every test waits to be recorded until the end of
+	// the run, so that the tests that passed are stressed in a phase of
+	// their own.
+	pendingTests[numPending++] = test;
+	if (parameters.stress == 0) {
+	    numPending = record_finished_tests(parameters, pendingTests,
+		    numPending, &invocations, &results, &progress,
+		    programHashes);
+	}
+    }
+    // The last tests may still be waiting for their retries, which SIGINT
+    // cuts short. Stressing waits for the rebuilds too, so that nothing else
+    // runs while the tests are stressed.
+    wait_for_retries();
+    if (parameters.stress > 0) {
+	wait_for_rebuilds();
+    }
+    if (interrupted) {
+	record_interrupted_tests(parameters, pendingTests, numPending,
+		&invocations, &results, &progress, programHashes);
+    } else {
+	record_finished_tests(parameters, pendingTests, numPending,
+		&invocations, &results, &progress, programHashes);
+    }
+    progress_clear(&progress);
+    // The expected output is complete, so io_uring is not needed any more.
+    flush_rebuild_statuses();
+    gio_close();
+    // Report the tests completed before SIGINT.
+    if (interrupted) {
+	report_results(parameters, &results);
+	exit(OK);
+    }
+    free(invocations.codes);
+    free(invocations.usages);
+    free(invocations.execErrors);
+    free(invocations.run);
+    free(invocations.retries);
+    free(invocations.stress);
+    free(invocations.counts);
+    free(pendingTests);
+    free(retries.waiting);
+    bench_phase_done(BENCH_RUN, results.numOfRunTests);
+
+    // Every test is finished, so the next run starts from the beginning.
+    checkpoint_remove(&checkpoint);
+
+    // Print number of successful tests. Flaky tests only fail the run in
+    // strict mode.
+    report_results(parameters, &results);
+    for (int i = 0; i < numPrograms; i++) {
+	int numPassed = results.successfulTests[i] +
+		(parameters.strict ? 0 : results.flakyTests[i]);
+	if (numPassed != results.numOfRunTests) {
+	    exit(UNSUCCESSFUL_TESTS);
+	}
+    }
+}
+
+/* record_test()
+ * -------------
+ * Works out the verdict of each candidate program on a test that has been
+ * 	run, once any retries of it have finished, and reports and records
+ * 	it. A candidate that passed is first stressed with '--stress', unless
+ * 	SIGINT has been received.
+ *
+ * parameters: a struct containing the program's main parameters including
+ * 	the jobSpecs data struct and the candidate programs.
+ * test: the 'n'th test to record.
+ * invocations: a pointer to the struct with the results of each unique
+ * 	invocation.
+ * results: a pointer to the struct with the results of the tests run.
+ * progress: a pointer to the status line of the run.
+ * programHashes: a pointer to the array with the hash of each candidate.
+ *
+ * Returns: void
+ */
+void record_test(ProgramParameters parameters, int test,
+	Invocations* invocations, TestResults* results, Progress* progress,
+	uint64_t* programHashes) {
+    JobSpecs* jobSpecs = parameters.jobSpecs;
+    int numPrograms = parameters.numPrograms;
+    int invocation = jobSpecs[test].invocation;
+    int* codes = invocations->codes + invocation * numPrograms * TOTAL_PIDS;
+    Usage* usages = invocations->usages + invocation * numPrograms;
+    int* execErrors = invocations->execErrors + invocation * numPrograms;
+    long long* counts = invocations->counts != NULL ?
+	    invocations->counts + invocation * invocations->numCounts : NULL;
+
+    // Check if processes were successful and stdout, stderr, and exit
+    // statuses match. Success will be 3 if all match.
+    bool allPassed = true;
+    int verdicts[MAX_PROGRAMS];
+    double runTimes[MAX_PROGRAMS];
+    for (int i = 0; i < numPrograms; i++) {
+	char* candidate = numPrograms > 1 ? parameters.programs[i] : NULL;
+	int success = count_matches(jobSpecs, test, codes + i * TOTAL_PIDS);
+	int* passedRetries =
+		invocations->retries + invocation * numPrograms + i;
+	int programCode = codes[i * TOTAL_PIDS + UQWORDLADDER_PID];
+	bool overLimit = programCode == CPU_LIMIT_EXCEEDED ||
+		programCode == OUT_OF_MEMORY;
+	enum Verdict verdict = success == REQUIRED_MATCHES ? VERDICT_PASS :
+		overLimit ? VERDICT_LIMIT :
+		*passedRetries > 0 ? VERDICT_FLAKY : VERDICT_FAIL;
+	bool overPeakMemory = verdict == VERDICT_PASS &&
+		parameters.rssRatio > 0 && jobSpecs[test].goldenRss > 0 &&
+		usages[i].maxRss >
+		parameters.rssRatio * jobSpecs[test].goldenRss;
+	verdict = overPeakMemory ? VERDICT_FAIL : verdict;
+	int* stressFailed = invocations->stress + invocation * numPrograms + i;
+	if (verdict == VERDICT_PASS && parameters.stress > 0 &&
+		*stressFailed == -1 && !interrupted) {
+	    *stressFailed = stress_test(parameters, invocation,
+		    parameters.programs[i],
+		    results->stressLevels + i * STRESS_MAX_LEVELS,
+		    results->numStressLevels, &execErrors[i]);
+	}
+	verdict = *stressFailed > 0 || execErrors[i] != 0 ? VERDICT_FAIL :
+		verdict;
+	if (execErrors[i] != 0) {
+	    progress_clear(progress);
+	    report_exec_failed(jobSpecs, test, candidate, execErrors[i]);
+	} else if (!progress->enabled || verdict != VERDICT_PASS) {
+	    progress_clear(progress);
+	    report_cmp_results(jobSpecs, test, codes + i * TOTAL_PIDS,
+		    candidate);
+	    if (verdict != VERDICT_PASS && *passedRetries != -1 &&
+		    *stressFailed <= 0) {
+		report_retries(parameters, test, candidate, *passedRetries);
+	    }
+	    if (overPeakMemory) {
+		report_peak_memory(&jobSpecs[test], candidate,
+			usages[i].maxRss, parameters.rssRatio);
+	    }
+	    if (*stressFailed > 0) {
+		report_stress_failed(jobSpecs[test].testID, candidate,
+			*stressFailed, results->stressLevels,
+			results->numStressLevels);
+	    }
+	}
+	results->verdicts[test * numPrograms + i] = verdict;
+	results->successfulTests[i] += verdict == VERDICT_PASS;
+	results->flakyTests[i] += verdict == VERDICT_FLAKY;
+	results->limitTests[i] += verdict == VERDICT_LIMIT;
+	results->runTimes[i] += usages[i].runTime;
+	verdicts[i] = verdict;
+	runTimes[i] = usages[i].runTime;
+	history_append(&history, jobSpecs[test].testID, verdict,
+		programHashes[i], usages[i].runTime, usages[i].cpuTime,
+		usages[i].maxRss);
+	allPassed &= verdict == VERDICT_PASS ||
+		(verdict == VERDICT_FLAKY && !parameters.strict);
+	if (counts != NULL) {
+	    long long* reference = counts + numPrograms * PERF_NUM_COUNTERS;
+	    long long* candidateCounts = counts + i * PERF_NUM_COUNTERS;
+	    if (!progress->enabled) {
+		report_counters(jobSpecs[test].testID, candidate,
+			candidateCounts, reference);
+	    }
+	    add_counts(results->counterTotals + i * PERF_NUM_COUNTERS,
+		    candidateCounts);
+	    if (i == 0) {
+		add_counts(results->counterTotals +
+			numPrograms * PERF_NUM_COUNTERS, reference);
+	    }
+	}
+    }
+    add_run_test(results, test);
+    progress_test_done(progress, allPassed, jobSpecs[test].goldenTime);
+
+    // A program that cannot be executed at all would fail every test, so
+    // it is dropped from the rest of the run.
+    for (int i = 0; i < numPrograms; i++) {
+	if (execErrors[i] != 0) {
+	    progress_clear(progress);
+	    drop_program(parameters, i, execErrors[i]);
+	}
+    }
+    checkpoint_add(&checkpoint, jobSpecs[test].testID,
+	    golden_mtime(&jobSpecs[test]), verdicts, runTimes);
+    bench_test_done();
+
+}
+
+/* record_finished_tests()
+ * -----------------------
+ * Records the tests that have been run and are no longer waiting for any
+ * 	passedRetries to finish, in the order they were run.
+ *
+ * parameters: a struct containing the program's main parameters including
+ * 	the jobSpecs data struct and the candidate programs.
+ * pendingTests: a pointer to the array with the tests waiting to be
+ * 	recorded, which is left with those still waiting.
+ * numPending: the number of tests waiting to be recorded.
+ * invocations: a pointer to the struct with the results of each unique
+ * 	invocation.
+ * results: a pointer to the struct with the results of the tests run.
+ * progress: a pointer to the status line of the run.
+ * programHashes: a pointer to the array with the hash of each candidate.
+ *
+ * Returns: the number of tests still waiting to be recorded.
+ */
+int record_finished_tests(ProgramParameters parameters, int* pendingTests,
+	int numPending, Invocations* invocations, TestResults* results,
+	Progress* progress, uint64_t* programHashes) {
+    int numPrograms = parameters.numPrograms;
+    int numLeft = 0;
+    for (int pending = 0; pending < numPending; pending++) {
+	int test = pendingTests[pending];
+	int* passedRetries = invocations->retries +
+		parameters.jobSpecs[test].invocation * numPrograms;
+	bool retrying = false;
+	for (int i = 0; i < numPrograms; i++) {
+	    retrying |= passedRetries[i] == RETRIES_RUNNING;
+	}
+	if (retrying) {
+	    pendingTests[numLeft++] = test;
+	} else {
+	    record_test(parameters, test, invocations, results, progress,
+		    programHashes);
+	}
+    }
+    return numLeft;
+}
+
+/* record_interrupted_tests()
+ * --------------------------
+ * Records the tests still waiting for their retries once SIGINT is received,
+ * 	so that they are reported and kept in the checkpoint. Their retries
+ * 	are killed, and each gets the verdict of its first run.
+ *
+ * parameters: a struct containing the program's main parameters including
+ * 	the jobSpecs data struct and the candidate programs.
+ * pendingTests: a pointer to the array with the tests waiting to be
+ * 	recorded.
+ * numPending: the number of tests waiting to be recorded.
+ * invocations: a pointer to the struct with the results of each unique
+ * 	invocation.
+ * results: a pointer to the struct with the results of the tests run.
+ * progress: a pointer to the status line of the run.
+ * programHashes: a pointer to the array with the hash of each candidate.
+ *
+ * Returns: void
+ */
+void record_interrupted_tests(ProgramParameters parameters, int* pendingTests,
+	int numPending, Invocations* invocations, TestResults* results,
+	Progress* progress, uint64_t* programHashes) {
+    int numPrograms = parameters.numPrograms;
+    cancel_retries();
+    for (int pending = 0; pending < numPending; pending++) {
+	int* passedRetries = invocations->retries +
+		parameters.jobSpecs[pendingTests[pending]].invocation *
+		numPrograms;
+	for (int i = 0; i < numPrograms; i++) {
+	    if (passedRetries[i] == RETRIES_RUNNING) {
+		passedRetries[i] = -1;
+	    }
+	}
+    }
+    record_finished_tests(parameters, pendingTests, numPending, invocations,
+	    results, progress, programHashes);
+}
+
+/* add_run_test()
+ * --------------
+ * Adds a test to those run, which are kept in the order of the job
+ * 	specifications file although a test waiting for retries may finish
+ * 	after later ones.
+ *
+ * results: a pointer to the struct with the results of the tests run.
+ * testNum: the 'n'th test that was run.
+ *
+ * Returns: void
+ */
+void add_run_test(TestResults* results, int testNum) {
+    int run = results->numOfRunTests++;
+    for (; run > 0 && results->runTests[run - 1] > testNum; run--) {
+	results->runTests[run] = results->runTests[run - 1];
+    }
+    results->runTests[run] = testNum;
+}
+
+/* report_history()
+ * ----------------
+ * Reports the history of the tests run in the test directory, for
+ * 	'testuqwordladder --history [--testdir dir] [--select pattern]'.
+ *
+ * testDir: a pointer to the array with the test directory, or NULL for the
+ * 	default one.
+ * select: a pointer to the array with the pattern of tests to report, or
+ * 	NULL to report every test.
+ *
+ * Returns: Exits with status 0 once the history is reported.
+ * Errors: Exits with status 15 if the history file cannot be read.
+ */
+void report_history(char* testDir, char* select) {
+    char historyPath[PATH_MAX];
+    snprintf(historyPath, PATH_MAX, "%s/%s",
+	    testDir != NULL ? testDir : DEFAULT_TESTDIR_PATH, HISTORY_FILE);
+    if (!history_report(historyPath, select, HISTORY_SLOWEST)) {
+	fprintf(stderr, HISTORY_ERR_MSG, historyPath);
+	exit(HISTORY_ERR);
+    }
+    exit(OK);
+}
+
+/* save_history()
+ * --------------
+ * Writes the records of the tests run to the history file when the program
+ * 	exits, however the run ends. Only the process that ran the tests
+ * 	writes them.
+ *
+ * Returns: void
+ */
+void save_history(void) {
+    if (!history_flush(&history)) {
+	fprintf(stderr, HISTORY_WRITE_ERR_MSG, history.path);
+    }
+}
+
+/* golden_mtime()
+ * --------------
+ * Returns the modification time in nanoseconds of the expected exit status
+ * 	of a test, which is written last when its expected output is built,
+ * 	or 0 if it cannot be read.
+ *
+ * jobSpec: a pointer to the struct of the test.
+ */
+long long golden_mtime(JobSpecs* jobSpec) {
+    struct stat goldenStat;
+    if (stat(jobSpec->exitStatusFile, &goldenStat) == -1) {
+	return 0;
+    }
+    return goldenStat.st_mtim.tv_sec * 1000000000LL +
+	    goldenStat.st_mtim.tv_nsec;
+}
+
+/* resume_test()
+ * -------------
+ * Adds the verdicts of a test finished by an interrupted run to the results,
+ * 	if it was run against the same programs and expected output, and
+ * 	reports it if it did not pass. Its run is not recorded in the history
+ * 	again.
+ *
+ * parameters: a struct containing the program's main parameters including
+ * 	the jobSpecs data struct and the candidate programs.
+ * testNum: the index of the test.
+ * results: a pointer to the struct with the results of the tests run.
+ * progress: a pointer to the status line of the run.
+ *
+ * Returns: true if the test was finished by an earlier run, else returns
+ * 	false.
+ */
+bool resume_test(ProgramParameters parameters, int testNum,
+	TestResults* results, Progress* progress) {
+    JobSpecs* jobSpec = &parameters.jobSpecs[testNum];
+    int verdicts[MAX_PROGRAMS];
+    double runTimes[MAX_PROGRAMS];
+    if (checkpoint.finished.numTests == 0 ||
+	    !checkpoint_find(&checkpoint, jobSpec->testID,
+	    golden_mtime(jobSpec), verdicts, runTimes)) {
+	return false;
+    }
+    int numPrograms = parameters.numPrograms;
+    bool allPassed = true;
+    for (int i = 0; i < numPrograms; i++) {
+	if (verdicts[i] != VERDICT_PASS) {
+	    char* verdict = verdicts[i] == VERDICT_FLAKY ? RESUMED_FLAKY :
+		    verdicts[i] == VERDICT_LIMIT ? RESUMED_LIMIT : RESUMED_FAILED;
+	    progress_clear(progress);
+	    if (numPrograms > 1) {
+		fprintf(stdout, CANDIDATE_RESUMED_MSG, jobSpec->testID,
+			parameters.programs[i], verdict);
+	    } else {
+		fprintf(stdout, RESUMED_MSG, jobSpec->testID, verdict);
+	    }
+	}
+	results->verdicts[testNum * numPrograms + i] = verdicts[i];
+	results->successfulTests[i] += verdicts[i] == VERDICT_PASS;
+	results->flakyTests[i] += verdicts[i] == VERDICT_FLAKY;
+	results->limitTests[i] += verdicts[i] == VERDICT_LIMIT;
+	results->runTimes[i] += runTimes[i];
+	allPassed &= verdicts[i] == VERDICT_PASS ||
+		(verdicts[i] == VERDICT_FLAKY && !parameters.strict);
+    }
+    add_run_test(results, testNum);
+    progress_test_done(progress, allPassed, jobSpec->goldenTime);
+    return true;
+}
+
+/* save_checkpoint()
+ * -----------------
+ * Syncs the verdicts of the tests finished so far to the checkpoint file
+ * 	when the program exits, so that an interrupted run can be resumed.
+ *
+ * Returns: void
+ */
+void save_checkpoint(void) {
+    checkpoint_sync(&checkpoint);
+}
+
+/* minimize_testjob()
+ * ------------------
+ * Runs each test once against a program built with --coverage, and writes
+ * 	the fewest tests that keep all of the lines they cover to the job
+ * 	file given with '--minimize', ordered by how many new lines each
+ * 	covers. Tests that share an invocation cover the same lines, so only
+ * 	the first of them is run.
+ *
+ * parameters: a struct containing the program's main parameters including
+ * 	the jobSpecs data struct.
+ *
+ * Returns: Exits with status 0 once the job file is written, or if SIGINT is
+ * 	received.
+ * Errors: Exits with status 13 if the program wrote no coverage data or no
+ * 	line was covered, or with status 6 if the job file cannot be written.
+ */
+void minimize_testjob(ProgramParameters parameters) {
+    load_tests(&parameters, INT_MAX);
+    for (int test = 0; test < parameters.numOfTests; test++) {
+	wait_for_rebuild(parameters, test);
+    }
+    check_interrupt(0, 0);
+
+    // The program writes its coverage data below the test directory rather
+    // than beside its objects.
+    char dataDir[PATH_MAX];
+    snprintf(dataDir, PATH_MAX, "%s/%s", parameters.testDir, COVERAGE_DIR);
+    mkdir(dataDir, S_IRWXU);
+    coverage_discard(dataDir);
+    setenv(COVERAGE_PREFIX_ENV, dataDir, 1);
+
+    CoverageMap map;
+    coverage_start(&map, parameters.numOfTests);
+    bool collected = false;
+    for (int test = 0; test < parameters.numOfTests; test++) {
+	if (parameters.jobSpecs[test].invocation != test) {
+	    continue;
+	}
+	fprintf(stdout, RUN_TEST_MSG, parameters.jobSpecs[test].testID);
+	fflush(stdout);
+	int execError = 0;
+	run_instances(parameters, test, parameters.programs[0], 1, NULL,
+		&execError);
+	check_exec_error(parameters.programs[0], execError);
+	// A job file from some of the tests would not keep all of the lines.
+	if (interrupted) {
+	    exit(OK);
+	}
+	collected |= coverage_collect(&map, test, dataDir);
+	fprintf(stdout, COVERAGE_MSG, parameters.jobSpecs[test].testID,
+		map.numTestLines[test]);
+    }
+    // Data that gcov read without any line run is as good as none.
+    if (!collected || map.numLines == 0) {
+	fprintf(stderr, COVERAGE_ERR_MSG, parameters.programs[0]);
+	exit(COVERAGE_ERR);
+    }
+
+    int* order = malloc(sizeof(int) * parameters.numOfTests);
+    int* gains = malloc(sizeof(int) * parameters.numOfTests);
+    int numKept = coverage_order(&map, order, gains);
+    write_minimized_jobspec(parameters, order, gains, numKept,
+	    map.numLines);
+    fprintf(stdout, MINIMIZE_SUMMARY_MSG, numKept, parameters.numOfTests,
+	    map.numLines);
+    free(order);
+    free(gains);
+    coverage_free(&map);
+    exit(OK);
+}
+
+/* write_minimized_jobspec()
+ * -------------------------
+ * Writes the tests kept by minimizing to the job file given with
+ * 	'--minimize', in the same format as the job file they were read
+ * 	from, with the annotation of each test and a comment with the number
+ * 	of new lines it covers.
+ *
+ * parameters: a struct containing the program's main parameters including
+ * 	the jobSpecs data struct.
+ * order: a pointer to the array of the tests to keep, in order.
+ * gains: a pointer to the array of the number of new lines each covers.
+ * numKept: the number of tests to keep.
+ * numLines: the number of lines covered by all tests.
+ *
+ * Errors: Exits with status 6 if the job file cannot be written.
+ */
+void write_minimized_jobspec(ProgramParameters parameters, int* order,
+	int* gains, int numKept, int numLines) {
+    FILE* file = fopen(parameters.minimize, "w");
+    if (file == NULL) {
+	fprintf(stderr, OUTPUT_FILE_ERR_MSG, parameters.minimize);
+	exit(OUTPUT_FILE_ERR);
+    }
+    fprintf(file, MINIMIZED_HEADER, parameters.jobSpecFilePath,
+	    parameters.programs[0], numKept, parameters.numOfTests, numLines);
+    for (int i = 0; i < numKept; i++) {
+	JobSpecs* jobSpec = &parameters.jobSpecs[order[i]];
+	fprintf(file, MINIMIZED_GAIN, gains[i]);
+	if (jobSpec->compareMode != COMPARE_EXACT || jobSpec->numTags > 0) {
+	    fprintf(file, "%s", ANNOTATION_PREFIX);
+	    if (jobSpec->compareMode != COMPARE_EXACT) {
+		fprintf(file, " %s=%s", COMPARE_OPTION,
+			compare_mode_name(jobSpec->compareMode));
+	    }
+	    char* tag = jobSpec->tags;
+	    for (int j = 0; j < jobSpec->numTags; j++) {
+		if (j == 0) {
+		    fprintf(file, " %s=%s", TAGS_OPTION, tag);
+		} else {
+		    fprintf(file, "%c%s", TAG_SEPARATOR, tag);
+		}
+		tag += strlen(tag) + 1;
+	    }
+	    fprintf(file, "\n");
+	}
+	fprintf(file, "%s\t%s", jobSpec->testID, jobSpec->inputFile);
+	for (int j = 1; jobSpec->args[j] != NULL; j++) {
+	    fprintf(file, "\t%s", jobSpec->args[j]);
+	}
+	fprintf(file, "\n");
+    }
+    if (fclose(file) != 0) {
+	fprintf(stderr, OUTPUT_FILE_ERR_MSG, parameters.minimize);
+	exit(OUTPUT_FILE_ERR);
+    }
+}
+
+/* report_results()
+ * ----------------
+ * Prints the number of successful tests, and of flaky tests if there are
+ * 	any. With several candidate programs, prints a matrix of which tests
+ * 	each passed, then the number of successful tests and the total run
+ * 	time of each.
+ *
+ * parameters: a struct containing the program's main parameters including
+ * 	the jobSpecs data struct and the candidate programs.
+ * results: a pointer to the struct with the results of the tests run.
+ *
+ * Errors: Exits with status 9 if no tests were done.
+ */
+void report_results(ProgramParameters parameters, TestResults* results) {
+    if (results->numOfRunTests == 0) {
+	fprintf(stdout, NO_TEST_MSG);
+	exit(NO_TESTS);
+    }
+    int numPrograms = parameters.numPrograms;
+    if (numPrograms == 1) {
+	fprintf(stdout, SUCCESSFUL_TEST_MSG, results->successfulTests[0],
+		results->numOfRunTests);
+	if (results->flakyTests[0] > 0) {
+	    fprintf(stdout, FLAKY_SUMMARY_MSG, results->flakyTests[0]);
+	}
+	if (results->limitTests[0] > 0) {
+	    fprintf(stdout, LIMIT_SUMMARY_MSG, results->limitTests[0]);
+	}
+	if (parameters.counters) {
+	    char change[COUNTERS_BUFFER];
+	    perf_format_change(change, COUNTERS_BUFFER, results->counterTotals,
+		    results->counterTotals + PERF_NUM_COUNTERS);
+	    fprintf(stdout, COUNTERS_SUMMARY_MSG, change);
+	}
+	report_stress(NULL, results->stressLevels, results->numStressLevels);
+	return;
+    }
+
+    fprintf(stdout, MATRIX_HEADER);
+    for (int i = 0; i < numPrograms; i++) {
+	fprintf(stdout, "\t%s", parameters.programs[i]);
+    }
+    fprintf(stdout, "\n");
+    for (int run = 0; run < results->numOfRunTests; run++) {
+	int test = results->runTests[run];
+	fprintf(stdout, "%s", parameters.jobSpecs[test].testID);
+	for (int i = 0; i < numPrograms; i++) {
+	    char* verdictNames[] = {MATRIX_PASS, MATRIX_FAIL, MATRIX_FLAKY,
+		    MATRIX_LIMIT};
+	    fprintf(stdout, "\t%s",
+		    verdictNames[results->verdicts[test * numPrograms + i]]);
+	}
+	fprintf(stdout, "\n");
+    }
+    for (int i = 0; i < numPrograms; i++) {
+	fprintf(stdout, CANDIDATE_SUMMARY_MSG, parameters.programs[i],
+		results->successfulTests[i], results->numOfRunTests,
+		results->runTimes[i]);
+	if (results->flakyTests[i] > 0) {
+	    fprintf(stdout, CANDIDATE_FLAKY_SUMMARY_MSG,
+		    parameters.programs[i], results->flakyTests[i]);
+	}
+	if (results->limitTests[i] > 0) {
+	    fprintf(stdout, CANDIDATE_LIMIT_SUMMARY_MSG,
+		    parameters.programs[i], results->limitTests[i]);
+	}
+	if (parameters.counters) {
+	    char change[COUNTERS_BUFFER];
+	    perf_format_change(change, COUNTERS_BUFFER,
+		    results->counterTotals + i * PERF_NUM_COUNTERS,
+		    results->counterTotals + numPrograms * PERF_NUM_COUNTERS);
+	    fprintf(stdout, CANDIDATE_COUNTERS_SUMMARY_MSG,
+		    parameters.programs[i], change);
+	}
+	report_stress(parameters.programs[i],
+		results->stressLevels + i * STRESS_MAX_LEVELS,
+		results->numStressLevels);
+    }
+}
+
+/* report_stress()
+ * ---------------
+ * Prints the throughput and latency of a candidate program at each number
+ * 	of instances run at once with '--stress', with the throughput as a
+ * 	multiple of that of one instance.
+ *
+ * candidate: the candidate program, or NULL if there is only one.
+ * levels: a pointer to the array of structs of each number of instances.
+ * numLevels: the number of levels, which is 0 without '--stress'.
+ *
+ * Returns: void
+ */
+void report_stress(char* candidate, StressLevel* levels, int numLevels) {
+    double single = numLevels > 0 ? stress_throughput(&levels[0]) : 0;
+    for (int i = 0; i < numLevels; i++) {
+	StressLevel* level = &levels[i];
+	if (level->numRuns == 0) {
+	    continue;
+	}
+	double throughput = stress_throughput(level);
+	double scaling = single > 0 ? throughput / single : 0;
+	if (candidate != NULL) {
+	    fprintf(stdout, CANDIDATE_STRESS_SUMMARY_MSG, candidate,
+		    level->numInstances, throughput, scaling,
+		    stress_percentile(level, 0.5),
+		    stress_percentile(level, 0.99), level->numFailed,
+		    level->numRuns);
+	} else {
+	    fprintf(stdout, STRESS_SUMMARY_MSG, level->numInstances,
+		    throughput, scaling, stress_percentile(level, 0.5),
+		    stress_percentile(level, 0.99), level->numFailed,
+		    level->numRuns);
+	}
+    }
+}
+
+/* report_stress_failed()
+ * ----------------------
+ * Prints how many instances of a test failed when run at once with
+ * 	'--stress'.
+ *
+ * testID: a pointer to the array with the ID of the test.
+ * candidate: the candidate program that was tested, or NULL if there is only
+ * 	one.
+ * numFailed: the number of instances that failed.
+ * levels: a pointer to the array of structs of each number of instances.
+ * numLevels: the number of levels the test was run at.
+ *
+ * Returns: void
+ */
+void report_stress_failed(char* testID, char* candidate, int numFailed,
+	StressLevel* levels, int numLevels) {
+    int numInstances = 0;
+    for (int i = 0; i < numLevels; i++) {
+	numInstances += levels[i].numInstances;
+    }
+    if (candidate != NULL) {
+	fprintf(stdout, CANDIDATE_STRESS_FAILED_MSG, testID, candidate,
+		numFailed, numInstances);
+    } else {
+	fprintf(stdout, STRESS_FAILED_MSG, testID, numFailed, numInstances);
+    }
+    fflush(stdout);
+}
+
+/* test_selected()
+ * ---------------
+ * Checks if a test was selected to run with '--select'.
+ *
+ * parameters: a struct containing the program's main parameters including
+ * 	the jobSpecs data struct and the pattern of tests to select.
+ * testNum: the 'n'th test to check.
+ *
+ * Returns: true if no pattern was given or the test matches it, else returns
+ * 	false.
+ */
+bool test_selected(ProgramParameters parameters, int testNum) {
+    return parameters.select == NULL ||
+	    test_matches(parameters.select, &parameters.jobSpecs[testNum]);
+}
+
+/* test_matches()
+ * --------------
+ * Checks if a test's ID or any of its tags match a shell wildcard pattern.
+ *
+ * pattern: a pointer to the array with the pattern.
+ * jobSpec: a pointer to the struct of the test.
+ *
+ * Returns: true if the test matches, else returns false.
+ */
+bool test_matches(char* pattern, JobSpecs* jobSpec) {
+    if (fnmatch(pattern, jobSpec->testID, 0) == 0) {
+	return true;
+    }
+    char* tag = jobSpec->tags;
+    for (int i = 0; i < jobSpec->numTags; i++) {
+	if (fnmatch(pattern, tag, 0) == 0) {
+	    return true;
+	}
+	tag += strlen(tag) + 1;
+    }
+    return false;
+}
+
+/* run_invocation()
+ * ----------------
+ * Runs the specified test against each candidate program, up to '--jobs' of
+ * 	them at once, and gets the exit statuses of their processes.
+ *
+ * parameters: a struct containing the program's main parameters including
+ * 	the jobSpecs data struct.
+ * testNum: the 'n'th test to conduct.
+ * exitCodes: a pointer to an array to store the exit statuses of the three
+ * 	processes of each candidate in.
+ * execErrors: a pointer to an array to store the errno of each candidate
+ * 	that could not be executed in, or 0 if it was.
+ * usages: a pointer to an array to store the time and memory each candidate
+ * 	used in.
+ * counts: a pointer to an array to store the hardware counters of each
+ * 	candidate and then good-uqwordladder in, or NULL if they are not
+ * 	counted.
+ *
+ * Returns: void, as soon as SIGINT is received.
+ */
+void run_invocation(ProgramParameters parameters, int testNum,
+	int* exitCodes, int* execErrors, Usage* usages, long long* counts) {
+    int numPids = TOTAL_PIDS * parameters.numPrograms;
+    pid_t pid[numPids];
+    int statuses[numPids];
+    double elapsed[numPids];
+    struct rusage processUsages[numPids];
+    PerfCounters counters[parameters.numPrograms];
+    MemoryCgroup cgroups[parameters.numPrograms];
+    for (int i = 0; i < parameters.numPrograms; i++) {
+	cgroups[i].fd = -1;
+    }
+
+    for (int first = 0; first < parameters.numPrograms && !interrupted;
+	    first += parameters.jobs) {
+	int last = first + parameters.jobs;
+	if (last > parameters.numPrograms) {
+	    last = parameters.numPrograms;
+	}
+	for (int i = first; i < last; i++) {
+	    // A program dropped from the run fails without being executed.
+	    if (parameters.programErrors[i] != 0) {
+		execErrors[i] = parameters.programErrors[i];
+		memset(pid + i * TOTAL_PIDS, 0, sizeof(pid_t) * TOTAL_PIDS);
+		continue;
+	    }
+	    // Make two pipes
+	    int outputPipe[2];
+	    int errorPipe[2];
+	    pipe(outputPipe);
+	    pipe(errorPipe);
+
+	    // Create a process for uqwordladder, cmp for stdout, and cmp for 
+	    // stderr.
+	    execErrors[i] = run_three_processes(parameters,
+		    pid + i * TOTAL_PIDS, outputPipe, errorPipe, testNum,
+		    parameters.programs[i],
+		    counts != NULL ? &counters[i] : NULL, &cgroups[i]);
+	}
+
+	// Wait up to the test's timeout for the processes to finish, and kill
+	// any still running.
+	wait_test_processes(pid + first * TOTAL_PIDS,
+		(last - first) * TOTAL_PIDS, parameters.jobSpecs[testNum].timeout,
+		statuses + first * TOTAL_PIDS, elapsed + first * TOTAL_PIDS,
+		processUsages + first * TOTAL_PIDS);
+    }
+    if (interrupted) {
+	for (int i = 0; i < parameters.numPrograms; i++) {
+	    bool oomKilled;
+	    long peakKb;
+	    cgroup_finish(&cgroups[i], &oomKilled, &peakKb);
+	}
+	return;
+    }
+
+    // Get exit statuses
+    for (int i = 0; i < parameters.numPrograms; i++) {
+	int uqwordladder = i * TOTAL_PIDS + UQWORDLADDER_PID;
+	get_usage(&processUsages[uqwordladder], elapsed[uqwordladder],
+		&cgroups[i], &usages[i]);
+	get_exit_codes(parameters, testNum, statuses + i * TOTAL_PIDS,
+		elapsed + i * TOTAL_PIDS, &usages[i],
+		exitCodes + i * TOTAL_PIDS);
+	if (execErrors[i] != 0) {
+	    exitCodes[uqwordladder] = EXEC_FAILED;
+	}
+	if (counts != NULL && parameters.programErrors[i] != 0) {
+	    memset(counts + i * PERF_NUM_COUNTERS, 0,
+		    sizeof(long long) * PERF_NUM_COUNTERS);
+	} else if (counts != NULL) {
+	    perf_read(&counters[i], counts + i * PERF_NUM_COUNTERS);
+	}
+    }
+
+    // Count good-uqwordladder on its own, after the candidates, so that they
+    // do not disturb each other's counts.
+    if (counts != NULL) {
+	measure_gooduqwordladder(parameters, testNum,
+		counts + parameters.numPrograms * PERF_NUM_COUNTERS);
+    }
+}
+
+/* measure_gooduqwordladder()
+ * --------------------------
+ * Runs good-uqwordladder for a test, discarding its output, to read its
+ * 	hardware counters.
+ *
+ * parameters: a struct containing the program's main parameters including
+ * 	the jobSpecs data struct.
+ * testNum: the 'n'th test to run.
+ * counts: a pointer to the array to store the counters in.
+ *
+ * Returns: void
+ */
+void measure_gooduqwordladder(ProgramParameters parameters, int testNum,
+	long long* counts) {
+    JobSpecs* jobSpec = &parameters.jobSpecs[testNum];
+    PerfCounters counters;
+    int inputPipe[2];
+    make_input_pipe(jobSpec, inputPipe);
+    pid_t pid[2];
+    pid[0] = fork_counted_process(&counters);
+    if (pid[0] == 0) {
+	int in = open_input(jobSpec, inputPipe);
+	int out = open(NULL_DEVICE, O_WRONLY);
+	dup2(in, STDIN_FILENO);
+	dup2(out, STDOUT_FILENO);
+	dup2(out, STDERR_FILENO);
+	close(in);
+	close(out);
+	jobSpec->args[0] = GOOD_UQWORDLADDER;
+	execvp(jobSpec->args[0], jobSpec->args);
+	_exit(UNEXPECTED_ERR);
+    }
+    // The generator was checked when the expected output was rebuilt.
+    pid[1] = pid[0] > 0 ? start_generator(jobSpec, inputPipe, pid[0]) : 0;
+    int statuses[2];
+    double elapsed[2];
+    wait_test_processes(pid, 2, jobSpec->timeout, statuses, elapsed, NULL);
+    perf_read(&counters, counts);
+}
+
+/* add_counts()
+ * ------------
+ * Adds hardware counters to totals. A total becomes unavailable if any of
+ * 	its counts is.
+ *
+ * totals: a pointer to the array with the totals.
+ * counts: a pointer to the array with the counts to add.
+ *
+ * Returns: void
+ */
+void add_counts(long long* totals, long long* counts) {
+    for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+	if (totals[i] == PERF_UNAVAILABLE || counts[i] == PERF_UNAVAILABLE) {
+	    totals[i] = PERF_UNAVAILABLE;
+	} else {
+	    totals[i] += counts[i];
+	}
+    }
+}
+
+/* report_counters()
+ * -----------------
+ * Prints how the hardware counters of a program differ from those of
+ * 	good-uqwordladder for a test.
+ *
+ * testID: the ID of the test.
+ * candidate: the candidate program that was tested, or NULL if there is only
+ * 	one.
+ * counts: a pointer to the array with the program's counters.
+ * reference: a pointer to the array with good-uqwordladder's counters.
+ *
+ * Returns: void
+ */
+void report_counters(char* testID, char* candidate, long long* counts,
+	long long* reference) {
+    char change[COUNTERS_BUFFER];
+    perf_format_change(change, COUNTERS_BUFFER, counts, reference);
+    if (candidate != NULL) {
+	fprintf(stdout, CANDIDATE_COUNTERS_MSG, testID, candidate, change);
+    } else {
+	fprintf(stdout, COUNTERS_MSG, testID, change);
+    }
+    fflush(stdout);
+}
+
+/* run_instances()
+ * ---------------
+ * Runs several instances of a test against a candidate program all at once,
+ * 	sharing its input file. Failed tests are run again this way for
+ * 	'--retries', so that the retries take about as long as the test did,
+ * 	and passed tests for '--stress'.
+ *
+ * parameters: a struct containing the program's main parameters including
+ * 	the jobSpecs data struct.
+ * testNum: the 'n'th test to run.
+ * program: the candidate program to run it against.
+ * numInstances: the number of instances to run.
+ * latencies: a pointer to an array to store the run time of each instance
+ * 	of the program in, or NULL.
+ * execError: a pointer to store the errno of exec in if the program could
+ * 	not be executed for any instance, which is otherwise left alone.
+ *
+ * Returns: the number of instances that passed, as soon as SIGINT is
+ * 	received.
+ */
+int run_instances(ProgramParameters parameters, int testNum, char* program,
+	int numInstances, double* latencies, int* execError) {
+    int numPids = TOTAL_PIDS * numInstances;
+    pid_t pid[numPids];
+    int statuses[numPids];
+    double elapsed[numPids];
+    struct rusage processUsages[numPids];
+    MemoryCgroup cgroups[numInstances];
+    int execErrors[numInstances];
+    for (int instance = 0; instance < numInstances; instance++) {
+	int outputPipe[2];
+	int errorPipe[2];
+	pipe(outputPipe);
+	pipe(errorPipe);
+	execErrors[instance] = run_three_processes(parameters,
+		pid + instance * TOTAL_PIDS, outputPipe, errorPipe, testNum,
+		program, NULL, &cgroups[instance]);
+    }
+    double timeout = parameters.jobSpecs[testNum].timeout;
+    wait_test_processes(pid, numPids, timeout, statuses, elapsed,
+	    processUsages);
+
+    Usage usages[numInstances];
+    for (int instance = 0; instance < numInstances; instance++) {
+	int uqwordladder = instance * TOTAL_PIDS + UQWORDLADDER_PID;
+	get_usage(&processUsages[uqwordladder], elapsed[uqwordladder],
+		&cgroups[instance], &usages[instance]);
+	if (latencies != NULL) {
+	    latencies[instance] = elapsed[uqwordladder];
+	}
+    }
+    return count_passed_instances(parameters, testNum, numInstances,
+	    statuses, elapsed, usages, execErrors, execError);
+}
+
+/* count_passed_instances()
+ * ------------------------
+ * Counts how many of several instances of a test run against a program
+ * 	passed.
+ *
+ * parameters: a struct containing the program's main parameters including
+ * 	the jobSpecs data struct and the limits the program was run with.
+ * testNum: the 'n'th test that was run.
+ * numInstances: the number of instances.
+ * statuses: a pointer to the array with the wait status of the three
+ * 	processes of each instance.
+ * elapsed: a pointer to the array with how long each process ran for.
+ * usages: a pointer to the array with the resources used by the program in
+ * 	each instance.
+ * execErrors: a pointer to the array with the errno of exec of each
+ * 	instance, or 0 if it was executed.
+ * execError: a pointer to store the errno of exec in if the program could
+ * 	not be executed for any instance, which is otherwise left alone.
+ *
+ * Returns: the number of instances that passed.
+ */
+int count_passed_instances(ProgramParameters parameters, int testNum,
+	int numInstances, int* statuses, double* elapsed, Usage* usages,
+	int* execErrors, int* execError) {
+    int numPassed = 0;
+    for (int instance = 0; instance < numInstances; instance++) {
+	int exitCodes[TOTAL_PIDS];
+	int first = instance * TOTAL_PIDS;
+	get_exit_codes(parameters, testNum, statuses + first, elapsed + first,
+		&usages[instance], exitCodes);
+	if (execErrors[instance] != 0) {
+	    exitCodes[UQWORDLADDER_PID] = EXEC_FAILED;
+	    *execError = execErrors[instance];
+	}
+	numPassed += count_matches(parameters.jobSpecs, testNum, exitCodes) ==
+		REQUIRED_MATCHES;
+    }
+    return numPassed;
+}
+
+/* queue_retries()
+ * ---------------
+ * Queues a failed test to be run again against a candidate program in the
+ * 	background for '--retries', and starts it at once if fewer than
+ * 	'--jobs' retries are running.
+ *
+ * testNum: the 'n'th test to run.
+ * program: the candidate program to run it against.
+ * numPassed: a pointer to store the number of retries that passed in once
+ * 	they have all finished.
+ * execError: a pointer to store the errno of exec in if the program could
+ * 	not be executed for any retry, which is otherwise left alone.
+ *
+ * Returns: void
+ */
+void queue_retries(int testNum, char* program, int* numPassed,
+	int* execError) {
+    RetryRequest* request = &retries.waiting[retries.numWaiting++];
+    request->testNum = testNum;
+    request->program = program;
+    request->numPassed = numPassed;
+    request->execError = execError;
+    start_retries();
+}
+
+/* start_retries()
+ * ---------------
+ * Starts the retries waiting in the queue while fewer than '--jobs' are
+ * 	running, each running all instances of the test at once like
+ * 	run_instances().
+ *
+ * Returns: void
+ */
+void start_retries(void) {
+    ProgramParameters parameters = retries.parameters;
+    while (!interrupted && retries.numRuns < parameters.jobs &&
+	    retries.nextWaiting < retries.numWaiting) {
+	RetryRequest* request = &retries.waiting[retries.nextWaiting++];
+	RetryRun* run = &retries.runs[retries.numRuns++];
+	run->testNum = request->testNum;
+	run->numInstances = parameters.retries;
+	run->numRunning = 0;
+	run->numPassed = request->numPassed;
+	run->execError = request->execError;
+	for (int instance = 0; instance < run->numInstances; instance++) {
+	    int outputPipe[2];
+	    int errorPipe[2];
+	    pipe(outputPipe);
+	    pipe(errorPipe);
+	    pid_t* pid = run->pid + instance * TOTAL_PIDS;
+	    run->execErrors[instance] = run_three_processes(parameters, pid,
+		    outputPipe, errorPipe, run->testNum, request->program,
+		    NULL, &run->cgroups[instance]);
+	    // A process that could not be created counts as failing to
+	    // execute.
+	    for (int i = 0; i < TOTAL_PIDS; i++) {
+		run->statuses[instance * TOTAL_PIDS + i] =
+			W_EXITCODE(UNEXPECTED_ERR, 0);
+		run->elapsed[instance * TOTAL_PIDS + i] = 0;
+		memset(&run->usages[instance * TOTAL_PIDS + i], 0,
+			sizeof(struct rusage));
+		run->numRunning += pid[i] > 0;
+	    }
+	}
+	clock_gettime(CLOCK_MONOTONIC, &run->started);
+	set_deadline(&run->deadline, &run->started,
+		parameters.jobSpecs[run->testNum].timeout);
+	if (run->numRunning == 0) {
+	    complete_retries(retries.numRuns - 1);
+	}
+    }
+}
+
+/* finish_retry()
+ * --------------
+ * Records the status of a reaped child process if it was running a retry,
+ * 	and completes the retries it was one of once they have all finished.
+ *
+ * pid: the pid of the reaped child process.
+ * status: the wait status of the process.
+ * usage: a pointer to the resources used by the process.
+ *
+ * Returns: true if the process was running a retry, else returns false.
+ */
+bool finish_retry(pid_t pid, int status, struct rusage* usage) {
+    for (int i = 0; i < retries.numRuns; i++) {
+	RetryRun* run = &retries.runs[i];
+	for (int j = 0; j < run->numInstances * TOTAL_PIDS; j++) {
+	    if (run->pid[j] != pid) {
+		continue;
+	    }
+	    run->statuses[j] = status;
+	    run->elapsed[j] = seconds_since(&run->started);
+	    run->usages[j] = *usage;
+	    run->pid[j] = 0;
+	    if (--run->numRunning == 0) {
+		complete_retries(i);
+		start_retries();
+	    }
+	    return true;
+	}
+    }
+    return false;
+}
+
+/* complete_retries()
+ * ------------------
+ * Stores the number of retries that passed once all of them have finished,
+ * 	and removes them from those running, so that the next waiting
+ * 	retries can be started.
+ *
+ * run: the index of the retries among those running.
+ *
+ * Returns: void
+ */
+void complete_retries(int run) {
+    RetryRun* retryRun = &retries.runs[run];
+    Usage usages[MAX_RETRIES];
+    for (int instance = 0; instance < retryRun->numInstances; instance++) {
+	int uqwordladder = instance * TOTAL_PIDS + UQWORDLADDER_PID;
+	get_usage(&retryRun->usages[uqwordladder],
+		retryRun->elapsed[uqwordladder],
+		&retryRun->cgroups[instance], &usages[instance]);
+    }
+    *retryRun->numPassed = count_passed_instances(retries.parameters,
+	    retryRun->testNum, retryRun->numInstances, retryRun->statuses,
+	    retryRun->elapsed, usages, retryRun->execErrors,
+	    retryRun->execError);
+    retries.runs[run] = retries.runs[--retries.numRuns];
+}
+
+/* kill_retry_run()
+ * ----------------
+ * Kills and reaps the processes of a test's retries that are still running.
+ *
+ * run: a pointer to the struct of the retries.
+ *
+ * Returns: void
+ */
+void kill_retry_run(RetryRun* run) {
+    pid_t running[MAX_RETRIES * TOTAL_PIDS];
+    int runningIndex[MAX_RETRIES * TOTAL_PIDS];
+    int numRunning = 0;
+    for (int i = 0; i < run->numInstances * TOTAL_PIDS; i++) {
+	if (run->pid[i] > 0) {
+	    running[numRunning] = run->pid[i];
+	    runningIndex[numRunning++] = i;
+	}
+    }
+    int killedStatuses[MAX_RETRIES * TOTAL_PIDS];
+    kill_processes(running, numRunning, killedStatuses);
+    double killedElapsed = seconds_since(&run->started);
+    for (int i = 0; i < numRunning; i++) {
+	run->statuses[runningIndex[i]] = killedStatuses[i];
+	run->elapsed[runningIndex[i]] = killedElapsed;
+	run->pid[runningIndex[i]] = 0;
+    }
+    run->numRunning = 0;
+}
+
+/* expire_retries()
+ * ----------------
+ * Kills the retries still running at their test's timeout, completes them
+ * 	and starts the next waiting retries in their place.
+ *
+ * Returns: true if any retries were killed, else returns false.
+ */
+bool expire_retries(void) {
+    bool expired = false;
+    for (int i = retries.numRuns - 1; i >= 0; i--) {
+	if (seconds_since(&retries.runs[i].deadline) < 0) {
+	    continue;
+	}
+	kill_retry_run(&retries.runs[i]);
+	complete_retries(i);
+	expired = true;
+    }
+    start_retries();
+    return expired;
+}
+
+/* retry_deadline()
+ * ----------------
+ * Finds the time to stop waiting for a child process at, so that the
+ * 	retries running in the background are killed at their test's timeout.
+ *
+ * deadline: a pointer to the monotonic time to stop waiting at, or NULL to
+ * 	wait without a time limit.
+ * earliest: a pointer to store the timeout of the retries in if it is
+ * 	before the deadline.
+ *
+ * Returns: the deadline or the earliest timeout of the retries, whichever
+ * 	is first, or NULL if there is neither.
+ */
+struct timespec* retry_deadline(struct timespec* deadline,
+	struct timespec* earliest) {
+    for (int i = 0; i < retries.numRuns; i++) {
+	struct timespec* timeout = &retries.runs[i].deadline;
+	if (deadline == NULL || timeout->tv_sec < deadline->tv_sec ||
+		(timeout->tv_sec == deadline->tv_sec &&
+		timeout->tv_nsec < deadline->tv_nsec)) {
+	    *earliest = *timeout;
+	    deadline = earliest;
+	}
+    }
+    return deadline;
+}
+
+/* wait_for_retries()
+ * ------------------
+ * Waits until every retry has finished, including those waiting to start,
+ * 	while the rebuilds of expected output go on.
+ *
+ * Returns: void, as soon as SIGINT is received.
+ */
+void wait_for_retries(void) {
+    while (retries.numRuns > 0 && !interrupted) {
+	int status;
+	struct rusage usage;
+	struct timespec earliest;
+	pid_t finished = wait_for_child(&status, retry_deadline(NULL,
+		&earliest), &usage);
+	if (finished < 0) {
+	    break;
+	}
+	if (finished == 0) {
+	    expire_retries();
+	} else if (!finish_retry(finished, status, &usage)) {
+	    finish_rebuild(finished, status, &usage);
+	}
+    }
+}
+
+/* cancel_retries()
+ * ----------------
+ * Kills the retries still running in the background when the program exits,
+ * 	and drops those waiting to start. Only the process that started them
+ * 	does this, not any child process that exits.
+ *
+ * Returns: void
+ */
+void cancel_retries(void) {
+    if (getpid() != retries.owner) {
+	return;
+    }
+    for (int i = 0; i < retries.numRuns; i++) {
+	RetryRun* run = &retries.runs[i];
+	kill_retry_run(run);
+	for (int instance = 0; instance < run->numInstances; instance++) {
+	    bool oomKilled;
+	    long peakKb;
+	    cgroup_finish(&run->cgroups[instance], &oomKilled, &peakKb);
 	}
     }
+    retries.numRuns = 0;
+    retries.nextWaiting = retries.numWaiting;
 }
 
-/* run_testjob()
+/* stress_test()
  * -------------
- * Runs all tests specified in the job specifications file and reports results
+ * Runs a test that passed against a candidate program as each number of
+ * 	instances at once in turn, from one up to '--stress', and adds their
+ * 	throughput and latency to those of the other tests.
  *
- * parameters: a struct containing the program's main parameters including 
+ * parameters: a struct containing the program's main parameters including
  * 	the jobSpecs data struct.
+ * testNum: the 'n'th test to run.
+ * program: the candidate program to run it against.
+ * levels: a pointer to the array of structs of each number of instances.
+ * numLevels: the number of levels.
+ * execError: a pointer to store the errno of exec in if the program could
+ * 	not be executed for any instance, which is otherwise left alone.
  *
- * Errors: Exits with status 18 if a test fails, or exits with status 9 if
- * 	no tests were done.
+ * Returns: the number of instances that failed, as soon as SIGINT is
+ * 	received.
  */
-void run_testjob(ProgramParameters parameters) {
-    JobSpecs* jobSpecs = parameters.jobSpecs;
-    int numOfTests = parameters.numOfTests;
-    int numOfRunTests = 0;
-    int successfulTests = 0;
-    // Setup signal handler to detect SIGINT.
-    struct sigaction interrupt;
-    interrupt.sa_handler = interrupt_handler;
-    sigaction(SIGINT, &interrupt, 0);
-    memset(&interrupt, 0, sizeof(struct sigaction));
-
-    for (int test = 0; test < numOfTests; test++) {
-	fprintf(stdout, RUN_TEST_MSG, jobSpecs[test].testID);
-	fflush(stdout);
-	pid_t pid[TOTAL_PIDS];
-	// Make two pipes
-	int outputPipe[2];
-	int errorPipe[2];
-	pipe(outputPipe);
-	pipe(errorPipe);
-
-	// Create a process for uqwordladder, cmp for stdout, and cmp for 
-	// stderr.
-	run_three_processes(parameters, pid, outputPipe, errorPipe, test);
-
-	// Wait 1.5 seconds, kill all child processes, and check if the test
-	// was interrupted by SIGINT.
-	usleep(TEST_DELAY);
-	kill_processes(pid);
-	check_interrupt(pid, successfulTests, numOfRunTests);
-	numOfRunTests++;
-
-	// Use wait and get exit statuses
-	int* exitCodes = get_exit_codes(pid);
-
-	// Check if processes were successful and stdout, stderr, and exit
-	// statuses match. Success will be 3 if all match.
-	int success = report_cmp_results(jobSpecs, test, exitCodes);
-	if (success == REQUIRED_MATCHES) {
-	    successfulTests++;
+int stress_test(ProgramParameters parameters, int testNum, char* program,
+	StressLevel* levels, int numLevels, int* execError) {
+    int numFailed = 0;
+    for (int i = 0; i < numLevels && !interrupted; i++) {
+	int numInstances = levels[i].numInstances;
+	double latencies[numInstances];
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	int numPassed = run_instances(parameters, testNum, program,
+		numInstances, latencies, execError);
+	if (interrupted) {
+	    break;
 	}
-	free(exitCodes);
+	stress_add(&levels[i], latencies, numInstances - numPassed,
+		seconds_since(&start));
+	numFailed += numInstances - numPassed;
     }
-    free_program_parameters(parameters);
+    return numFailed;
+}
 
-    // Print number of successful tests
-    fprintf(stdout, SUCCESSFUL_TEST_MSG, successfulTests, numOfRunTests);
-    if (successfulTests != numOfTests) {
-	exit(UNSUCCESSFUL_TESTS);
+/* report_retries()
+ * ----------------
+ * Prints whether a failed test is flaky, passing some of its retries, or
+ * 	failed all of them.
+ *
+ * parameters: a struct containing the program's main parameters including
+ * 	the jobSpecs data struct.
+ * testNum: the 'n'th test to report the retries of.
+ * candidate: the candidate program that was tested, or NULL if there is only
+ * 	one.
+ * numPassed: the number of retries that passed.
+ *
+ * Returns: void
+ */
+void report_retries(ProgramParameters parameters, int testNum,
+	char* candidate, int numPassed) {
+    char* testID = parameters.jobSpecs[testNum].testID;
+    if (numPassed > 0 && candidate != NULL) {
+	fprintf(stdout, CANDIDATE_FLAKY_MSG, testID, candidate, numPassed,
+		parameters.retries);
+    } else if (numPassed > 0) {
+	fprintf(stdout, FLAKY_MSG, testID, numPassed, parameters.retries);
+    } else if (candidate != NULL) {
+	fprintf(stdout, CANDIDATE_RETRIES_FAILED_MSG, testID, candidate,
+		parameters.retries);
+    } else {
+	fprintf(stdout, RETRIES_FAILED_MSG, testID, parameters.retries);
     }
+    fflush(stdout);
 }
 
 /* run_three_processes()
  * ---------------------
  * Creates three processes and two pipes to run uqwordladder and redirect its
- * 	stdout and stderr to be input for the two cmp processes.
+ * 	stdout and stderr to be input for the two cmp processes. The
+ * 	generator of the test's input is run by the process comparing
+ * 	stdout, which waits for it and fails if the generator does.
  *
  * parameters: a struct containing the program's main parameters including
  * 	the jobSpecs data struct.
@@ -960,29 +4416,70 @@ void run_testjob(ProgramParameters parameters) {
  * errorPipe: a pointer to the array for the pipe that carries stderr from
  * 	uqwordladder process to the other cmp process.
  * testNum: the 'n'th test to conduct.
+ * program: the candidate program to test.
+ * counters: a pointer to the struct to attach hardware counters to
+ * 	uqwordladder with, or NULL to not count it.
+ * cgroup: a pointer to the struct to store the cgroup limiting the memory
+ * 	of uqwordladder in, whose fd is -1 if it has none.
  *
- * Returns: void
+ * Returns: 0 if uqwordladder was executed, or the errno of fork or exec if it
+ * 	could not be, which is known before the cmp processes are created.
  */
-void run_three_processes(ProgramParameters parameters, pid_t* pid,
-	int* outputPipe, int* errorPipe, int testNum) {
-    // Create a process to run uqwordladder
-    pid[UQWORDLADDER_PID] = fork();
+int run_three_processes(ProgramParameters parameters, pid_t* pid,
+	int* outputPipe, int* errorPipe, int testNum, char* program,
+	PerfCounters* counters, MemoryCgroup* cgroup) {
+    // Make a pipe that is closed when uqwordladder is executed, or is sent
+    // the errno of exec if it cannot be.
+    int statusPipe[2];
+    if (pipe(statusPipe) == -1) {
+	statusPipe[READ_END] = -1;
+	statusPipe[WRITE_END] = -1;
+    }
+    fcntl(statusPipe[READ_END], F_SETFD, FD_CLOEXEC);
+    fcntl(statusPipe[WRITE_END], F_SETFD, FD_CLOEXEC);
+
+    // Create a process to run uqwordladder, in a cgroup of its own if one
+    // limits its memory.
+    int inputPipe[2];
+    make_input_pipe(&parameters.jobSpecs[testNum], inputPipe);
+    cgroup->fd = -1;
+    if (parameters.memoryCgroups) {
+	cgroup_create(cgroup, (long long) parameters.memLimit * BYTES_PER_MB);
+    }
+    pid[UQWORDLADDER_PID] = counters != NULL ?
+	    fork_counted_process(counters) : fork_process();
     if (!pid[UQWORDLADDER_PID]) {
-	run_uqwordladder(parameters, outputPipe, errorPipe, testNum);
+	close(statusPipe[READ_END]);
+	run_uqwordladder(parameters, inputPipe, outputPipe, errorPipe,
+		testNum, program, statusPipe[WRITE_END], cgroup);
+    }
+    close(inputPipe[READ_END]);
+    inputPipe[READ_END] = -1;
+    int execError = pid[UQWORDLADDER_PID] < 0 ? errno : 0;
+    close(statusPipe[WRITE_END]);
+    while (pid[UQWORDLADDER_PID] > 0 && read(statusPipe[READ_END],
+	    &execError, sizeof(execError)) == -1 && errno == EINTR) {
     }
+    close(statusPipe[READ_END]);
 
-    // Create a process to run cmp to compare stdout
-    pid[STDOUT_PID] = fork();
+    // Create a process to run cmp to compare stdout, and the generator
+    pid[STDOUT_PID] = fork_process();
     if (!pid[STDOUT_PID]) {
+	pid_t generator = pid[UQWORDLADDER_PID] > 0 ?
+		start_generator(&parameters.jobSpecs[testNum], inputPipe, 0) :
+		0;
 	run_cmp(errorPipe, outputPipe,
-		parameters.jobSpecs[testNum].outputFile);
+		parameters.jobSpecs[testNum].outputFile,
+		parameters.jobSpecs[testNum].compareMode, generator);
     }
+    close(inputPipe[WRITE_END]);
 
     // Create a process to run cmp to compare stderr
-    pid[STDERR_PID] = fork();
+    pid[STDERR_PID] = fork_process();
     if (!pid[STDERR_PID]) {
 	run_cmp(outputPipe, errorPipe,
-		parameters.jobSpecs[testNum].errorFile);
+		parameters.jobSpecs[testNum].errorFile,
+		parameters.jobSpecs[testNum].compareMode, 0);
     }
 
     // Close both pipes for parent process.
@@ -990,6 +4487,7 @@ void run_three_processes(ProgramParameters parameters, pid_t* pid,
     close(outputPipe[READ_END]);
     close(errorPipe[WRITE_END]);
     close(errorPipe[READ_END]);
+    return execError;
 }
 
 /* run_uqwordladder()
@@ -999,25 +4497,32 @@ void run_three_processes(ProgramParameters parameters, pid_t* pid,
  *
  * parameters: a struct containing the program's main parameters including
  * 	the jobSpecs data struct.
- * pid: a pointer to an array to store the pids of the processes to be created
+ * inputPipe: a pointer to the array of the pipe from the generator of the
+ * 	test's input, whose ends are -1 if it has none.
  * outputPipe: a pointer to the array for the pipe that carries stdout from
  * 	uqwordladder process to the cmp process.
  * errorPipe: a pointer to the array for the pipe that carries stderr from
  * 	uqwordladder process to the other cmp process.
  * testNum: the 'n'th test to conduct.
+ * program: the candidate program to test.
+ * statusFd: the write end of the pipe to send the errno of exec to if it
+ * 	fails, which is closed on exec.
+ * cgroup: a pointer to the struct of the cgroup to join, whose fd is -1 if
+ * 	there is none.
  *
  * Errors: Exits with status 99 if running the uqwordladder program fails on
  * 	the command line.
  */
-void run_uqwordladder(ProgramParameters parameters, int* outputPipe,
-	int* errorPipe, int testNum) {
+void run_uqwordladder(ProgramParameters parameters, int* inputPipe,
+	int* outputPipe, int* errorPipe, int testNum, char* program,
+	int statusFd, MemoryCgroup* cgroup) {
     // Put the name of uqwordladder program being tested at the first index
     // of args for command line.
-    parameters.jobSpecs[testNum].args[0] = parameters.program;
+    parameters.jobSpecs[testNum].args[0] = program;
 
-    // Use inputfile for each test as stdin, and redirect stdout and stderr
-    // to pipes.
-    int in = open(parameters.jobSpecs[testNum].inputFile, O_RDONLY);
+    // Use inputfile, or the output of the generator command, for each test as
+    // stdin, and redirect stdout and stderr to pipes.
+    int in = open_input(&parameters.jobSpecs[testNum], inputPipe);
     dup2(in, STDIN_FILENO);
     dup2(outputPipe[WRITE_END], STDOUT_FILENO);
     dup2(errorPipe[WRITE_END], STDERR_FILENO);
@@ -1028,80 +4533,209 @@ void run_uqwordladder(ProgramParameters parameters, int* outputPipe,
     close(errorPipe[WRITE_END]);
     close(errorPipe[READ_END]);
 
+    limit_resources(parameters, cgroup);
     execvp(parameters.jobSpecs[testNum].args[0],
 	    parameters.jobSpecs[testNum].args);
-    exit(UNEXPECTED_ERR);
+    int execError = errno;
+    write(statusFd, &execError, sizeof(execError));
+    _exit(UNEXPECTED_ERR);
+}
+
+/* limit_resources()
+ * -----------------
+ * Limits the memory and CPU time of the program about to be executed in the
+ * 	current process to those given with '--memlimit' and '--cpulimit'.
+ * 	The memory limit is enforced by joining a cgroup whose memory.max is
+ * 	the limit, which kills the program if it goes over it. Without one,
+ * 	its address space is limited with setrlimit() instead, over which
+ * 	allocations fail and the program fails as it sees fit. The program
+ * 	is sent SIGXCPU when it reaches its CPU time limit, and SIGKILL a
+ * 	second later if it is still running.
+ *
+ * parameters: a struct containing the program's main parameters including
+ * 	the limits, which are 0 if not given.
+ * cgroup: a pointer to the struct of the cgroup to join, whose fd is -1 if
+ * 	there is none.
+ *
+ * Returns: void
+ */
+void limit_resources(ProgramParameters parameters, MemoryCgroup* cgroup) {
+    if (parameters.memLimit > 0 && !cgroup_join(cgroup)) {
+	struct rlimit memory;
+	memory.rlim_cur = (rlim_t) parameters.memLimit * BYTES_PER_MB;
+	memory.rlim_max = memory.rlim_cur;
+	setrlimit(RLIMIT_AS, &memory);
+    }
+    if (parameters.cpuLimit > 0) {
+	struct rlimit cpu;
+	cpu.rlim_cur = parameters.cpuLimit;
+	cpu.rlim_max = parameters.cpuLimit + 1;
+	setrlimit(RLIMIT_CPU, &cpu);
+    }
 }
 
 /* run_cmp()
  * ---------
- * Runs cmp on the command line for stdout or stderr, depending on firstPipe
- * 	and secondPipe.
+ * Compares stdout or stderr against the expected output, depending on
+ * 	firstPipe and secondPipe, and exits with the result in the same way
+ * 	as cmp.
  *
  * firstPipe: a pointer to the array of the pipe that will not be used either
  * 	for stdout or stderr.
  * secondPipe: a pointer to the array of the pipe that contains the redirected
- * 	output from uqwordladder, which will be used as stdin for cmp.
+ * 	output from uqwordladder, which will be compared.
  * filePath: the file that contains the stdout and stderr for the current test
  * 	to compare the output against.
+ * mode: the way of comparing the output, given in the job specifications
+ * 	file.
+ * generator: the pid of the generator of the test's input to wait for once
+ * 	the output is compared, or 0 if there is none.
  *
- * Returns: Exits with status 99 if cmp fails on the command line.
+ * Returns: Exits with status 0 if the output matches, or 1 or 2 if it does
+ * 	not match or could not be read, or with status 98 if the generator
+ * 	failed.
  */
-void run_cmp(int* firstPipe, int* secondPipe, char* filePath) {
+void run_cmp(int* firstPipe, int* secondPipe, char* filePath,
+	enum CompareMode mode, pid_t generator) {
     // Close unneccessary ends of pipes.
     close(firstPipe[WRITE_END]);
     close(firstPipe[READ_END]);
     close(secondPipe[WRITE_END]);
 
-    // Redirect stdout and stderr to '/dev/null'
-    dup2(secondPipe[READ_END], STDIN_FILENO);
-    close(secondPipe[READ_END]);
-    int fd = open(EMPTY_FILE, O_WRONLY | O_TRUNC);
-    dup2(fd, STDOUT_FILENO);
-    dup2(fd, STDERR_FILENO);
-    close(fd);
-
-    execlp(CMP_ARG, CMP_ARG, filePath, NULL);
-    exit(UNEXPECTED_ERR);
+    int result = compare_output(secondPipe[READ_END], filePath, mode);
+    int status = 0;
+    while (generator > 0 && waitpid(generator, &status, 0) == -1 &&
+	    errno == EINTR) {
+    }
+    _exit(generator_failed(status) ? GENERATOR_FAILED : result);
 }
 
 /* get_exit_codes()
  * ----------------
  * Gets the exit statuses of all three processes.
  *
- * pid: a pointer to an array with the pids of the three processes.
+ * parameters: a struct containing the program's main parameters including
+ * 	the jobSpecs data struct and the limits the program was run with.
+ * testNum: the 'n'th test that was run.
+ * statuses: a pointer to the array with the wait statuses of the three
+ * 	processes.
+ * elapsed: a pointer to the array with how long the three processes ran for.
+ * usage: a pointer to the resources used by the program.
+ * exitCodes: a pointer to the array to store the exit statuses of all three
+ * 	processes in, where a process that did not exit normally has status
+ * 	-1, and the program has status TIMED_OUT if it was killed when its
+ * 	timeout passed. The program has status CPU_LIMIT_EXCEEDED if it went
+ * 	over its CPU time limit, and OUT_OF_MEMORY if its cgroup killed it
+ * 	for going over its memory limit. A program that fails after an
+ * 	allocation over a memory limit set with setrlimit() is not told
+ * 	apart from any other failure.
  *
- * Returns: a pointer to the array with the exit statuses of all three
- * 	processes
+ * Returns: void
  */
-int* get_exit_codes(pid_t* pid) {
-    int* exitCodes = malloc(sizeof(int) * TOTAL_PIDS);
-    int status;
+void get_exit_codes(ProgramParameters parameters, int testNum,
+	int* statuses, double* elapsed, Usage* usage, int* exitCodes) {
     for (int i = 0; i < TOTAL_PIDS; i++) {
-	waitpid(pid[i], &status, 0);
-	if (WIFEXITED(status)) {
-	    exitCodes[i] = WEXITSTATUS(status);
+	exitCodes[i] = -1;
+	if (WIFEXITED(statuses[i])) {
+	    exitCodes[i] = WEXITSTATUS(statuses[i]);
 	}
     }
-    return exitCodes;
+    int status = statuses[UQWORDLADDER_PID];
+    if (exitCodes[UQWORDLADDER_PID] == -1 &&
+	    elapsed[UQWORDLADDER_PID] >= parameters.jobSpecs[testNum].timeout) {
+	exitCodes[UQWORDLADDER_PID] = TIMED_OUT;
+    } else if (over_cpu_limit(parameters, status, usage)) {
+	exitCodes[UQWORDLADDER_PID] = CPU_LIMIT_EXCEEDED;
+    } else if (WIFSIGNALED(status) && WTERMSIG(status) == SIGKILL &&
+	    usage->oomKilled) {
+	exitCodes[UQWORDLADDER_PID] = OUT_OF_MEMORY;
+    }
+}
+
+/* over_cpu_limit()
+ * ----------------
+ * Checks if a program went over the CPU time limit it was run with. It is
+ * 	sent SIGXCPU at the limit, and SIGKILL a second later if it carries
+ * 	on, so a SIGKILL only counts if it had used up its CPU time.
+ *
+ * parameters: a struct containing the program's main parameters including
+ * 	the CPU time limit.
+ * status: the wait status of the program.
+ * usage: a pointer to the resources used by the program.
+ *
+ * Returns: true if the program went over its CPU time limit, else returns
+ * 	false.
+ */
+bool over_cpu_limit(ProgramParameters parameters, int status, Usage* usage) {
+    if (parameters.cpuLimit == 0 || !WIFSIGNALED(status)) {
+	return false;
+    }
+    return WTERMSIG(status) == SIGXCPU || (WTERMSIG(status) == SIGKILL &&
+	    usage->cpuTime >= parameters.cpuLimit);
+}
+
+/* get_usage()
+ * -----------
+ * Gets the resources used by a program that has been reaped, and whether
+ * 	its cgroup killed it for going over its memory limit, then removes
+ * 	the cgroup. The peak memory of the cgroup is that of the program
+ * 	alone, and is used instead of that of the process when it is known.
+ *
+ * processUsage: a pointer to the resources used by the process.
+ * elapsed: how long the process ran for in seconds.
+ * cgroup: a pointer to the struct of the cgroup the program ran in, whose
+ * 	fd is -1 if it had none.
+ * usage: a pointer to the struct to store the resources in.
+ *
+ * Returns: void
+ */
+void get_usage(struct rusage* processUsage, double elapsed,
+	MemoryCgroup* cgroup, Usage* usage) {
+    usage->runTime = elapsed;
+    usage->cpuTime = processUsage->ru_utime.tv_sec +
+	    processUsage->ru_stime.tv_sec + (processUsage->ru_utime.tv_usec +
+	    processUsage->ru_stime.tv_usec) / 1e6;
+    long peakKb;
+    cgroup_finish(cgroup, &usage->oomKilled, &peakKb);
+    usage->maxRss = peakKb != CGROUP_UNAVAILABLE ? peakKb :
+	    processUsage->ru_maxrss;
 }
 
 /* check_test_error()
  * ------------------
- * Checks if any of the processes failed and prints the fail message.
+ * Checks if the generator of the test's input or either cmp process failed
+ * 	and prints the fail message. The program's exit status is only
+ * 	compared, as its failure to execute is reported separately.
  *
  * jobSpecs: a pointer to the array of the struct with all the parameters of
  * 	each test.
  * exitCodes: a pointer to the array with exit statuses for all three
  * 	processes
  * testNum: the 'n'th test to check the exit statuses for.
+ * candidate: the candidate program that was tested, or NULL if there is only
+ * 	one.
  *
  * Returns: true if at least one process failed, else returns false.
  */
-bool check_test_error(JobSpecs* jobSpecs, int* exitCodes, int testNum) {
+bool check_test_error(JobSpecs* jobSpecs, int* exitCodes, int testNum,
+	char* candidate) {
+    if (exitCodes[STDOUT_PID] == GENERATOR_FAILED) {
+	if (candidate != NULL) {
+	    fprintf(stdout, CANDIDATE_GENERATOR_ERR_MSG,
+		    jobSpecs[testNum].testID, candidate);
+	} else {
+	    fprintf(stdout, GENERATOR_ERR_MSG, jobSpecs[testNum].testID);
+	}
+	return true;
+    }
     for (int i = 0; i < TOTAL_PIDS; i++) {
-	if (exitCodes[i] == UNEXPECTED_ERR) {
-	    fprintf(stdout, TEST_ERR_MSG, jobSpecs[testNum].testID);
+	if (exitCodes[i] == UNEXPECTED_ERR && i != UQWORDLADDER_PID) {
+	    if (candidate != NULL) {
+		fprintf(stdout, CANDIDATE_TEST_ERR_MSG,
+			jobSpecs[testNum].testID, candidate);
+	    } else {
+		fprintf(stdout, TEST_ERR_MSG, jobSpecs[testNum].testID);
+	    }
 	    return true;
 	    break;
 	}
@@ -1118,25 +4752,51 @@ bool check_test_error(JobSpecs* jobSpecs, int* exitCodes, int testNum) {
  * testNum: the 'n'th test to check the results for.
  * exitCodes: a pointer to the array with exit statuses for all three
  * 	processes
+ * candidate: the candidate program that was tested, or NULL if there is only
+ * 	one.
  *
  * Returns: the number of successful tests i.e. 3 if stdout, stderr, and exit
- * 	status match the expected results.
+ * 	status match the expected results, or 0 if the program timed out.
  */
-int report_cmp_results(JobSpecs* jobSpecs, int testNum, int* exitCodes) {
+int report_cmp_results(JobSpecs* jobSpecs, int testNum, int* exitCodes,
+	char* candidate) {
+    if (exitCodes[UQWORDLADDER_PID] == TIMED_OUT) {
+	if (candidate != NULL) {
+	    fprintf(stdout, CANDIDATE_TIMEOUT_MSG, jobSpecs[testNum].testID,
+		    candidate, jobSpecs[testNum].timeout);
+	} else {
+	    fprintf(stdout, TIMEOUT_MSG, jobSpecs[testNum].testID,
+		    jobSpecs[testNum].timeout);
+	}
+	fflush(stdout);
+	return 0;
+    }
+    if (exitCodes[UQWORDLADDER_PID] == CPU_LIMIT_EXCEEDED ||
+	    exitCodes[UQWORDLADDER_PID] == OUT_OF_MEMORY) {
+	bool cpu = exitCodes[UQWORDLADDER_PID] == CPU_LIMIT_EXCEEDED;
+	if (candidate != NULL) {
+	    fprintf(stdout, cpu ? CANDIDATE_CPU_LIMIT_MSG :
+		    CANDIDATE_OUT_OF_MEMORY_MSG, jobSpecs[testNum].testID,
+		    candidate);
+	} else {
+	    fprintf(stdout, cpu ? CPU_LIMIT_MSG : OUT_OF_MEMORY_MSG,
+		    jobSpecs[testNum].testID);
+	}
+	fflush(stdout);
+	return 0;
+    }
+
     // Check if any processes of the current test failed.
-    bool errorHappened = check_test_error(jobSpecs, exitCodes, testNum);
+    bool errorHappened = check_test_error(jobSpecs, exitCodes, testNum,
+	    candidate);
     if (errorHappened) {
 	return 0;
     }
 
     int success = 0;
     
-    // Get expected exit status from file
-    int exitStatusFile = open(jobSpecs[testNum].exitStatusFile, O_RDONLY);
-    char exitStatusBuffer[EXITSTATUS_BUFFER];
-    read(exitStatusFile, exitStatusBuffer, EXITSTATUS_BUFFER);
-    int exitStatus = atoi(exitStatusBuffer);
-    close(exitStatusFile);
+    // Get expected exit status loaded from file
+    int exitStatus = jobSpecs[testNum].expectedExitStatus;
 
     // Check if stdout, stderr, and exit status matches.
     char* type[TOTAL_PIDS] = {STDOUT_REPORT, STDERR_REPORT,
@@ -1146,51 +4806,284 @@ int report_cmp_results(JobSpecs* jobSpecs, int testNum, int* exitCodes) {
     char* result;
     for (int i = 0; i < TOTAL_PIDS; i++) {
 	if (exitCodes[i] == resultForSuccess[i]) {
-	    result = strdup(REPORT_MATCHES);
+	    result = REPORT_MATCHES;
 	    success++;
 	} else {
-	    result = strdup(REPORT_DIFFERS);
+	    result = REPORT_DIFFERS;
+	}
+	if (candidate != NULL) {
+	    fprintf(stdout, CANDIDATE_REPORT_MSG, jobSpecs[testNum].testID,
+		    candidate, type[i], result);
+	} else {
+	    fprintf(stdout, REPORT_MSG, jobSpecs[testNum].testID, type[i],
+		    result);
 	}
-	fprintf(stdout, REPORT_MSG, jobSpecs[testNum].testID, type[i],
-		result);
 	fflush(stdout);
-	free(result);
     }
     return success;
 }
 
+/* count_matches()
+ * ---------------
+ * Counts how many of stdout, stderr and exit status of a test match the
+ * 	expected results, without reporting them.
+ *
+ * jobSpecs: a pointer to the array of the struct with all the parameters for
+ * 	each test.
+ * testNum: the 'n'th test to check the results for.
+ * exitCodes: a pointer to the array with exit statuses for all three
+ * 	processes
+ *
+ * Returns: the number of matches, or 0 if any process failed or the program
+ * 	timed out or could not be executed.
+ */
+int count_matches(JobSpecs* jobSpecs, int testNum, int* exitCodes) {
+    int resultForSuccess[TOTAL_PIDS] = {MATCHES, MATCHES,
+	    jobSpecs[testNum].expectedExitStatus};
+    int success = 0;
+    for (int i = 0; i < TOTAL_PIDS; i++) {
+	if ((exitCodes[i] == UNEXPECTED_ERR && i != UQWORDLADDER_PID) ||
+		(exitCodes[i] == GENERATOR_FAILED && i == STDOUT_PID) ||
+		exitCodes[i] == TIMED_OUT || exitCodes[i] == EXEC_FAILED ||
+		exitCodes[i] == CPU_LIMIT_EXCEEDED ||
+		exitCodes[i] == OUT_OF_MEMORY) {
+	    return 0;
+	}
+	success += exitCodes[i] == resultForSuccess[i];
+    }
+    return success;
+}
+
+/* report_peak_memory()
+ * --------------------
+ * Prints that a test failed for using more memory than good-uqwordladder by
+ * 	more than '--rssratio'.
+ *
+ * jobSpec: a pointer to the struct of the test.
+ * candidate: the candidate program that was tested, or NULL if there is only
+ * 	one.
+ * maxRss: the peak resident set size of the program in kilobytes.
+ * rssRatio: the largest ratio of its peak to that of good-uqwordladder.
+ *
+ * Returns: void
+ */
+void report_peak_memory(JobSpecs* jobSpec, char* candidate, long maxRss,
+	double rssRatio) {
+    if (candidate != NULL) {
+	fprintf(stdout, CANDIDATE_PEAK_MEMORY_MSG, jobSpec->testID, candidate,
+		maxRss, rssRatio, jobSpec->goldenRss);
+    } else {
+	fprintf(stdout, PEAK_MEMORY_MSG, jobSpec->testID, maxRss, rssRatio,
+		jobSpec->goldenRss);
+    }
+    fflush(stdout);
+}
+
+/* report_exec_failed()
+ * --------------------
+ * Prints why the program could not be executed for a test.
+ *
+ * jobSpecs: a pointer to the array of the struct with all the parameters for
+ * 	each test.
+ * testNum: the 'n'th test that was run.
+ * candidate: the candidate program that was tested, or NULL if there is only
+ * 	one.
+ * execError: the errno of exec.
+ *
+ * Returns: void
+ */
+void report_exec_failed(JobSpecs* jobSpecs, int testNum, char* candidate,
+	int execError) {
+    if (candidate != NULL) {
+	fprintf(stdout, CANDIDATE_EXEC_FAILED_MSG, jobSpecs[testNum].testID,
+		candidate, strerror(execError));
+    } else {
+	fprintf(stdout, EXEC_FAILED_MSG, jobSpecs[testNum].testID,
+		strerror(execError));
+    }
+    fflush(stdout);
+}
+
+/* check_exec_error()
+ * ------------------
+ * Checks whether a program that could not be executed for a test cannot be
+ * 	executed for any test.
+ *
+ * program: the candidate program that was tested.
+ * execError: the errno of exec, or 0 if it was executed.
+ *
+ * Errors: Exits with status 12 if the program cannot be executed at all.
+ */
+void check_exec_error(char* program, int execError) {
+    if (execError != 0 && !exec_error_depends_on_test(execError)) {
+	fprintf(stderr, PROGRAM_EXEC_ERR_MSG, program, strerror(execError));
+	exit(PROGRAM_EXEC_ERR);
+    }
+}
+
+/* exec_error_depends_on_test()
+ * ----------------------------
+ * Checks whether a program could fail to execute for one test but not for
+ * 	another. Only an argument list that is too long, or a lack of memory
+ * 	or processes, depends on the test.
+ *
+ * execError: the errno of exec.
+ *
+ * Returns: true if the error depends on the test, else returns false.
+ */
+bool exec_error_depends_on_test(int execError) {
+    return execError == E2BIG || execError == ENOMEM || execError == EAGAIN;
+}
+
+/* drop_program()
+ * --------------
+ * Drops a candidate program that cannot be executed for any test from the
+ * 	rest of the run, so that its remaining tests fail without it being
+ * 	executed, while the other candidates are still tested.
+ *
+ * parameters: a struct containing the program's main parameters including
+ * 	the candidate programs and which of them have been dropped.
+ * program: the index of the candidate program that could not be executed.
+ * execError: the errno of exec.
+ *
+ * Errors: Exits with status 12 if the program cannot be executed at all and
+ * 	no other candidate is left.
+ */
+void drop_program(ProgramParameters parameters, int program, int execError) {
+    if (parameters.programErrors[program] != 0 ||
+	    exec_error_depends_on_test(execError)) {
+	return;
+    }
+    parameters.programErrors[program] = execError;
+    int numLeft = 0;
+    for (int i = 0; i < parameters.numPrograms; i++) {
+	numLeft += parameters.programErrors[i] == 0;
+    }
+    if (numLeft == 0) {
+	check_exec_error(parameters.programs[program], execError);
+    }
+    fprintf(stderr, PROGRAM_DROPPED_MSG, parameters.programs[program],
+	    strerror(execError));
+}
+
+/* wait_test_processes()
+ * ---------------------
+ * Waits up to the test's timeout for the processes of a test to finish, then
+ * 	kills any that are still running. Returns early once all have
+ * 	finished or SIGINT is received.
+ *
+ * pid: a pointer to the array with the pids of the processes
+ * numPids: the number of processes
+ * timeout: the time to wait for in seconds
+ * statuses: a pointer to the array to store the wait status of each process
+ * elapsed: a pointer to the array to store how long each process ran for,
+ * 	in seconds
+ * usages: a pointer to the array to store the resources used by each
+ * 	process in, or NULL if they are not needed. Those of processes that
+ * 	are killed are left zero.
+ *
+ * Returns: void
+ */
+void wait_test_processes(pid_t* pid, int numPids, double timeout,
+	int* statuses, double* elapsed, struct rusage* usages) {
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+#ifdef BENCHMARK
+    double benchStart = bench_now();
+#endif
+    struct timespec deadline;
+    set_deadline(&deadline, &start, timeout);
+
+    // A process that could not be created counts as failing to execute.
+    pid_t running[numPids];
+    int runningIndex[numPids];
+    int numRunning = 0;
+    for (int i = 0; i < numPids; i++) {
+	statuses[i] = W_EXITCODE(UNEXPECTED_ERR, 0);
+	elapsed[i] = 0;
+	if (usages != NULL) {
+	    memset(&usages[i], 0, sizeof(struct rusage));
+	}
+	if (pid[i] > 0) {
+	    running[numRunning] = pid[i];
+	    runningIndex[numRunning++] = i;
+	}
+    }
+
+    while (numRunning > 0) {
+	int status;
+	struct rusage usage;
+	pid_t finished = wait_for_test_child(&status, &deadline, &usage);
+	if (finished <= 0) {
+	    break;
+	}
+	// Expected output may be rebuilt while a test runs.
+	if (finish_rebuild(finished, status, &usage)) {
+	    continue;
+	}
+	for (int i = 0; i < numRunning; i++) {
+	    if (running[i] == finished) {
+		statuses[runningIndex[i]] = status;
+		elapsed[runningIndex[i]] = seconds_since(&start);
+		if (usages != NULL) {
+		    usages[runningIndex[i]] = usage;
+		}
+		numRunning--;
+		running[i] = running[numRunning];
+		runningIndex[i] = runningIndex[numRunning];
+		break;
+	    }
+	}
+    }
+
+    // Kill the processes still running after the delay or SIGINT.
+    int killedStatuses[numPids];
+    kill_processes(running, numRunning, killedStatuses);
+    double killedElapsed = seconds_since(&start);
+    for (int i = 0; i < numRunning; i++) {
+	statuses[runningIndex[i]] = killedStatuses[i];
+	elapsed[runningIndex[i]] = killedElapsed;
+    }
+#ifdef BENCHMARK
+    benchWaitTotal += bench_now() - benchStart;
+#endif
+}
+
 /* kill_processes()
  * ----------------
- * Kills all three processes by sending SIGKILL to them.
+ * Kills the given processes and any processes they started by sending
+ * 	SIGKILL to their process groups, and reaps them.
  *
- * pid: a pointer to the array with the pids of the three processes
+ * pid: a pointer to the array with the pids of the processes
+ * numPids: the number of processes
+ * statuses: a pointer to the array to store the wait status of each process
+ * 	in, or NULL if they are not needed.
  *
  * Returns: void
  */
-void kill_processes(pid_t* pid) {
-    for (int i = 0; i < TOTAL_PIDS; i++) {
-	kill(pid[i], SIGKILL);
+void kill_processes(pid_t* pid, int numPids, int* statuses) {
+    for (int i = 0; i < numPids; i++) {
+	kill(-pid[i], SIGKILL);
+    }
+    for (int i = 0; i < numPids; i++) {
+	waitpid(pid[i], statuses != NULL ? &statuses[i] : NULL, 0);
     }
 }
 
 /* check_interrupt()
  * -----------------
- * If the current test was interrupted with SIGINT, it reaps all three
- * 	processes after they have been killed and exits program.
+ * If the program was interrupted with SIGINT, it reports the tests completed
+ * 	so far and exits program. Any child processes must have been killed
+ * 	and reaped already.
  *
- * pid: a pointer to the array with the pids of the three processes
  * successfulTests: the number of successful tests before SIGINT.
  * numOfRunTests: the total number of tests run before SIGINT.
  *
  * Returns: Exits with exit status 0 and 'successful tests' message if at
  * 	least one test was conducted. If not, then it exits with status 9.
  */
-void check_interrupt(pid_t* pid, int successfulTests, int numOfRunTests) {
+void check_interrupt(int successfulTests, int numOfRunTests) {
     if (interrupted) {
-	
-	for (int i = 0; i < TOTAL_PIDS; i++) {
-	    waitpid(pid[i], NULL, 0);
-	}
 	if (numOfRunTests > 0) {
 	    fprintf(stdout, SUCCESSFUL_TEST_MSG, successfulTests,
 		    numOfRunTests);
@@ -1212,18 +5105,310 @@ void check_interrupt(pid_t* pid, int successfulTests, int numOfRunTests) {
  * Returns: void
  */
 void free_program_parameters(ProgramParameters parameters) {
-    for (int test = 0; test < parameters.numOfTests; test++) {
-	JobSpecs testJob = parameters.jobSpecs[test];
-	free(testJob.testID);
-	free(testJob.inputFile);
-	free(testJob.outputFile);
-	free(testJob.errorFile);
-	free(testJob.exitStatusFile);
+    string_table_free(&parameters.reader.idIndex);
+    free(parameters.reader.invocationTable);
+    free(parameters.pathPool);
+    free(parameters.keyPool);
+    free(parameters.jobSpecs);
+    free(parameters.argPool);
+    jobspec_close(&parameters.jobSpecFile);
+}
 
-	for (int i = 0; testJob.args[i] != NULL; i++) {
-	    free(testJob.args[i]);
+/* run_daemon()
+ * ------------
+ * Serves test runs to clients that connect to the daemon's socket, keeping
+ * 	the tests and expected output loaded between them. Each client is
+ * 	served by its own process, so several can be served at once. If the
+ * 	job specifications file has changed when a client connects, the daemon
+ * 	restarts itself to load it again before serving the client.
+ *
+ * parameters: a struct containing the program's main parameters including
+ * 	the jobSpecs data struct and the path of the socket.
+ * argv: an array of arrays of the command line arguments, to restart with.
+ *
+ * Errors: Exits with status 7 if the socket cannot be created. Exits with
+ * 	status 0 and removes the socket when interrupted by SIGINT.
+ */
+void run_daemon(ProgramParameters parameters, char** argv) {
+    // A restarted daemon keeps the socket and client of the one before it.
+    int listenFd;
+    int clientFd;
+    char* restart = getenv(DAEMON_RESTART_ENV);
+    if (restart == NULL || sscanf(restart, DAEMON_RESTART_FORMAT, &listenFd,
+	    &clientFd) != 2) {
+	listenFd = socket_listen(parameters.daemonSocket);
+	clientFd = -1;
+    }
+    unsetenv(DAEMON_RESTART_ENV);
+    if (listenFd == -1) {
+	fprintf(stderr, DAEMON_SOCKET_ERR_MSG, parameters.daemonSocket);
+	exit(DAEMON_SOCKET_ERR);
+    }
+    fcntl(listenFd, F_SETFD, FD_CLOEXEC);
+
+    // Only let SIGINT and SIGCHLD in while waiting for a client, so that
+    // neither is missed.
+    sigset_t blocked;
+    sigset_t originalMask;
+    sigemptyset(&blocked);
+    sigaddset(&blocked, SIGINT);
+    sigaddset(&blocked, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &blocked, &originalMask);
+    while (!interrupted) {
+	// Reap the processes of clients that have been served.
+	while (waitpid(-1, NULL, WNOHANG) > 0) {
+	}
+	if (clientFd == -1) {
+	    fd_set readSet;
+	    FD_ZERO(&readSet);
+	    FD_SET(listenFd, &readSet);
+	    if (pselect(listenFd + 1, &readSet, NULL, NULL, NULL,
+		    &originalMask) <= 0 ||
+		    (clientFd = accept(listenFd, NULL, NULL)) == -1) {
+		continue;
+	    }
+	}
+	fcntl(clientFd, F_SETFD, FD_CLOEXEC);
+	if (job_file_changed(parameters)) {
+	    sigprocmask(SIG_SETMASK, &originalMask, NULL);
+	    restart_daemon(argv, listenFd, clientFd);
+	    sigprocmask(SIG_BLOCK, &blocked, NULL);
+	}
+
+	fflush(stdout);
+	if (fork_process() == 0) {
+	    close(listenFd);
+	    sigprocmask(SIG_SETMASK, &originalMask, NULL);
+	    serve_client(parameters, clientFd);
 	}
-	free(testJob.args);
+	close(clientFd);
+	clientFd = -1;
     }
-    free(parameters.jobSpecs);
+    unlink(parameters.daemonSocket);
+    exit(OK);
+}
+
+/* job_file_changed()
+ * ------------------
+ * Checks if the job specifications file has been modified since it was read.
+ *
+ * parameters: a struct containing the program's main parameters including
+ * 	the modification time of the jobspecfile when it was read.
+ *
+ * Returns: true if the file's modification time has changed, else returns
+ * 	false.
+ */
+bool job_file_changed(ProgramParameters parameters) {
+    struct stat jobSpecStat;
+    return stat(parameters.jobSpecFilePath, &jobSpecStat) == 0 &&
+	    (jobSpecStat.st_mtim.tv_sec != parameters.jobSpecMtime.tv_sec ||
+	    jobSpecStat.st_mtim.tv_nsec != parameters.jobSpecMtime.tv_nsec);
+}
+
+/* restart_daemon()
+ * ----------------
+ * Replaces the daemon with a new one with the same arguments, which is
+ * 	passed the listening socket and the waiting client.
+ *
+ * argv: an array of arrays of the command line arguments.
+ * listenFd: the file descriptor of the listening socket.
+ * clientFd: the file descriptor of the connection to the waiting client.
+ *
+ * Returns: only if the daemon could not be restarted, in which case it keeps
+ * 	serving the tests it already has.
+ */
+void restart_daemon(char** argv, int listenFd, int clientFd) {
+    char fds[DAEMON_RESTART_BUFFER];
+    sprintf(fds, DAEMON_RESTART_FORMAT, listenFd, clientFd);
+    setenv(DAEMON_RESTART_ENV, fds, 1);
+    fcntl(listenFd, F_SETFD, 0);
+    fcntl(clientFd, F_SETFD, 0);
+    fflush(stdout);
+
+    execv(SELF_EXE, argv);
+    unsetenv(DAEMON_RESTART_ENV);
+    fcntl(listenFd, F_SETFD, FD_CLOEXEC);
+    fcntl(clientFd, F_SETFD, FD_CLOEXEC);
+}
+
+/* serve_client()
+ * --------------
+ * Receives a client's request and runs the selected tests on its program in
+ * 	a child process, writing the results straight to the client's stdout
+ * 	and stderr. SIGINT is passed on to the child when the client sends
+ * 	it, or if the client goes away. The child's exit status is sent back
+ * 	to the client when it is done.
+ *
+ * parameters: a struct containing the program's main parameters including
+ * 	the jobSpecs data struct.
+ * clientFd: the file descriptor of the connection to the client.
+ *
+ * Returns: Exits with status 0 once the client has been served, or 99 if
+ * 	the request could not be received.
+ */
+void serve_client(ProgramParameters parameters, int clientFd) {
+    char request[REQUEST_BUFFER];
+    int outputFds[REQUEST_FDS];
+    char* program;
+    if (!socket_receive_request(clientFd, request, &program,
+	    &parameters.select, outputFds)) {
+	_exit(UNEXPECTED_ERR);
+    }
+    parameters.programs = &program;
+    parameters.numPrograms = 1;
+    parameters.jobs = 1;
+
+    pid_t worker = fork_process();
+    if (worker == 0) {
+	close(clientFd);
+	dup2(outputFds[0], STDOUT_FILENO);
+	dup2(outputFds[1], STDERR_FILENO);
+	close(outputFds[0]);
+	close(outputFds[1]);
+	run_testjob(parameters);
+	exit(OK);
+    }
+    close(outputFds[0]);
+    close(outputFds[1]);
+
+    sigset_t blocked;
+    sigset_t originalMask;
+    sigemptyset(&blocked);
+    sigaddset(&blocked, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &blocked, &originalMask);
+    int status = W_EXITCODE(UNEXPECTED_ERR, 0);
+    bool clientOpen = true;
+    while (worker > 0 && waitpid(worker, &status, WNOHANG) == 0) {
+	fd_set readSet;
+	FD_ZERO(&readSet);
+	if (clientOpen) {
+	    FD_SET(clientFd, &readSet);
+	}
+	if (pselect(clientFd + 1, &readSet, NULL, NULL, NULL,
+		&originalMask) > 0) {
+	    char message;
+	    clientOpen = read(clientFd, &message, 1) == 1;
+	    kill(worker, SIGINT);
+	}
+    }
+    unsigned char exitStatus = WIFEXITED(status) ? WEXITSTATUS(status) :
+	    UNEXPECTED_ERR;
+    send(clientFd, &exitStatus, 1, MSG_NOSIGNAL);
+    _exit(OK);
+}
+
+/* run_client()
+ * ------------
+ * Asks a daemon to run the selected tests on a program, with the results
+ * 	written to this process's stdout and stderr, and exits with the
+ * 	run's exit status. SIGINT is passed on to the daemon.
+ *
+ * socketPath: a pointer to the array with the path of the daemon's socket.
+ * program: a pointer to the array with the program to test. A path is
+ * 	resolved from the current directory, as the daemon's may differ.
+ * select: a pointer to the array with the pattern of tests to run, or NULL
+ * 	for every test.
+ *
+ * Errors: Exits with status 8 if the daemon cannot be reached, or 99 if the
+ * 	connection is lost before the run is done.
+ */
+void run_client(char* socketPath, char* program, char* select) {
+    int fd = socket_connect(socketPath);
+    if (fd == -1) {
+	fprintf(stderr, DAEMON_CONNECT_ERR_MSG, socketPath);
+	exit(DAEMON_CONNECT_ERR);
+    }
+    char* fullPath = strchr(program, '/') != NULL ?
+	    realpath(program, NULL) : NULL;
+    fflush(stdout);
+    bool sent = socket_send_request(fd, fullPath != NULL ? fullPath : program,
+	    select);
+    free(fullPath);
+
+    sigset_t blocked;
+    sigset_t originalMask;
+    sigemptyset(&blocked);
+    sigaddset(&blocked, SIGINT);
+    sigprocmask(SIG_BLOCK, &blocked, &originalMask);
+    while (sent) {
+	if (interrupted) {
+	    interrupted = false;
+	    send(fd, INTERRUPT_REQUEST, 1, MSG_NOSIGNAL);
+	}
+	fd_set readSet;
+	FD_ZERO(&readSet);
+	FD_SET(fd, &readSet);
+	if (pselect(fd + 1, &readSet, NULL, NULL, NULL, &originalMask) <= 0) {
+	    continue;
+	}
+	unsigned char exitStatus;
+	if (read(fd, &exitStatus, 1) == 1) {
+	    exit(exitStatus);
+	}
+	break;
+    }
+    fprintf(stderr, DAEMON_LOST_ERR_MSG);
+    exit(UNEXPECTED_ERR);
+}
+
+/* bench_start()
+ * -------------
+ * Starts timing the first phase of the harness when built with -DBENCHMARK.
+ *
+ * Returns: void
+ */
+void bench_start(void) {
+#ifdef BENCHMARK
+    benchPhaseStart = bench_now();
+#endif
+}
+
+/* bench_phase_done()
+ * ------------------
+ * Reports the time taken by a phase of the harness when built with
+ * 	-DBENCHMARK, and does nothing otherwise. The run phase also reports the
+ * 	per-test overhead, which is its time excluding the time spent waiting
+ * 	for test processes.
+ *
+ * phase: the phase of the harness that has just finished.
+ * numOfTests: the number of tests handled in that phase.
+ *
+ * Returns: Exits with status 0 if the TESTUQWORDLADDER_BENCH_STOP environment
+ * 	variable names the finished phase, so that later phases are skipped.
+ */
+void bench_phase_done(enum BenchPhase phase, int numOfTests) {
+#ifdef BENCHMARK
+    char* phaseNames[] = {"parse", "golden", "run"};
+    double now = bench_now();
+    fprintf(stderr, BENCH_PHASE_MSG, phaseNames[phase],
+	    now - benchPhaseStart, numOfTests);
+    if (phase == BENCH_RUN && numOfTests > 0) {
+	fprintf(stderr, BENCH_OVERHEAD_MSG,
+		(now - benchPhaseStart - benchWaitTotal) / numOfTests);
+	fprintf(stderr, BENCH_ALLOCATIONS_MSG,
+		benchAllocations - benchFirstTestAllocations);
+    }
+    char* stopPhase = getenv(BENCH_STOP_ENV);
+    if (stopPhase && strcmp(stopPhase, phaseNames[phase]) == 0) {
+	exit(OK);
+    }
+    benchPhaseStart = bench_now();
+#endif
+}
+
+/* bench_test_done()
+ * -----------------
+ * Notes the number of heap allocations made by the end of the first test when
+ * 	built with -DBENCHMARK, and does nothing otherwise. The first test may
+ * 	allocate buffers that the C library keeps, such as for stdout, but no
+ * 	test after it should allocate anything.
+ *
+ * Returns: void
+ */
+void bench_test_done(void) {
+#ifdef BENCHMARK
+    if (benchFirstTestAllocations == -1) {
+	benchFirstTestAllocations = benchAllocations;
+    }
+#endif
 }